@@ -1125,6 +1125,7 @@ extern "C" {
 #define GLFW_STICKY_MOUSE_BUTTONS   0x00033003
 #define GLFW_LOCK_KEY_MODS          0x00033004
 #define GLFW_RAW_MOUSE_MOTION       0x00033005
+#define GLFW_COALESCE_CURSOR_MOTION 0x00033006
 
 #define GLFW_CURSOR_NORMAL          0x00034001
 #define GLFW_CURSOR_HIDDEN          0x00034002
@@ -1272,6 +1273,16 @@ extern "C" {
  *  Platform selection [init hint](@ref GLFW_PLATFORM).
  */
 #define GLFW_PLATFORM               0x00050003
+/*! @brief Joystick thread init hint.
+ *
+ *  Joystick thread [init hint](@ref GLFW_JOYSTICK_THREAD_hint).
+ */
+#define GLFW_JOYSTICK_THREAD        0x00050004
+/*! @brief TSC timer init hint.
+ *
+ *  TSC timer [init hint](@ref GLFW_TSC_TIMER_hint).
+ */
+#define GLFW_TSC_TIMER              0x00050005
 /*! @brief macOS specific init hint.
  *
  *  macOS specific [init hint](@ref GLFW_COCOA_CHDIR_RESOURCES_hint).
@@ -4516,6 +4527,52 @@ GLFWAPI void glfwWaitEventsTimeout(double timeout);
  */
 GLFWAPI void glfwPostEmptyEvent(void);
 
+/*! @brief Makes the wait functions also return when a file descriptor is
+ *  readable.
+ *
+ *  This function adds a file descriptor, like an eventfd signalled by a worker
+ *  thread, a file watcher or an IPC socket, to the sources @ref glfwWaitEvents
+ *  and @ref glfwWaitEventsTimeout sleep on.  They then return as soon as the
+ *  descriptor is readable, so an application can sleep in one place however
+ *  many things can wake it.  GLFW never reads from the descriptor, the
+ *  application must drain it or the wait functions keep returning right away.
+ *
+ *  @param[in] fd The file descriptor to wait on.
+ *  @return `GLFW_TRUE` if successful, or `GLFW_FALSE` if an
+ *  [error](@ref error_handling) occurred.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED, @ref
+ *  GLFW_FEATURE_UNAVAILABLE and @ref GLFW_PLATFORM_ERROR.
+ *
+ *  @remark This is only available on X11 on Linux, where the wait functions
+ *  sleep in epoll.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwRemoveEventFd
+ *  @sa @ref glfwWaitEvents
+ *
+ *  @ingroup window
+ */
+GLFWAPI int glfwAddEventFd(int fd);
+
+/*! @brief Stops the wait functions from returning for a file descriptor.
+ *
+ *  This function removes a file descriptor added with @ref glfwAddEventFd.
+ *  It must be called before the descriptor is closed.
+ *
+ *  @param[in] fd The file descriptor to remove.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwAddEventFd
+ *
+ *  @ingroup window
+ */
+GLFWAPI void glfwRemoveEventFd(int fd);
+
 /*! @brief Returns the value of an input option for the specified window.
  *
  *  This function returns the value of an input option for the specified window.
@@ -4545,8 +4602,8 @@ GLFWAPI int glfwGetInputMode(GLFWwindow* window, int mode);
  *
  *  This function sets an input mode option for the specified window.  The mode
  *  must be one of @ref GLFW_CURSOR, @ref GLFW_STICKY_KEYS,
- *  @ref GLFW_STICKY_MOUSE_BUTTONS, @ref GLFW_LOCK_KEY_MODS or
- *  @ref GLFW_RAW_MOUSE_MOTION.
+ *  @ref GLFW_STICKY_MOUSE_BUTTONS, @ref GLFW_LOCK_KEY_MODS,
+ *  @ref GLFW_RAW_MOUSE_MOTION or @ref GLFW_COALESCE_CURSOR_MOTION.
  *
  *  If the mode is `GLFW_CURSOR`, the value must be one of the following cursor
  *  modes:
@@ -4584,10 +4641,20 @@ GLFWAPI int glfwGetInputMode(GLFWwindow* window, int mode);
  *  attempting to set this will emit @ref GLFW_FEATURE_UNAVAILABLE.  Call @ref
  *  glfwRawMouseMotionSupported to check for support.
  *
+ *  If the mode is `GLFW_COALESCE_CURSOR_MOTION`, the value must be either
+ *  `GLFW_TRUE` to coalesce cursor motion, or `GLFW_FALSE` to disable it.  If
+ *  enabled, each unbroken run of cursor motion within one event processing
+ *  call results in a single cursor position callback with its final position.
+ *  The callback is made before the next key, character, scroll or mouse button
+ *  callback, or at the end of the call, so events are never reordered.  Every
+ *  position along the way is still available from @ref glfwGetCursorMotion.
+ *  This is useful with high polling rate mice, which can otherwise deliver
+ *  thousands of callbacks per frame.
+ *
  *  @param[in] window The window whose input mode to set.
  *  @param[in] mode One of `GLFW_CURSOR`, `GLFW_STICKY_KEYS`,
- *  `GLFW_STICKY_MOUSE_BUTTONS`, `GLFW_LOCK_KEY_MODS` or
- *  `GLFW_RAW_MOUSE_MOTION`.
+ *  `GLFW_STICKY_MOUSE_BUTTONS`, `GLFW_LOCK_KEY_MODS`,
+ *  `GLFW_RAW_MOUSE_MOTION` or `GLFW_COALESCE_CURSOR_MOTION`.
  *  @param[in] value The new value of the specified input mode.
  *
  *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED, @ref
@@ -4832,6 +4899,38 @@ GLFWAPI int glfwGetMouseButton(GLFWwindow* window, int button);
  */
 GLFWAPI void glfwGetCursorPos(GLFWwindow* window, double* xpos, double* ypos);
 
+/*! @brief Returns every cursor position of the last event processing call.
+ *
+ *  This function returns the cursor positions, in screen coordinates relative
+ *  to the upper-left corner of the content area, reported for the specified
+ *  window during the most recent call to @ref glfwPollEvents or one of the
+ *  wait functions, in the order they arrived.  The positions are stored as
+ *  x and y pairs, so the array holds twice the returned count of values.
+ *
+ *  Positions are only kept while @ref GLFW_COALESCE_CURSOR_MOTION is enabled
+ *  for the window.
+ *
+ *  @param[in] window The desired window.
+ *  @param[out] count Where to store the number of positions in the returned
+ *  array.  This is set to zero if there was no motion or an
+ *  [error](@ref error_handling) occurred.
+ *  @return An array of x and y pairs, or `NULL` if there was no motion or an
+ *  [error](@ref error_handling) occurred.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @pointer_lifetime The returned array is allocated and freed by GLFW.  You
+ *  should not free it yourself.  It is valid until the next event processing
+ *  call or until the window is destroyed.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwSetInputMode
+ *
+ *  @ingroup input
+ */
+GLFWAPI const double* glfwGetCursorMotion(GLFWwindow* window, int* count);
+
 /*! @brief Sets the position of the cursor, relative to the content area of the
  *  window.
  *
@@ -5473,6 +5572,34 @@ GLFWAPI const unsigned char* glfwGetJoystickButtons(int jid, int* count);
  */
 GLFWAPI const unsigned char* glfwGetJoystickHats(int jid, int* count);
 
+/*! @brief Returns the time of the newest event in the joystick state.
+ *
+ *  This function returns the time, in the same time base as @ref glfwGetTime,
+ *  of the newest device event that went into the state the last call to
+ *  @ref glfwGetJoystickAxes, @ref glfwGetJoystickButtons, @ref
+ *  glfwGetJoystickHats or @ref glfwGetGamepadState returned for the specified
+ *  joystick.  Input can be placed within the frame with it, which matters when
+ *  the @ref GLFW_JOYSTICK_THREAD_hint "joystick thread" applies events as they
+ *  arrive.
+ *
+ *  @param[in] jid The [joystick](@ref joysticks) to query.
+ *  @return The time of the newest event, or zero if the joystick is not
+ *  present, the platform does not report event times or an
+ *  [error](@ref error_handling) occurred.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED, @ref
+ *  GLFW_INVALID_ENUM and @ref GLFW_PLATFORM_ERROR.
+ *
+ *  @remark Event times are only reported on Linux.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref joystick
+ *
+ *  @ingroup input
+ */
+GLFWAPI double glfwGetJoystickEventTime(int jid);
+
 /*! @brief Returns the name of the specified joystick.
  *
  *  This function returns the name, encoded as UTF-8, of the specified joystick.
@@ -5920,6 +6047,75 @@ GLFWAPI uint64_t glfwGetTimerValue(void);
  */
 GLFWAPI uint64_t glfwGetTimerFrequency(void);
 
+/*! @brief Starts recording input events to a file.
+ *
+ *  This function starts writing every key, character, mouse button, cursor
+ *  motion and scroll event of every window, and every call to @ref
+ *  glfwPollEvents or one of the wait functions, to a compact binary log
+ *  together with the time it happened.  The log can be replayed with @ref
+ *  glfwStartInputReplay.  Any recording already in progress is stopped first.
+ *
+ *  @param[in] path The path of the log to write.
+ *  @return `GLFW_TRUE` if successful, or `GLFW_FALSE` if an
+ *  [error](@ref error_handling) occurred.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED and @ref
+ *  GLFW_PLATFORM_ERROR.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwStopInputRecording
+ *  @sa @ref glfwStartInputReplay
+ *
+ *  @ingroup input
+ */
+GLFWAPI int glfwStartInputRecording(const char* path);
+
+/*! @brief Stops recording input events.
+ *
+ *  This function flushes and closes the log started by @ref
+ *  glfwStartInputRecording.  It does nothing if no recording is in progress.
+ *  Recording also stops when the library is terminated.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @ingroup input
+ */
+GLFWAPI void glfwStopInputRecording(void);
+
+/*! @brief Replays a recorded input log into a window.
+ *
+ *  This function makes each following event processing call deliver the
+ *  events the matching call delivered while the log was recorded, to the
+ *  specified window.  While the replay runs, @ref glfwGetTime returns the
+ *  time of the event processing call being replayed instead of the real time,
+ *  so the replay is deterministic however fast or slow it runs.  It runs as
+ *  fast as the application calls @ref glfwPollEvents.
+ *
+ *  When the log runs out, the close flag of the window is set and the timer
+ *  continues from the last replayed time.
+ *
+ *  Replaying is only available on the null platform, where no real input can
+ *  interfere with the log.
+ *
+ *  @param[in] window The window to deliver the events to.
+ *  @param[in] path The path of the log to replay.
+ *  @return `GLFW_TRUE` if successful, or `GLFW_FALSE` if an
+ *  [error](@ref error_handling) occurred.
+ *
+ *  @errors Possible errors include @ref GLFW_NOT_INITIALIZED, @ref
+ *  GLFW_FEATURE_UNAVAILABLE and @ref GLFW_PLATFORM_ERROR.
+ *
+ *  @thread_safety This function must only be called from the main thread.
+ *
+ *  @sa @ref glfwStartInputRecording
+ *
+ *  @ingroup input
+ */
+GLFWAPI int glfwStartInputReplay(GLFWwindow* window, const char* path);
+
 /*! @brief Makes the context of the specified window current for the calling
  *  thread.
  *
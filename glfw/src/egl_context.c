@@ -118,9 +118,13 @@ static GLFWbool chooseEGLConfig(const _GLFWctxconfig* ctxconfig,
         if (getEGLConfigAttrib(n, EGL_COLOR_BUFFER_TYPE) != EGL_RGB_BUFFER)
             continue;
 
-        // Only consider window EGLConfigs
-        if (!(getEGLConfigAttrib(n, EGL_SURFACE_TYPE) & EGL_WINDOW_BIT))
+        // Only consider window EGLConfigs, except on a surfaceless display,
+        // which has no windows
+        if (_glfw.egl.platform != EGL_PLATFORM_SURFACELESS_MESA &&
+            !(getEGLConfigAttrib(n, EGL_SURFACE_TYPE) & EGL_WINDOW_BIT))
+        {
             continue;
+        }
 
 #if defined(_GLFW_X11)
         if (_glfw.platform.platformID == GLFW_PLATFORM_X11)
@@ -240,11 +244,20 @@ static void swapBuffersEGL(_GLFWwindow* window)
     }
 #endif
 
+    // NOTE: A surfaceless context renders only into framebuffer objects and
+    //       has nothing to present
+    if (window->context.egl.surface == EGL_NO_SURFACE)
+        return;
+
     eglSwapBuffers(_glfw.egl.display, window->context.egl.surface);
 }
 
 static void swapIntervalEGL(int interval)
 {
+    _GLFWwindow* window = _glfwPlatformGetTls(&_glfw.contextSlot);
+    if (window->context.egl.surface == EGL_NO_SURFACE)
+        return;
+
     eglSwapInterval(_glfw.egl.display, interval);
 }
 
@@ -420,6 +433,8 @@ GLFWbool _glfwInitEGL(void)
             _glfwStringInExtensionString("EGL_EXT_platform_x11", extensions);
         _glfw.egl.EXT_platform_wayland =
             _glfwStringInExtensionString("EGL_EXT_platform_wayland", extensions);
+        _glfw.egl.MESA_platform_surfaceless =
+            _glfwStringInExtensionString("EGL_MESA_platform_surfaceless", extensions);
         _glfw.egl.ANGLE_platform_angle =
             _glfwStringInExtensionString("EGL_ANGLE_platform_angle", extensions);
         _glfw.egl.ANGLE_platform_angle_opengl =
@@ -483,6 +498,8 @@ GLFWbool _glfwInitEGL(void)
         extensionSupportedEGL("EGL_KHR_get_all_proc_addresses");
     _glfw.egl.KHR_context_flush_control =
         extensionSupportedEGL("EGL_KHR_context_flush_control");
+    _glfw.egl.KHR_surfaceless_context =
+        extensionSupportedEGL("EGL_KHR_surfaceless_context");
     _glfw.egl.EXT_present_opaque =
         extensionSupportedEGL("EGL_EXT_present_opaque");
 
@@ -647,46 +664,62 @@ GLFWbool _glfwCreateContextEGL(_GLFWwindow* window,
         return GLFW_FALSE;
     }
 
-    // Set up attributes for surface creation
-    index = 0;
+    window->context.egl.config = config;
 
-    if (fbconfig->sRGB)
+    // NOTE: The surfaceless platform has no window surfaces, the context is
+    //       made current without one and renders into framebuffer objects
+    if (_glfw.egl.platform == EGL_PLATFORM_SURFACELESS_MESA)
     {
-        if (_glfw.egl.KHR_gl_colorspace)
-            setAttrib(EGL_GL_COLORSPACE_KHR, EGL_GL_COLORSPACE_SRGB_KHR);
+        if (!_glfw.egl.KHR_surfaceless_context)
+        {
+            _glfwInputError(GLFW_API_UNAVAILABLE,
+                            "EGL: Surfaceless display lacks EGL_KHR_surfaceless_context");
+            return GLFW_FALSE;
+        }
+
+        window->context.egl.surface = EGL_NO_SURFACE;
     }
+    else
+    {
+        // Set up attributes for surface creation
+        index = 0;
 
-    if (!fbconfig->doublebuffer)
-        setAttrib(EGL_RENDER_BUFFER, EGL_SINGLE_BUFFER);
+        if (fbconfig->sRGB)
+        {
+            if (_glfw.egl.KHR_gl_colorspace)
+                setAttrib(EGL_GL_COLORSPACE_KHR, EGL_GL_COLORSPACE_SRGB_KHR);
+        }
 
-    if (_glfw.egl.EXT_present_opaque)
-        setAttrib(EGL_PRESENT_OPAQUE_EXT, !fbconfig->transparent);
+        if (!fbconfig->doublebuffer)
+            setAttrib(EGL_RENDER_BUFFER, EGL_SINGLE_BUFFER);
 
-    setAttrib(EGL_NONE, EGL_NONE);
+        if (_glfw.egl.EXT_present_opaque)
+            setAttrib(EGL_PRESENT_OPAQUE_EXT, !fbconfig->transparent);
 
-    native = _glfw.platform.getEGLNativeWindow(window);
-    // HACK: ANGLE does not implement eglCreatePlatformWindowSurfaceEXT
-    //       despite reporting EGL_EXT_platform_base
-    if (_glfw.egl.platform && _glfw.egl.platform != EGL_PLATFORM_ANGLE_ANGLE)
-    {
-        window->context.egl.surface =
-            eglCreatePlatformWindowSurfaceEXT(_glfw.egl.display, config, native, attribs);
-    }
-    else
-    {
-        window->context.egl.surface =
-            eglCreateWindowSurface(_glfw.egl.display, config, native, attribs);
-    }
+        setAttrib(EGL_NONE, EGL_NONE);
 
-    if (window->context.egl.surface == EGL_NO_SURFACE)
-    {
-        _glfwInputError(GLFW_PLATFORM_ERROR,
-                        "EGL: Failed to create window surface: %s",
-                        getEGLErrorString(eglGetError()));
-        return GLFW_FALSE;
-    }
+        native = _glfw.platform.getEGLNativeWindow(window);
+        // HACK: ANGLE does not implement eglCreatePlatformWindowSurfaceEXT
+        //       despite reporting EGL_EXT_platform_base
+        if (_glfw.egl.platform && _glfw.egl.platform != EGL_PLATFORM_ANGLE_ANGLE)
+        {
+            window->context.egl.surface =
+                eglCreatePlatformWindowSurfaceEXT(_glfw.egl.display, config, native, attribs);
+        }
+        else
+        {
+            window->context.egl.surface =
+                eglCreateWindowSurface(_glfw.egl.display, config, native, attribs);
+        }
 
-    window->context.egl.config = config;
+        if (window->context.egl.surface == EGL_NO_SURFACE)
+        {
+            _glfwInputError(GLFW_PLATFORM_ERROR,
+                            "EGL: Failed to create window surface: %s",
+                            getEGLErrorString(eglGetError()));
+            return GLFW_FALSE;
+        }
+    }
 
     // Load the appropriate client library
     if (!_glfw.egl.KHR_get_all_proc_addresses)
@@ -44,6 +44,83 @@
 #define _GLFW_JOYSTICK_BUTTON   2
 #define _GLFW_JOYSTICK_HATBIT   3
 
+// Input log record types, each record is the type, the time as a double and a
+// fixed size payload for that type, all in host byte order
+#define _GLFW_LOG_POLL          0
+#define _GLFW_LOG_KEY           1
+#define _GLFW_LOG_CHAR          2
+#define _GLFW_LOG_MOUSE_BUTTON  3
+#define _GLFW_LOG_CURSOR_POS    4
+#define _GLFW_LOG_SCROLL        5
+
+#define _GLFW_INPUT_LOG_MAGIC   "GLIN"
+#define _GLFW_INPUT_LOG_VERSION 1
+
+// Payload sizes of the input log record types
+//
+static const size_t inputRecordSizes[] = { 0, 10, 6, 3, 16, 16 };
+
+// Appends a record to the input log being recorded
+//
+static void recordInput(unsigned char type, const void* payload)
+{
+    unsigned char record[1 + sizeof(double) + 16];
+    const double time =
+        (double) (_glfwPlatformGetTimerValue() - _glfw.inputLog.recordingStart) /
+        _glfwPlatformGetTimerFrequency();
+
+    record[0] = type;
+    memcpy(record + 1, &time, sizeof(time));
+    memcpy(record + 1 + sizeof(time), payload, inputRecordSizes[type]);
+    fwrite(record, 1, 1 + sizeof(time) + inputRecordSizes[type],
+           _glfw.inputLog.recording);
+}
+
+// Closes the input log being recorded
+//
+static void endInputRecording(void)
+{
+    const GLFWbool failed = ferror(_glfw.inputLog.recording) != 0;
+
+    if (fclose(_glfw.inputLog.recording) != 0 || failed)
+        _glfwInputError(GLFW_PLATFORM_ERROR, "Failed to write input log");
+
+    _glfw.inputLog.recording = NULL;
+}
+
+// Ends the input replay, the timer continues from the last replayed time
+//
+static void endInputReplay(GLFWbool closeWindow)
+{
+    fclose(_glfw.inputLog.replay);
+    _glfw.inputLog.replay = NULL;
+
+    _glfw.timer.offset = _glfwPlatformGetTimerValue() -
+        (uint64_t) (_glfw.inputLog.replayTime * _glfwPlatformGetTimerFrequency());
+
+    if (closeWindow && _glfw.inputLog.replayWindow)
+        _glfwInputWindowCloseRequest(_glfw.inputLog.replayWindow);
+
+    _glfw.inputLog.replayWindow = NULL;
+}
+
+// Delivers the position of coalesced cursor motion still owed a callback, so
+// that the event about to be delivered stays ordered after it
+//
+static void flushCursorMotion(_GLFWwindow* window)
+{
+    if (!window->cursorMotionPending)
+        return;
+
+    window->cursorMotionPending = GLFW_FALSE;
+    if (window->callbacks.cursorPos)
+    {
+        window->callbacks.cursorPos((GLFWwindow*) window,
+                                    window->virtualCursorPosX,
+                                    window->virtualCursorPosY);
+    }
+}
+
 // Initializes the platform joystick API if it has not been already
 //
 static GLFWbool initJoysticks(void)
@@ -266,6 +343,18 @@ static GLFWbool parseMapping(_GLFWmapping* mapping, const char* string)
 //
 void _glfwInputKey(_GLFWwindow* window, int key, int scancode, int action, int mods)
 {
+    if (_glfw.inputLog.recording)
+    {
+        unsigned char payload[10];
+        const int32_t values[2] = { key, scancode };
+        memcpy(payload, values, sizeof(values));
+        payload[8] = (unsigned char) action;
+        payload[9] = (unsigned char) mods;
+        recordInput(_GLFW_LOG_KEY, payload);
+    }
+
+    flushCursorMotion(window);
+
     if (key >= 0 && key <= GLFW_KEY_LAST)
     {
         GLFWbool repeated = GLFW_FALSE;
@@ -297,6 +386,17 @@ void _glfwInputKey(_GLFWwindow* window, int key, int scancode, int action, int m
 //
 void _glfwInputChar(_GLFWwindow* window, uint32_t codepoint, int mods, GLFWbool plain)
 {
+    if (_glfw.inputLog.recording)
+    {
+        unsigned char payload[6];
+        memcpy(payload, &codepoint, sizeof(codepoint));
+        payload[4] = (unsigned char) mods;
+        payload[5] = (unsigned char) plain;
+        recordInput(_GLFW_LOG_CHAR, payload);
+    }
+
+    flushCursorMotion(window);
+
     if (codepoint < 32 || (codepoint > 126 && codepoint < 160))
         return;
 
@@ -317,6 +417,14 @@ void _glfwInputChar(_GLFWwindow* window, uint32_t codepoint, int mods, GLFWbool
 //
 void _glfwInputScroll(_GLFWwindow* window, double xoffset, double yoffset)
 {
+    if (_glfw.inputLog.recording)
+    {
+        const double payload[2] = { xoffset, yoffset };
+        recordInput(_GLFW_LOG_SCROLL, payload);
+    }
+
+    flushCursorMotion(window);
+
     if (window->callbacks.scroll)
         window->callbacks.scroll((GLFWwindow*) window, xoffset, yoffset);
 }
@@ -325,6 +433,17 @@ void _glfwInputScroll(_GLFWwindow* window, double xoffset, double yoffset)
 //
 void _glfwInputMouseClick(_GLFWwindow* window, int button, int action, int mods)
 {
+    if (_glfw.inputLog.recording)
+    {
+        const unsigned char payload[3] =
+        {
+            (unsigned char) button, (unsigned char) action, (unsigned char) mods
+        };
+        recordInput(_GLFW_LOG_MOUSE_BUTTON, payload);
+    }
+
+    flushCursorMotion(window);
+
     if (button < 0 || button > GLFW_MOUSE_BUTTON_LAST)
         return;
 
@@ -345,12 +464,50 @@ void _glfwInputMouseClick(_GLFWwindow* window, int button, int action, int mods)
 //
 void _glfwInputCursorPos(_GLFWwindow* window, double xpos, double ypos)
 {
+    if (_glfw.inputLog.recording)
+    {
+        const double payload[2] = { xpos, ypos };
+        recordInput(_GLFW_LOG_CURSOR_POS, payload);
+    }
+
     if (window->virtualCursorPosX == xpos && window->virtualCursorPosY == ypos)
         return;
 
     window->virtualCursorPosX = xpos;
     window->virtualCursorPosY = ypos;
 
+    if (window->coalesceCursorMotion)
+    {
+        // Motion left over from an earlier call is stale by now
+        if (window->cursorMotionPoll != _glfw.eventPollCount)
+        {
+            window->cursorMotionCount = 0;
+            window->cursorMotionPoll = _glfw.eventPollCount;
+        }
+
+        if (window->cursorMotionCount == window->cursorMotionSize)
+        {
+            const int size = window->cursorMotionSize ? window->cursorMotionSize * 2 : 64;
+            double* motion = _glfw_realloc(window->cursorMotion,
+                                           size * 2 * sizeof(double));
+            if (!motion)
+                return;
+
+            window->cursorMotion = motion;
+            window->cursorMotionSize = size;
+        }
+
+        window->cursorMotion[window->cursorMotionCount * 2 + 0] = xpos;
+        window->cursorMotion[window->cursorMotionCount * 2 + 1] = ypos;
+        window->cursorMotionCount++;
+
+        // The callback is made once the run of motion ends, at the next key,
+        // character, scroll or mouse button event or at the end of the event
+        // processing call
+        window->cursorMotionPending = GLFW_TRUE;
+        return;
+    }
+
     if (window->callbacks.cursorPos)
         window->callbacks.cursorPos((GLFWwindow*) window, xpos, ypos);
 }
@@ -414,6 +571,104 @@ void _glfwInputJoystickHat(_GLFWjoystick* js, int hat, char value)
 //////                       GLFW internal API                      //////
 //////////////////////////////////////////////////////////////////////////
 
+// Notifies shared code that an event processing call has finished
+//
+void _glfwInputPoll(void)
+{
+    _GLFWwindow* window;
+
+    // Deliver coalesced cursor motion, with only the final position
+    for (window = _glfw.windowListHead;  window;  window = window->next)
+        flushCursorMotion(window);
+
+    _glfw.eventPollCount++;
+
+    if (_glfw.inputLog.recording)
+        recordInput(_GLFW_LOG_POLL, NULL);
+}
+
+// Delivers the events of the next recorded event processing call, if an input
+// log is being replayed
+//
+void _glfwReplayInput(void)
+{
+    _GLFWwindow* window = _glfw.inputLog.replayWindow;
+
+    if (!_glfw.inputLog.replay)
+        return;
+
+    for (;;)
+    {
+        unsigned char type;
+        double time;
+        unsigned char payload[16];
+        int32_t values[2];
+        uint32_t codepoint;
+        double position[2];
+
+        if (fread(&type, 1, 1, _glfw.inputLog.replay) != 1)
+        {
+            endInputReplay(GLFW_TRUE);
+            return;
+        }
+
+        if (type > _GLFW_LOG_SCROLL ||
+            fread(&time, sizeof(time), 1, _glfw.inputLog.replay) != 1 ||
+            fread(payload, 1, inputRecordSizes[type], _glfw.inputLog.replay) !=
+                inputRecordSizes[type])
+        {
+            _glfwInputError(GLFW_PLATFORM_ERROR, "Truncated or corrupt input log");
+            endInputReplay(GLFW_TRUE);
+            return;
+        }
+
+        _glfw.inputLog.replayTime = time;
+
+        if (type == _GLFW_LOG_POLL)
+            return;
+
+        // Events for a destroyed window are skipped, the clock still advances
+        if (!window)
+            continue;
+
+        switch (type)
+        {
+            case _GLFW_LOG_KEY:
+                memcpy(values, payload, sizeof(values));
+                _glfwInputKey(window, values[0], values[1], payload[8], payload[9]);
+                break;
+            case _GLFW_LOG_CHAR:
+                memcpy(&codepoint, payload, sizeof(codepoint));
+                _glfwInputChar(window, codepoint, payload[4], payload[5]);
+                break;
+            case _GLFW_LOG_MOUSE_BUTTON:
+                _glfwInputMouseClick(window, payload[0], payload[1], payload[2]);
+                break;
+            case _GLFW_LOG_CURSOR_POS:
+                memcpy(position, payload, sizeof(position));
+                // Keep the platform cursor in step for glfwGetCursorPos
+                _glfw.platform.setCursorPos(window, position[0], position[1]);
+                _glfwInputCursorPos(window, position[0], position[1]);
+                break;
+            case _GLFW_LOG_SCROLL:
+                memcpy(position, payload, sizeof(position));
+                _glfwInputScroll(window, position[0], position[1]);
+                break;
+        }
+    }
+}
+
+// Stops any input recording or replay, used at termination
+//
+void _glfwStopInputLog(void)
+{
+    if (_glfw.inputLog.recording)
+        endInputRecording();
+
+    if (_glfw.inputLog.replay)
+        endInputReplay(GLFW_FALSE);
+}
+
 // Adds the built-in set of gamepad mappings
 //
 void _glfwInitGamepadMappings(void)
@@ -509,6 +764,8 @@ GLFWAPI int glfwGetInputMode(GLFWwindow* handle, int mode)
             return window->lockKeyMods;
         case GLFW_RAW_MOUSE_MOTION:
             return window->rawMouseMotion;
+        case GLFW_COALESCE_CURSOR_MOTION:
+            return window->coalesceCursorMotion;
     }
 
     _glfwInputError(GLFW_INVALID_ENUM, "Invalid input mode 0x%08X", mode);
@@ -615,6 +872,24 @@ GLFWAPI void glfwSetInputMode(GLFWwindow* handle, int mode, int value)
             _glfw.platform.setRawMouseMotion(window, value);
             return;
         }
+
+        case GLFW_COALESCE_CURSOR_MOTION:
+        {
+            value = value ? GLFW_TRUE : GLFW_FALSE;
+            if (window->coalesceCursorMotion == value)
+                return;
+
+            if (!value)
+            {
+                _glfw_free(window->cursorMotion);
+                window->cursorMotion = NULL;
+                window->cursorMotionCount = 0;
+                window->cursorMotionSize = 0;
+            }
+
+            window->coalesceCursorMotion = value;
+            return;
+        }
     }
 
     _glfwInputError(GLFW_INVALID_ENUM, "Invalid input mode 0x%08X", mode);
@@ -727,6 +1002,27 @@ GLFWAPI void glfwGetCursorPos(GLFWwindow* handle, double* xpos, double* ypos)
         _glfw.platform.getCursorPos(window, xpos, ypos);
 }
 
+GLFWAPI const double* glfwGetCursorMotion(GLFWwindow* handle, int* count)
+{
+    _GLFWwindow* window = (_GLFWwindow*) handle;
+    assert(window != NULL);
+    assert(count != NULL);
+
+    *count = 0;
+
+    _GLFW_REQUIRE_INIT_OR_RETURN(NULL);
+
+    // Only the motion of the last finished event processing call is returned
+    if (window->cursorMotionCount == 0 ||
+        window->cursorMotionPoll + 1 != _glfw.eventPollCount)
+    {
+        return NULL;
+    }
+
+    *count = window->cursorMotionCount;
+    return window->cursorMotion;
+}
+
 GLFWAPI void glfwSetCursorPos(GLFWwindow* handle, double xpos, double ypos)
 {
     _GLFWwindow* window = (_GLFWwindow*) handle;
@@ -1071,6 +1367,31 @@ GLFWAPI const unsigned char* glfwGetJoystickHats(int jid, int* count)
     return js->hats;
 }
 
+GLFWAPI double glfwGetJoystickEventTime(int jid)
+{
+    _GLFWjoystick* js;
+
+    assert(jid >= GLFW_JOYSTICK_1);
+    assert(jid <= GLFW_JOYSTICK_LAST);
+
+    _GLFW_REQUIRE_INIT_OR_RETURN(0.0);
+
+    if (jid < 0 || jid > GLFW_JOYSTICK_LAST)
+    {
+        _glfwInputError(GLFW_INVALID_ENUM, "Invalid joystick ID %i", jid);
+        return 0.0;
+    }
+
+    if (!initJoysticks())
+        return 0.0;
+
+    js = _glfw.joysticks + jid;
+    if (!js->present)
+        return 0.0;
+
+    return js->eventTime;
+}
+
 GLFWAPI const char* glfwGetJoystickName(int jid)
 {
     _GLFWjoystick* js;
@@ -1392,6 +1713,10 @@ GLFWAPI const char* glfwGetClipboardString(GLFWwindow* handle)
 GLFWAPI double glfwGetTime(void)
 {
     _GLFW_REQUIRE_INIT_OR_RETURN(0.0);
+
+    if (_glfw.inputLog.replay)
+        return _glfw.inputLog.replayTime;
+
     return (double) (_glfwPlatformGetTimerValue() - _glfw.timer.offset) /
         _glfwPlatformGetTimerFrequency();
 }
@@ -1421,3 +1746,80 @@ GLFWAPI uint64_t glfwGetTimerFrequency(void)
     _GLFW_REQUIRE_INIT_OR_RETURN(0);
     return _glfwPlatformGetTimerFrequency();
 }
+
+GLFWAPI int glfwStartInputRecording(const char* path)
+{
+    const uint32_t version = _GLFW_INPUT_LOG_VERSION;
+
+    assert(path != NULL);
+
+    _GLFW_REQUIRE_INIT_OR_RETURN(GLFW_FALSE);
+
+    glfwStopInputRecording();
+
+    _glfw.inputLog.recording = fopen(path, "wb");
+    if (!_glfw.inputLog.recording)
+    {
+        _glfwInputError(GLFW_PLATFORM_ERROR,
+                        "Failed to open input log %s for writing", path);
+        return GLFW_FALSE;
+    }
+
+    fwrite(_GLFW_INPUT_LOG_MAGIC, 1, 4, _glfw.inputLog.recording);
+    fwrite(&version, sizeof(version), 1, _glfw.inputLog.recording);
+    _glfw.inputLog.recordingStart = _glfwPlatformGetTimerValue();
+    return GLFW_TRUE;
+}
+
+GLFWAPI void glfwStopInputRecording(void)
+{
+    _GLFW_REQUIRE_INIT();
+
+    if (_glfw.inputLog.recording)
+        endInputRecording();
+}
+
+GLFWAPI int glfwStartInputReplay(GLFWwindow* handle, const char* path)
+{
+    _GLFWwindow* window = (_GLFWwindow*) handle;
+    char magic[4];
+    uint32_t version;
+
+    assert(window != NULL);
+    assert(path != NULL);
+
+    _GLFW_REQUIRE_INIT_OR_RETURN(GLFW_FALSE);
+
+    if (_glfw.platform.platformID != GLFW_PLATFORM_NULL)
+    {
+        _glfwInputError(GLFW_FEATURE_UNAVAILABLE,
+                        "Input replay is only available on the null platform");
+        return GLFW_FALSE;
+    }
+
+    if (_glfw.inputLog.replay)
+        endInputReplay(GLFW_FALSE);
+
+    _glfw.inputLog.replay = fopen(path, "rb");
+    if (!_glfw.inputLog.replay)
+    {
+        _glfwInputError(GLFW_PLATFORM_ERROR,
+                        "Failed to open input log %s", path);
+        return GLFW_FALSE;
+    }
+
+    if (fread(magic, 1, 4, _glfw.inputLog.replay) != 4 ||
+        memcmp(magic, _GLFW_INPUT_LOG_MAGIC, 4) != 0 ||
+        fread(&version, sizeof(version), 1, _glfw.inputLog.replay) != 1 ||
+        version != _GLFW_INPUT_LOG_VERSION)
+    {
+        _glfwInputError(GLFW_PLATFORM_ERROR, "%s is not an input log", path);
+        fclose(_glfw.inputLog.replay);
+        _glfw.inputLog.replay = NULL;
+        return GLFW_FALSE;
+    }
+
+    _glfw.inputLog.replayWindow = window;
+    _glfw.inputLog.replayTime = 0.0;
+    return GLFW_TRUE;
+}
@@ -48,6 +48,8 @@
 #define GLFW_INCLUDE_NONE
 #include "../include/GLFW/glfw3.h"
 
+#include <stdio.h>
+
 #define _GLFW_INSERT_FIRST      0
 #define _GLFW_INSERT_LAST       1
 
@@ -177,6 +179,7 @@ typedef const GLubyte* (APIENTRY * PFNGLGETSTRINGIPROC)(GLenum,GLuint);
 #define EGL_CONTEXT_RELEASE_BEHAVIOR_FLUSH_KHR 0x2098
 #define EGL_PLATFORM_X11_EXT 0x31d5
 #define EGL_PLATFORM_WAYLAND_EXT 0x31d8
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31dd
 #define EGL_PRESENT_OPAQUE_EXT 0x31df
 #define EGL_PLATFORM_ANGLE_ANGLE 0x3202
 #define EGL_PLATFORM_ANGLE_TYPE_ANGLE 0x3203
@@ -376,6 +379,8 @@ struct _GLFWerror
 struct _GLFWinitconfig
 {
     GLFWbool      hatButtons;
+    GLFWbool      joystickThread;
+    GLFWbool      tscTimer;
     int           angleType;
     int           platformID;
     PFN_vkGetInstanceProcAddr vulkanLoader;
@@ -550,6 +555,14 @@ struct _GLFWwindow
     // Virtual cursor position when cursor is disabled
     double              virtualCursorPosX, virtualCursorPosY;
     GLFWbool            rawMouseMotion;
+    GLFWbool            coalesceCursorMotion;
+    // Cursor positions of the event processing call numbered cursorMotionPoll
+    double*             cursorMotion;
+    int                 cursorMotionCount;
+    int                 cursorMotionSize;
+    uint64_t            cursorMotionPoll;
+    // Whether the cursor position callback is owed for coalesced motion
+    GLFWbool            cursorMotionPending;
 
     _GLFWcontext        context;
 
@@ -645,6 +658,8 @@ struct _GLFWjoystick
     void*           userPointer;
     char            guid[33];
     _GLFWmapping*   mapping;
+    // Time of the newest event in the state, zero where not reported
+    double          eventTime;
 
     // This is defined in platform.h
     GLFW_PLATFORM_JOYSTICK_STATE
@@ -748,6 +763,9 @@ struct _GLFWplatform
     void (*getRequiredInstanceExtensions)(char**);
     int (*getPhysicalDevicePresentationSupport)(VkInstance,VkPhysicalDevice,uint32_t);
     VkResult (*createWindowSurface)(VkInstance,_GLFWwindow*,const VkAllocationCallbacks*,VkSurfaceKHR*);
+    // event fds, NULL on platforms without them
+    GLFWbool (*addEventFd)(int);
+    void (*removeEventFd)(int);
 };
 
 // Library global data
@@ -767,6 +785,9 @@ struct _GLFWlibrary
         int             refreshRate;
     } hints;
 
+    // Number of finished event processing calls
+    uint64_t            eventPollCount;
+
     _GLFWerror*         errorListHead;
     _GLFWcursor*        cursorListHead;
     _GLFWwindow*        windowListHead;
@@ -789,6 +810,15 @@ struct _GLFWlibrary
         GLFW_PLATFORM_LIBRARY_TIMER_STATE
     } timer;
 
+    struct {
+        FILE*           recording;
+        uint64_t        recordingStart;
+        FILE*           replay;
+        _GLFWwindow*    replayWindow;
+        // Time of the event processing call being replayed
+        double          replayTime;
+    } inputLog;
+
     struct {
         EGLenum         platform;
         EGLDisplay      display;
@@ -800,11 +830,13 @@ struct _GLFWlibrary
         GLFWbool        KHR_gl_colorspace;
         GLFWbool        KHR_get_all_proc_addresses;
         GLFWbool        KHR_context_flush_control;
+        GLFWbool        KHR_surfaceless_context;
         GLFWbool        EXT_client_extensions;
         GLFWbool        EXT_platform_base;
         GLFWbool        EXT_platform_x11;
         GLFWbool        EXT_platform_wayland;
         GLFWbool        EXT_present_opaque;
+        GLFWbool        MESA_platform_surfaceless;
         GLFWbool        ANGLE_platform_angle;
         GLFWbool        ANGLE_platform_angle_opengl;
         GLFWbool        ANGLE_platform_angle_d3d;
@@ -965,6 +997,10 @@ void _glfwFreeGammaArrays(GLFWgammaramp* ramp);
 void _glfwSplitBPP(int bpp, int* red, int* green, int* blue);
 
 void _glfwInitGamepadMappings(void);
+
+void _glfwInputPoll(void);
+void _glfwReplayInput(void);
+void _glfwStopInputLog(void);
 _GLFWjoystick* _glfwAllocJoystick(const char* name,
                                   const char* guid,
                                   int axisCount,
@@ -32,6 +32,8 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/inotify.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <dirent.h>
@@ -39,12 +41,45 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
 
 #ifndef SYN_DROPPED // < v2.6.39 kernel headers
 // Workaround for CentOS-6, which is supported till 2020-11-30, but still on v2.6.32
 #define SYN_DROPPED 3
 #endif
 
+#ifndef input_event_sec // < v4.16 kernel headers
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+
+// epoll data of the joystick thread's wakeup eventfd, devices use their slot
+#define _GLFW_JOYSTICK_WAKEUP (GLFW_JOYSTICK_LAST + 1)
+
+// Returns the timer value of an event, or zero if the device clock doesn't match
+// the timer's
+//
+static uint64_t eventTimerValue(const struct input_event* e)
+{
+    if (_glfw.timer.posix.clock != CLOCK_MONOTONIC)
+        return 0;
+
+    return _glfwTimerValueFromMonotonicPOSIX(
+        (uint64_t) e->input_event_sec * 1000000000 +
+        (uint64_t) e->input_event_usec * 1000);
+}
+
+// Converts a timer value from eventTimerValue to glfwGetTime time
+//
+static double eventTime(uint64_t value)
+{
+    if (!value)
+        return 0.0;
+
+    return (double) (int64_t) (value - _glfw.timer.offset) /
+        _glfw.timer.posix.frequency;
+}
+
 // Apply an EV_KEY event to the specified joystick
 //
 static void handleKeyEvent(_GLFWjoystick* js, int code, int value)
@@ -120,6 +155,245 @@ static void pollAbsState(_GLFWjoystick* js)
     }
 }
 
+// Apply an event read from the device of the specified joystick
+//
+static void handleEvent(_GLFWjoystick* js, const struct input_event* e, GLFWbool* dropped)
+{
+    if (e->type == EV_SYN)
+    {
+        if (e->code == SYN_DROPPED)
+            *dropped = GLFW_TRUE;
+        else if (e->code == SYN_REPORT)
+        {
+            *dropped = GLFW_FALSE;
+            pollAbsState(js);
+        }
+    }
+
+    if (*dropped)
+        return;
+
+    if (e->type == EV_KEY)
+        handleKeyEvent(js, e->code, e->value);
+    else if (e->type == EV_ABS)
+        handleAbsEvent(js, e->code, e->value);
+}
+
+// Reads all queued events of a device on the joystick thread and publishes
+// the result
+//
+static void readDevice(_GLFWdeviceLinux* device, GLFWbool hangup)
+{
+    _GLFWjoystick* js = device->shadow;
+
+    for (;;)
+    {
+        struct input_event events[64];
+        const ssize_t size = read(js->linjs.fd, events, sizeof(events));
+        const int error = errno;
+
+        if (size <= 0)
+        {
+            if ((size < 0 && error == ENODEV) || hangup)
+            {
+                // Left for the main thread to close at the next query
+                epoll_ctl(_glfw.linjs.epoll, EPOLL_CTL_DEL, js->linjs.fd, NULL);
+
+                __atomic_store_n(&device->sequence, device->sequence + 1, __ATOMIC_RELAXED);
+                __atomic_thread_fence(__ATOMIC_RELEASE);
+                device->disconnected = GLFW_TRUE;
+                __atomic_store_n(&device->sequence, device->sequence + 1, __ATOMIC_RELEASE);
+            }
+
+            return;
+        }
+
+        const size_t count = (size_t) size / sizeof(struct input_event);
+
+        // Readers retry while the sequence is odd or has changed under them
+        __atomic_store_n(&device->sequence, device->sequence + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        for (size_t i = 0;  i < count;  i++)
+            handleEvent(js, events + i, &device->dropped);
+
+        device->eventTimer = eventTimerValue(events + count - 1);
+
+        __atomic_store_n(&device->sequence, device->sequence + 1, __ATOMIC_RELEASE);
+    }
+}
+
+// Body of the joystick thread, sleeps in epoll until a device has events
+//
+static void* joystickThreadMain(void* arg)
+{
+    for (;;)
+    {
+        struct epoll_event events[GLFW_JOYSTICK_LAST + 2];
+
+        const int count = epoll_wait(_glfw.linjs.epoll, events,
+                                     GLFW_JOYSTICK_LAST + 2, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return NULL;
+        }
+
+        pthread_mutex_lock(&_glfw.linjs.mutex);
+
+        for (int i = 0;  i < count;  i++)
+        {
+            const uint32_t jid = events[i].data.u32;
+
+            if (jid == _GLFW_JOYSTICK_WAKEUP)
+            {
+                pthread_mutex_unlock(&_glfw.linjs.mutex);
+                return NULL;
+            }
+
+            // The device may have been removed after epoll_wait returned
+            _GLFWdeviceLinux* device = _glfw.linjs.devices + jid;
+            if (device->shadow && !device->disconnected)
+                readDevice(device, (events[i].events & (EPOLLERR | EPOLLHUP)) != 0);
+        }
+
+        pthread_mutex_unlock(&_glfw.linjs.mutex);
+    }
+}
+
+// Hands the device of the specified joystick to the joystick thread
+//
+static void startReadingDevice(_GLFWjoystick* js)
+{
+    const int jid = (int) (js - _glfw.joysticks);
+    _GLFWdeviceLinux* device = _glfw.linjs.devices + jid;
+
+    _GLFWjoystick* shadow = _glfw_calloc(1, sizeof(_GLFWjoystick));
+    if (!shadow)
+        return;
+
+    memcpy(shadow, js, sizeof(_GLFWjoystick));
+    shadow->axes = _glfw_calloc(js->axisCount + 1, sizeof(float));
+    shadow->buttons = _glfw_calloc(js->buttonCount + (size_t) js->hatCount * 4 + 1, 1);
+    shadow->hats = _glfw_calloc(js->hatCount + 1, 1);
+    memcpy(shadow->axes, js->axes, js->axisCount * sizeof(float));
+    memcpy(shadow->buttons, js->buttons, js->buttonCount + (size_t) js->hatCount * 4);
+    memcpy(shadow->hats, js->hats, js->hatCount);
+
+    pthread_mutex_lock(&_glfw.linjs.mutex);
+    device->shadow = shadow;
+    device->eventTimer = 0;
+    device->dropped = GLFW_FALSE;
+    device->disconnected = GLFW_FALSE;
+    pthread_mutex_unlock(&_glfw.linjs.mutex);
+
+    struct epoll_event event = { EPOLLIN, { .u32 = (uint32_t) jid } };
+    if (epoll_ctl(_glfw.linjs.epoll, EPOLL_CTL_ADD, js->linjs.fd, &event) != 0)
+    {
+        _glfwInputError(GLFW_PLATFORM_ERROR,
+                        "Linux: Failed to add joystick to the joystick thread: %s",
+                        strerror(errno));
+    }
+}
+
+// Takes the device of the specified joystick back from the joystick thread
+//
+static void stopReadingDevice(_GLFWjoystick* js)
+{
+    _GLFWdeviceLinux* device = _glfw.linjs.devices + (js - _glfw.joysticks);
+
+    if (!device->shadow)
+        return;
+
+    epoll_ctl(_glfw.linjs.epoll, EPOLL_CTL_DEL, js->linjs.fd, NULL);
+
+    pthread_mutex_lock(&_glfw.linjs.mutex);
+    _GLFWjoystick* shadow = device->shadow;
+    device->shadow = NULL;
+    pthread_mutex_unlock(&_glfw.linjs.mutex);
+
+    _glfw_free(shadow->axes);
+    _glfw_free(shadow->buttons);
+    _glfw_free(shadow->hats);
+    _glfw_free(shadow);
+}
+
+// Copies the state last published by the joystick thread into the joystick
+//
+static GLFWbool copyDeviceState(_GLFWjoystick* js, _GLFWdeviceLinux* device)
+{
+    const _GLFWjoystick* shadow = device->shadow;
+    unsigned int first, second;
+    GLFWbool disconnected;
+    uint64_t eventTimer;
+
+    do
+    {
+        first = __atomic_load_n(&device->sequence, __ATOMIC_ACQUIRE);
+
+        memcpy(js->axes, shadow->axes, js->axisCount * sizeof(float));
+        memcpy(js->buttons, shadow->buttons, js->buttonCount + (size_t) js->hatCount * 4);
+        memcpy(js->hats, shadow->hats, js->hatCount);
+        disconnected = device->disconnected;
+        eventTimer = device->eventTimer;
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        second = __atomic_load_n(&device->sequence, __ATOMIC_RELAXED);
+    }
+    while ((first & 1) || first != second);
+
+    js->eventTime = eventTime(eventTimer);
+    return !disconnected;
+}
+
+// Starts the joystick thread, see GLFW_JOYSTICK_THREAD
+//
+static GLFWbool startJoystickThread(void)
+{
+    _glfw.linjs.epoll = epoll_create1(EPOLL_CLOEXEC);
+    _glfw.linjs.wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (_glfw.linjs.epoll > 0 && _glfw.linjs.wakeup > 0)
+    {
+        struct epoll_event event = { EPOLLIN, { .u32 = _GLFW_JOYSTICK_WAKEUP } };
+        if (epoll_ctl(_glfw.linjs.epoll, EPOLL_CTL_ADD, _glfw.linjs.wakeup, &event) == 0 &&
+            pthread_mutex_init(&_glfw.linjs.mutex, NULL) == 0)
+        {
+            if (pthread_create(&_glfw.linjs.thread, NULL, joystickThreadMain, NULL) == 0)
+                return GLFW_TRUE;
+
+            pthread_mutex_destroy(&_glfw.linjs.mutex);
+        }
+    }
+
+    _glfwInputError(GLFW_PLATFORM_ERROR,
+                    "Linux: Failed to start the joystick thread: %s",
+                    strerror(errno));
+
+    if (_glfw.linjs.epoll > 0)
+        close(_glfw.linjs.epoll);
+    if (_glfw.linjs.wakeup > 0)
+        close(_glfw.linjs.wakeup);
+
+    return GLFW_FALSE;
+}
+
+// Stops the joystick thread once all devices have been taken back
+//
+static void stopJoystickThread(void)
+{
+    const uint64_t one = 1;
+    if (write(_glfw.linjs.wakeup, &one, sizeof(one)) == sizeof(one))
+        pthread_join(_glfw.linjs.thread, NULL);
+
+    pthread_mutex_destroy(&_glfw.linjs.mutex);
+    close(_glfw.linjs.epoll);
+    close(_glfw.linjs.wakeup);
+    _glfw.linjs.threaded = GLFW_FALSE;
+}
+
 #define isBitSet(bit, arr) (arr[(bit) / 8] & (1 << ((bit) % 8)))
 
 // Attempt to open the specified joystick device
@@ -139,6 +413,15 @@ static GLFWbool openJoystickDevice(const char* path)
     if (linjs.fd == -1)
         return GLFW_FALSE;
 
+#if defined(EVIOCSCLOCKID)
+    // Event times in the timer's clock, for glfwGetJoystickEventTime
+    if (_glfw.timer.posix.clock == CLOCK_MONOTONIC)
+    {
+        const int clock = CLOCK_MONOTONIC;
+        ioctl(linjs.fd, EVIOCSCLOCKID, &clock);
+    }
+#endif
+
     char evBits[(EV_CNT + 7) / 8] = {0};
     char keyBits[(KEY_CNT + 7) / 8] = {0};
     char absBits[(ABS_CNT + 7) / 8] = {0};
@@ -235,6 +518,9 @@ static GLFWbool openJoystickDevice(const char* path)
 
     pollAbsState(js);
 
+    if (_glfw.linjs.threaded)
+        startReadingDevice(js);
+
     _glfwInputJoystick(js, GLFW_CONNECTED);
     return GLFW_TRUE;
 }
@@ -245,6 +531,9 @@ static GLFWbool openJoystickDevice(const char* path)
 //
 static void closeJoystick(_GLFWjoystick* js)
 {
+    if (_glfw.linjs.threaded)
+        stopReadingDevice(js);
+
     close(js->linjs.fd);
     _glfwFreeJoystick(js);
     _glfwInputJoystick(js, GLFW_DISCONNECTED);
@@ -358,6 +647,20 @@ GLFWbool _glfwInitJoysticksLinux(void)
     // Continue with no joysticks if enumeration fails
 
     qsort(_glfw.joysticks, count, sizeof(_GLFWjoystick), compareJoysticks);
+
+    // Devices are handed to the thread once sorting is done moving them around
+    if (_glfw.hints.init.joystickThread && startJoystickThread())
+    {
+        _glfw.linjs.threaded = GLFW_TRUE;
+
+        for (int jid = 0;  jid <= GLFW_JOYSTICK_LAST;  jid++)
+        {
+            if (_glfw.joysticks[jid].present)
+                startReadingDevice(_glfw.joysticks + jid);
+        }
+    }
+
+    // Continue without the thread if it couldn't be started
     return GLFW_TRUE;
 }
 
@@ -370,6 +673,9 @@ void _glfwTerminateJoysticksLinux(void)
             closeJoystick(js);
     }
 
+    if (_glfw.linjs.threaded)
+        stopJoystickThread();
+
     if (_glfw.linjs.inotify > 0)
     {
         if (_glfw.linjs.watch > 0)
@@ -382,6 +688,22 @@ void _glfwTerminateJoysticksLinux(void)
 
 int _glfwPollJoystickLinux(_GLFWjoystick* js, int mode)
 {
+    if (_glfw.linjs.threaded)
+    {
+        _GLFWdeviceLinux* device = _glfw.linjs.devices + (js - _glfw.joysticks);
+
+        if (device->shadow)
+        {
+            // Reset the joystick slot if the device was disconnected
+            if (!copyDeviceState(js, device))
+                closeJoystick(js);
+
+            return js->present;
+        }
+    }
+
+    uint64_t eventTimer = 0;
+
     // Read all queued events (non-blocking)
     for (;;)
     {
@@ -397,26 +719,13 @@ int _glfwPollJoystickLinux(_GLFWjoystick* js, int mode)
             break;
         }
 
-        if (e.type == EV_SYN)
-        {
-            if (e.code == SYN_DROPPED)
-                _glfw.linjs.dropped = GLFW_TRUE;
-            else if (e.code == SYN_REPORT)
-            {
-                _glfw.linjs.dropped = GLFW_FALSE;
-                pollAbsState(js);
-            }
-        }
-
-        if (_glfw.linjs.dropped)
-            continue;
-
-        if (e.type == EV_KEY)
-            handleKeyEvent(js, e.code, e.value);
-        else if (e.type == EV_ABS)
-            handleAbsEvent(js, e.code, e.value);
+        handleEvent(js, &e, &_glfw.linjs.dropped);
+        eventTimer = eventTimerValue(&e);
     }
 
+    if (js->present && eventTimer)
+        js->eventTime = eventTime(eventTimer);
+
     return js->present;
 }
 
@@ -27,6 +27,7 @@
 #include <linux/input.h>
 #include <linux/limits.h>
 #include <regex.h>
+#include <pthread.h>
 
 #define GLFW_LINUX_JOYSTICK_STATE         _GLFWjoystickLinux linjs;
 #define GLFW_LINUX_LIBRARY_JOYSTICK_STATE _GLFWlibraryLinux  linjs;
@@ -45,6 +46,21 @@ typedef struct _GLFWjoystickLinux
     int                     hats[4][2];
 } _GLFWjoystickLinux;
 
+// State of one joystick slot as published by the joystick thread
+//
+typedef struct _GLFWdeviceLinux
+{
+    // Odd while the joystick thread is applying events to the shadow
+    unsigned int            sequence;
+    // Copy of the joystick the thread applies events to, with its own arrays,
+    // NULL while the slot is not being read by the thread
+    _GLFWjoystick*          shadow;
+    // Timer value of the newest event, zero if unknown
+    uint64_t                eventTimer;
+    GLFWbool                dropped;
+    GLFWbool                disconnected;
+} _GLFWdeviceLinux;
+
 // Linux-specific joystick API data
 //
 typedef struct _GLFWlibraryLinux
@@ -53,6 +69,16 @@ typedef struct _GLFWlibraryLinux
     int                     watch;
     regex_t                 regex;
     GLFWbool                dropped;
+
+    // Joystick thread, see GLFW_JOYSTICK_THREAD
+    GLFWbool                threaded;
+    int                     epoll;
+    int                     wakeup;
+    pthread_t               thread;
+    // Held by the thread while it reads and by the main thread while it adds
+    // or removes a device
+    pthread_mutex_t         mutex;
+    _GLFWdeviceLinux        devices[GLFW_JOYSTICK_LAST + 1];
 } _GLFWlibraryLinux;
 
 void _glfwDetectJoystickConnectionLinux(void);
@@ -460,14 +460,17 @@ int _glfwWindowVisibleNull(_GLFWwindow* window)
 
 void _glfwPollEventsNull(void)
 {
+    _glfwReplayInput();
 }
 
 void _glfwWaitEventsNull(void)
 {
+    _glfwReplayInput();
 }
 
 void _glfwWaitEventsTimeoutNull(double timeout)
 {
+    _glfwReplayInput();
 }
 
 void _glfwPostEmptyEventNull(void)
@@ -526,12 +529,16 @@ const char* _glfwGetClipboardStringNull(void)
 
 EGLenum _glfwGetEGLPlatformNull(EGLint** attribs)
 {
+    // There is no window system to draw to, EGL contexts are surfaceless
+    if (_glfw.egl.EXT_platform_base && _glfw.egl.MESA_platform_surfaceless)
+        return EGL_PLATFORM_SURFACELESS_MESA;
+
     return 0;
 }
 
 EGLNativeDisplayType _glfwGetEGLNativeDisplayNull(void)
 {
-    return 0;
+    return EGL_DEFAULT_DISPLAY;
 }
 
 EGLNativeWindowType _glfwGetEGLNativeWindowNull(_GLFWwindow* window)
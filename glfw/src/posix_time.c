@@ -31,6 +31,102 @@
 
 #include <unistd.h>
 #include <sys/time.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+ #define _GLFW_TSC_TIMER
+ #include <cpuid.h>
+ #include <x86intrin.h>
+#endif
+
+#if defined(_GLFW_TSC_TIMER)
+
+// Returns the monotonic clock in nanoseconds
+//
+static uint64_t getMonotonicTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+// Returns whether the TSC ticks at a constant rate that is the same on all
+// cores and keeps ticking in sleep states
+//
+static GLFWbool isTscInvariant(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1 << 8)))
+        return GLFW_FALSE;
+
+#if defined(__linux__)
+    // The kernel tests the TSC at boot and while running and switches away
+    // from it when it finds it unsynchronized between sockets or cores
+    FILE* file = fopen("/sys/devices/system/clocksource/clocksource0/current_clocksource", "r");
+    if (file)
+    {
+        char source[32] = "";
+        const GLFWbool trusted = fgets(source, sizeof(source), file) &&
+                                 strncmp(source, "tsc", 3) == 0;
+        fclose(file);
+        return trusted;
+    }
+#endif
+
+    return GLFW_TRUE;
+}
+
+// Reads the TSC and the monotonic clock as close together as it can manage
+//
+static void readClocks(uint64_t* tsc, uint64_t* monotonic)
+{
+    uint64_t shortest = UINT64_MAX;
+
+    // The sample with the fewest ticks around the clock read was interrupted
+    // least
+    for (int i = 0;  i < 8;  i++)
+    {
+        const uint64_t before = __rdtsc();
+        const uint64_t time = getMonotonicTime();
+        const uint64_t after = __rdtsc();
+
+        if (after - before < shortest)
+        {
+            shortest = after - before;
+            *tsc = before + (after - before) / 2;
+            *monotonic = time;
+        }
+    }
+}
+
+// Measures the TSC frequency against the monotonic clock
+//
+static GLFWbool calibrateTsc(void)
+{
+    uint64_t tsc, monotonic;
+
+    readClocks(&_glfw.timer.posix.tscBase, &_glfw.timer.posix.monotonicBase);
+
+    // Ten milliseconds puts the error at a few parts per million
+    const struct timespec interval = { 0, 10000000 };
+    nanosleep(&interval, NULL);
+
+    readClocks(&tsc, &monotonic);
+
+    if (tsc <= _glfw.timer.posix.tscBase ||
+        monotonic <= _glfw.timer.posix.monotonicBase)
+    {
+        return GLFW_FALSE;
+    }
+
+    _glfw.timer.posix.frequency = (uint64_t)
+        ((double) (tsc - _glfw.timer.posix.tscBase) * 1e9 /
+         (double) (monotonic - _glfw.timer.posix.monotonicBase) + 0.5);
+    return GLFW_TRUE;
+}
+
+#endif // _GLFW_TSC_TIMER
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -47,10 +143,27 @@ void _glfwPlatformInitTimer(void)
     if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
         _glfw.timer.posix.clock = CLOCK_MONOTONIC;
 #endif
+
+    _glfw.timer.posix.tsc = GLFW_FALSE;
+
+#if defined(_GLFW_TSC_TIMER)
+    if (_glfw.hints.init.tscTimer &&
+        _glfw.timer.posix.clock == CLOCK_MONOTONIC &&
+        isTscInvariant())
+    {
+        if (calibrateTsc())
+            _glfw.timer.posix.tsc = GLFW_TRUE;
+    }
+#endif
 }
 
 uint64_t _glfwPlatformGetTimerValue(void)
 {
+#if defined(_GLFW_TSC_TIMER)
+    if (_glfw.timer.posix.tsc)
+        return __rdtsc();
+#endif
+
     struct timespec ts;
     clock_gettime(_glfw.timer.posix.clock, &ts);
     return (uint64_t) ts.tv_sec * _glfw.timer.posix.frequency + (uint64_t) ts.tv_nsec;
@@ -61,3 +174,20 @@ uint64_t _glfwPlatformGetTimerFrequency(void)
     return _glfw.timer.posix.frequency;
 }
 
+
+//////////////////////////////////////////////////////////////////////////
+//////                       GLFW internal API                      //////
+//////////////////////////////////////////////////////////////////////////
+
+// Converts a CLOCK_MONOTONIC time in nanoseconds to a timer value
+//
+uint64_t _glfwTimerValueFromMonotonicPOSIX(uint64_t nanoseconds)
+{
+    if (!_glfw.timer.posix.tsc)
+        return nanoseconds;
+
+    const int64_t elapsed = (int64_t) (nanoseconds - _glfw.timer.posix.monotonicBase);
+    return _glfw.timer.posix.tscBase +
+        (uint64_t) (int64_t) ((double) elapsed * _glfw.timer.posix.frequency / 1e9);
+}
+
@@ -37,5 +37,12 @@ typedef struct _GLFWtimerPOSIX
 {
     clockid_t   clock;
     uint64_t    frequency;
+    // The timer value is the TSC, see GLFW_TSC_TIMER
+    GLFWbool    tsc;
+    // A TSC value and the monotonic clock nanoseconds read together with it
+    uint64_t    tscBase;
+    uint64_t    monotonicBase;
 } _GLFWtimerPOSIX;
 
+uint64_t _glfwTimerValueFromMonotonicPOSIX(uint64_t nanoseconds);
+
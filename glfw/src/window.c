@@ -470,6 +470,11 @@ GLFWAPI void glfwDestroyWindow(GLFWwindow* handle)
 
     _glfw.platform.destroyWindow(window);
 
+    if (window == _glfw.inputLog.replayWindow)
+        _glfw.inputLog.replayWindow = NULL;
+
+    _glfw_free(window->cursorMotion);
+
     // Unlink window from global linked list
     {
         _GLFWwindow** prev = &_glfw.windowListHead;
@@ -1088,12 +1093,14 @@ GLFWAPI void glfwPollEvents(void)
 {
     _GLFW_REQUIRE_INIT();
     _glfw.platform.pollEvents();
+    _glfwInputPoll();
 }
 
 GLFWAPI void glfwWaitEvents(void)
 {
     _GLFW_REQUIRE_INIT();
     _glfw.platform.waitEvents();
+    _glfwInputPoll();
 }
 
 GLFWAPI void glfwWaitEventsTimeout(double timeout)
@@ -1110,6 +1117,7 @@ GLFWAPI void glfwWaitEventsTimeout(double timeout)
     }
 
     _glfw.platform.waitEventsTimeout(timeout);
+    _glfwInputPoll();
 }
 
 GLFWAPI void glfwPostEmptyEvent(void)
@@ -1118,3 +1126,25 @@ GLFWAPI void glfwPostEmptyEvent(void)
     _glfw.platform.postEmptyEvent();
 }
 
+GLFWAPI int glfwAddEventFd(int fd)
+{
+    _GLFW_REQUIRE_INIT_OR_RETURN(GLFW_FALSE);
+
+    if (!_glfw.platform.addEventFd)
+    {
+        _glfwInputError(GLFW_FEATURE_UNAVAILABLE,
+                        "Event fds are not available on this platform");
+        return GLFW_FALSE;
+    }
+
+    return _glfw.platform.addEventFd(fd);
+}
+
+GLFWAPI void glfwRemoveEventFd(int fd)
+{
+    _GLFW_REQUIRE_INIT();
+
+    if (_glfw.platform.removeEventFd)
+        _glfw.platform.removeEventFd(fd);
+}
+
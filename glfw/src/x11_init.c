@@ -36,6 +36,10 @@
 #include <locale.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+ #include <sys/epoll.h>
+#endif
+
 
 // Translate the X11 KeySyms for a key to a GLFW key code
 // NOTE: This is only used as a fallback, in case the XKB method fails
@@ -1210,6 +1214,8 @@ GLFWbool _glfwConnectX11(int platformID, _GLFWplatform* platform)
         _glfwGetRequiredInstanceExtensionsX11,
         _glfwGetPhysicalDevicePresentationSupportX11,
         _glfwCreateWindowSurfaceX11,
+        _glfwAddEventFdX11,
+        _glfwRemoveEventFdX11,
     };
 
     // HACK: If the application has left the locale as "C" then both wide
@@ -1497,6 +1503,16 @@ int _glfwInitX11(void)
     _glfw.x11.helperWindowHandle = createHelperWindow();
     _glfw.x11.hiddenCursorHandle = createHiddenCursor();
 
+#if defined(__linux__)
+    _glfw.x11.epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (_glfw.x11.epoll > 0)
+    {
+        const int fd = ConnectionNumber(_glfw.x11.display);
+        struct epoll_event event = { EPOLLIN, { .fd = fd } };
+        epoll_ctl(_glfw.x11.epoll, EPOLL_CTL_ADD, fd, &event);
+    }
+#endif
+
     if (XSupportsLocale() && _glfw.x11.xlib.utf8)
     {
         XSetLocaleModifiers("");
@@ -1514,6 +1530,15 @@ int _glfwInitX11(void)
 
 void _glfwTerminateX11(void)
 {
+#if defined(__linux__)
+    if (_glfw.x11.epoll > 0)
+    {
+        close(_glfw.x11.epoll);
+        _glfw.x11.epoll = 0;
+        _glfw.x11.epollInotify = GLFW_FALSE;
+    }
+#endif
+
     if (_glfw.x11.helperWindowHandle)
     {
         if (XGetSelectionOwner(_glfw.x11.display, _glfw.x11.CLIPBOARD) ==
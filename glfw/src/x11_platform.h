@@ -560,6 +560,10 @@ typedef struct _GLFWlibraryX11
     float           contentScaleX, contentScaleY;
     // Helper window for IPC
     Window          helperWindowHandle;
+    // epoll instance the event wait sleeps in, with the X connection, the
+    // joystick inotify descriptor and the application's event fds
+    int             epoll;
+    GLFWbool        epollInotify;
     // Invisible cursor for hidden cursor mode
     Cursor          hiddenCursorHandle;
     // Context for mapping window XIDs to _GLFWwindow pointers
@@ -939,6 +943,8 @@ void _glfwPollEventsX11(void);
 void _glfwWaitEventsX11(void);
 void _glfwWaitEventsTimeoutX11(double timeout);
 void _glfwPostEmptyEventX11(void);
+GLFWbool _glfwAddEventFdX11(int fd);
+void _glfwRemoveEventFdX11(int fd);
 
 void _glfwGetCursorPosX11(_GLFWwindow* window, double* xpos, double* ypos);
 void _glfwSetCursorPosX11(_GLFWwindow* window, double xpos, double ypos);
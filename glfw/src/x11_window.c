@@ -32,7 +32,10 @@
 #include <X11/cursorfont.h>
 #include <X11/Xmd.h>
 
-#include <sys/select.h>
+#include <poll.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
 
 #include <string.h>
 #include <stdio.h>
@@ -40,6 +43,7 @@
 #include <limits.h>
 #include <errno.h>
 #include <assert.h>
+#include <math.h>
 
 // Action for EWMH client messages
 #define _NET_WM_STATE_REMOVE        0
@@ -57,37 +61,32 @@
 #define _GLFW_XDND_VERSION 5
 
 
-// Wait for data to arrive using select
+// Converts a remaining timeout to milliseconds, rounded up so a wait never
+// returns early and spins
+//
+static int timeoutMilliseconds(double timeout)
+{
+    const double milliseconds = ceil(timeout * 1000.0);
+    if (milliseconds >= INT_MAX)
+        return INT_MAX;
+    return milliseconds > 0.0 ? (int) milliseconds : 0;
+}
+
+// Waits until the X connection is readable or the timeout period elapses
 // This avoids blocking other threads via the per-display Xlib lock that also
 // covers GLX functions
 //
-static GLFWbool waitForEvent(double* timeout)
+static GLFWbool waitForX11Event(double* timeout)
 {
-    fd_set fds;
-    const int fd = ConnectionNumber(_glfw.x11.display);
-    int count = fd + 1;
+    struct pollfd fd = { ConnectionNumber(_glfw.x11.display), POLLIN, 0 };
 
-#if defined(__linux__)
-    if (_glfw.linjs.inotify > fd)
-        count = _glfw.linjs.inotify + 1;
-#endif
     for (;;)
     {
-        FD_ZERO(&fds);
-        FD_SET(fd, &fds);
-#if defined(__linux__)
-        if (_glfw.linjs.inotify > 0)
-            FD_SET(_glfw.linjs.inotify, &fds);
-#endif
-
         if (timeout)
         {
-            const long seconds = (long) *timeout;
-            const long microseconds = (long) ((*timeout - seconds) * 1e6);
-            struct timeval tv = { seconds, microseconds };
             const uint64_t base = _glfwPlatformGetTimerValue();
 
-            const int result = select(count, &fds, NULL, NULL, &tv);
+            const int result = poll(&fd, 1, timeoutMilliseconds(*timeout));
             const int error = errno;
 
             *timeout -= (_glfwPlatformGetTimerValue() - base) /
@@ -98,11 +97,75 @@ static GLFWbool waitForEvent(double* timeout)
             if ((result == -1 && error == EINTR) || *timeout <= 0.0)
                 return GLFW_FALSE;
         }
-        else if (select(count, &fds, NULL, NULL, NULL) != -1 || errno != EINTR)
+        else if (poll(&fd, 1, -1) != -1 || errno != EINTR)
             return GLFW_TRUE;
     }
 }
 
+// Waits until an X event is available, the joystick inotify descriptor or an
+// application event fd is readable, or the timeout period elapses
+// All sources are registered with one epoll instance up front, so this is one
+// syscall per wakeup however many there are
+//
+static GLFWbool waitForAnyEvent(double* timeout)
+{
+#if defined(__linux__)
+    if (_glfw.x11.epoll > 0)
+    {
+        const int fd = ConnectionNumber(_glfw.x11.display);
+
+        // Joysticks are initialized lazily, after the epoll instance was made
+        if (_glfw.joysticksInitialized && _glfw.linjs.inotify > 0 &&
+            !_glfw.x11.epollInotify)
+        {
+            struct epoll_event event = { EPOLLIN, { .fd = _glfw.linjs.inotify } };
+            epoll_ctl(_glfw.x11.epoll, EPOLL_CTL_ADD, _glfw.linjs.inotify, &event);
+            _glfw.x11.epollInotify = GLFW_TRUE;
+        }
+
+        while (!XPending(_glfw.x11.display))
+        {
+            struct epoll_event events[16];
+            const uint64_t base = _glfwPlatformGetTimerValue();
+            int i;
+
+            const int count = epoll_wait(_glfw.x11.epoll, events, 16,
+                                         timeout ? timeoutMilliseconds(*timeout) : -1);
+            const int error = errno;
+
+            if (timeout)
+            {
+                *timeout -= (_glfwPlatformGetTimerValue() - base) /
+                    (double) _glfwPlatformGetTimerFrequency();
+            }
+
+            if (count == -1 && error != EINTR)
+                return GLFW_FALSE;
+
+            // Anything but the X connection is for the caller to handle
+            for (i = 0;  i < count;  i++)
+            {
+                if (events[i].data.fd != fd)
+                    return GLFW_TRUE;
+            }
+
+            if (timeout && *timeout <= 0.0)
+                return GLFW_FALSE;
+        }
+
+        return GLFW_TRUE;
+    }
+#endif
+
+    while (!XPending(_glfw.x11.display))
+    {
+        if (!waitForX11Event(timeout))
+            return GLFW_FALSE;
+    }
+
+    return GLFW_TRUE;
+}
+
 // Waits until a VisibilityNotify event arrives for the specified window or the
 // timeout period elapses (ICCCM section 4.2.2)
 //
@@ -116,7 +179,7 @@ static GLFWbool waitForVisibilityNotify(_GLFWwindow* window)
                                    VisibilityNotify,
                                    &dummy))
     {
-        if (!waitForEvent(&timeout))
+        if (!waitForX11Event(&timeout))
             return GLFW_FALSE;
     }
 
@@ -958,7 +1021,7 @@ static const char* getSelectionString(Atom selection)
                                        SelectionNotify,
                                        &notification))
         {
-            waitForEvent(NULL);
+            waitForX11Event(NULL);
         }
 
         if (notification.xselection.property == None)
@@ -994,7 +1057,7 @@ static const char* getSelectionString(Atom selection)
                                       isSelPropNewValueNotify,
                                       (XPointer) &notification))
                 {
-                    waitForEvent(NULL);
+                    waitForX11Event(NULL);
                 }
 
                 XFree(data);
@@ -1896,7 +1959,7 @@ void _glfwPushSelectionToManagerX11(void)
             }
         }
 
-        waitForEvent(NULL);
+        waitForX11Event(NULL);
     }
 }
 
@@ -2238,7 +2301,7 @@ void _glfwGetWindowFrameSizeX11(_GLFWwindow* window,
                               isFrameExtentsEvent,
                               (XPointer) window))
         {
-            if (!waitForEvent(&timeout))
+            if (!waitForX11Event(&timeout))
             {
                 _glfwInputError(GLFW_PLATFORM_ERROR,
                                 "X11: The window manager has a broken _NET_REQUEST_FRAME_EXTENTS implementation; please report this issue");
@@ -2779,20 +2842,13 @@ void _glfwPollEventsX11(void)
 
 void _glfwWaitEventsX11(void)
 {
-    while (!XPending(_glfw.x11.display))
-        waitForEvent(NULL);
-
+    waitForAnyEvent(NULL);
     _glfwPollEventsX11();
 }
 
 void _glfwWaitEventsTimeoutX11(double timeout)
 {
-    while (!XPending(_glfw.x11.display))
-    {
-        if (!waitForEvent(&timeout))
-            break;
-    }
-
+    waitForAnyEvent(&timeout);
     _glfwPollEventsX11();
 }
 
@@ -2807,6 +2863,34 @@ void _glfwPostEmptyEventX11(void)
     XFlush(_glfw.x11.display);
 }
 
+GLFWbool _glfwAddEventFdX11(int fd)
+{
+#if defined(__linux__)
+    struct epoll_event event = { EPOLLIN, { .fd = fd } };
+
+    if (_glfw.x11.epoll > 0 &&
+        epoll_ctl(_glfw.x11.epoll, EPOLL_CTL_ADD, fd, &event) == 0)
+    {
+        return GLFW_TRUE;
+    }
+
+    _glfwInputError(GLFW_PLATFORM_ERROR,
+                    "X11: Failed to add event fd %i: %s", fd, strerror(errno));
+#else
+    _glfwInputError(GLFW_FEATURE_UNAVAILABLE,
+                    "X11: Event fds require epoll");
+#endif
+    return GLFW_FALSE;
+}
+
+void _glfwRemoveEventFdX11(int fd)
+{
+#if defined(__linux__)
+    if (_glfw.x11.epoll > 0)
+        epoll_ctl(_glfw.x11.epoll, EPOLL_CTL_DEL, fd, NULL);
+#endif
+}
+
 void _glfwGetCursorPosX11(_GLFWwindow* window, double* xpos, double* ypos)
 {
     Window root, child;
@@ -0,0 +1,323 @@
+#include "asset_pack.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include "lz4.h"
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// all little endian, 8 byte aligned, read straight out of the mapping
+struct AssetPack::Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t fileCount;
+    // power of two, at least twice the file count so probe chains stay short
+    std::uint32_t slotCount;
+    std::uint32_t blobCount;
+    std::uint32_t padding;
+    std::uint64_t slotsOffset;
+    std::uint64_t blobsOffset;
+    std::uint64_t stringsOffset;
+    std::uint64_t stringsSize;
+    std::uint64_t fileSize;
+};
+
+struct AssetPack::Slot {
+    std::uint64_t pathHash;
+    std::uint32_t pathOffset;
+    std::uint32_t pathLength;
+    // EMPTY_SLOT for an unused slot
+    std::uint32_t blob;
+    std::uint32_t padding;
+};
+
+struct AssetPack::Blob {
+    std::uint64_t offset;
+    std::uint64_t storedSize;
+    std::uint64_t size;
+    std::uint64_t contentHash;
+    std::uint32_t flags;
+    std::uint32_t padding;
+};
+
+namespace {
+    const char PACK_MAGIC[4]{'A', 'P', 'A', 'K'};
+    const std::uint32_t PACK_VERSION{1};
+    const std::uint32_t EMPTY_SLOT{std::numeric_limits<std::uint32_t>::max()};
+    const std::uint32_t BLOB_LZ4{1};
+    // compressed blobs have to be at least this much smaller to be kept compressed
+    const double MIN_COMPRESSION{0.9};
+
+    std::uint64_t alignUp(std::uint64_t value) {
+        return (value + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+    }
+}
+
+std::uint64_t packHash(const void *data, std::size_t size) {
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+AssetPack::~AssetPack() {
+    close();
+}
+
+bool AssetPack::open(const char *path) {
+    close();
+#ifdef __unix__
+    const int file = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        std::cout << "ERROR::ASSET_PACK::FILE_NOT_FOUND\n" << path << std::endl;
+        return false;
+    }
+    struct stat status {};
+    if (fstat(file, &status) == 0 && status.st_size > 0) {
+        void *mapping = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping != MAP_FAILED) {
+            m_data = static_cast<const unsigned char *>(mapping);
+            m_size = static_cast<std::size_t>(status.st_size);
+        }
+    }
+    // the mapping keeps the file alive on its own
+    ::close(file);
+#else
+    std::FILE *file = std::fopen(path, "rb");
+    if (!file) {
+        std::cout << "ERROR::ASSET_PACK::FILE_NOT_FOUND\n" << path << std::endl;
+        return false;
+    }
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    m_copy.resize(size > 0 ? static_cast<std::size_t>(size) : 0);
+    if (std::fread(m_copy.data(), 1, m_copy.size(), file) == m_copy.size() && !m_copy.empty()) {
+        m_data = m_copy.data();
+        m_size = m_copy.size();
+    }
+    std::fclose(file);
+#endif
+    if (!m_data) {
+        std::cout << "ERROR::ASSET_PACK::NOT_READABLE\n" << path << std::endl;
+        return false;
+    }
+
+    // only the header is checked here, the rest is checked as it's used
+    const Header &pack = header();
+    const bool valid = m_size >= sizeof(Header) && std::memcmp(pack.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0 &&
+                       pack.version == PACK_VERSION && pack.fileSize == m_size &&
+                       pack.slotCount != 0 && (pack.slotCount & (pack.slotCount - 1)) == 0 &&
+                       pack.slotsOffset + std::uint64_t{pack.slotCount} * sizeof(Slot) <= m_size &&
+                       pack.blobsOffset + std::uint64_t{pack.blobCount} * sizeof(Blob) <= m_size &&
+                       pack.stringsOffset + pack.stringsSize <= m_size;
+    if (!valid) {
+        std::cout << "ERROR::ASSET_PACK::NOT_A_PACK\n" << path << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AssetPack::close() {
+#ifdef __unix__
+    if (m_data && m_copy.empty()) {
+        munmap(const_cast<unsigned char *>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_copy.clear();
+}
+
+const AssetPack::Header &AssetPack::header() const {
+    return *reinterpret_cast<const Header *>(m_data);
+}
+
+std::uint32_t AssetPack::fileCount() const {
+    return m_data ? header().fileCount : 0;
+}
+
+std::uint32_t AssetPack::blobCount() const {
+    return m_data ? header().blobCount : 0;
+}
+
+const AssetPack::Blob *AssetPack::find(std::string_view path) const {
+    if (!m_data) {
+        return nullptr;
+    }
+    const Header &pack = header();
+    const auto *slots = reinterpret_cast<const Slot *>(m_data + pack.slotsOffset);
+    const auto *strings = reinterpret_cast<const char *>(m_data + pack.stringsOffset);
+    const std::uint64_t hash = packHash(path.data(), path.size());
+    const std::uint32_t mask = pack.slotCount - 1;
+    for (std::uint32_t probe = 0; probe < pack.slotCount; ++probe) {
+        const Slot &slot = slots[(hash + probe) & mask];
+        if (slot.blob == EMPTY_SLOT) {
+            return nullptr;
+        }
+        if (slot.pathHash != hash || slot.pathLength != path.size() ||
+            std::uint64_t{slot.pathOffset} + slot.pathLength > pack.stringsSize ||
+            std::memcmp(strings + slot.pathOffset, path.data(), path.size()) != 0) {
+            continue;
+        }
+        if (slot.blob >= pack.blobCount) {
+            return nullptr;
+        }
+        const Blob &blob = reinterpret_cast<const Blob *>(m_data + pack.blobsOffset)[slot.blob];
+        if (blob.offset + blob.storedSize > m_size) {
+            std::cout << "ERROR::ASSET_PACK::BLOB_OUT_OF_RANGE\n" << path << std::endl;
+            return nullptr;
+        }
+        return &blob;
+    }
+    return nullptr;
+}
+
+bool AssetPack::contains(std::string_view path) const {
+    return find(path) != nullptr;
+}
+
+std::span<const unsigned char> AssetPack::view(std::string_view path) const {
+    const Blob *blob = find(path);
+    if (!blob || (blob->flags & BLOB_LZ4)) {
+        return {};
+    }
+    return {m_data + blob->offset, static_cast<std::size_t>(blob->size)};
+}
+
+bool AssetPack::read(std::string_view path, std::string &contents) const {
+    const Blob *blob = find(path);
+    if (!blob) {
+        return false;
+    }
+    const unsigned char *stored = m_data + blob->offset;
+    if (!(blob->flags & BLOB_LZ4)) {
+        contents.assign(reinterpret_cast<const char *>(stored), static_cast<std::size_t>(blob->size));
+        return true;
+    }
+    contents.resize(static_cast<std::size_t>(blob->size));
+    if (!lz4Decompress(stored, static_cast<std::size_t>(blob->storedSize), reinterpret_cast<unsigned char *>(contents.data()),
+                       contents.size())) {
+        std::cout << "ERROR::ASSET_PACK::CORRUPT_BLOB\n" << path << std::endl;
+        contents.clear();
+        return false;
+    }
+    return true;
+}
+
+bool AssetPackWriter::add(const std::string &path, std::string contents) {
+    if (!m_paths.insert(path).second) {
+        std::cout << "ERROR::ASSET_PACK::DUPLICATE_PATH\n" << path << std::endl;
+        return false;
+    }
+    const std::uint64_t hash = packHash(contents.data(), contents.size());
+    auto [first, last] = m_blobsByHash.equal_range(hash);
+    for (auto candidate = first; candidate != last; ++candidate) {
+        // the hash only narrows it down, equal contents make it a duplicate
+        if (m_blobs[candidate->second].contents == contents) {
+            m_files.emplace_back(path, candidate->second);
+            m_dedupedBytes += contents.size();
+            return true;
+        }
+    }
+    const auto index = static_cast<std::uint32_t>(m_blobs.size());
+    m_blobs.push_back(Blob{std::move(contents), hash});
+    m_blobsByHash.emplace(hash, index);
+    m_files.emplace_back(path, index);
+    return true;
+}
+
+bool AssetPackWriter::write(const char *path, bool compress) const {
+    std::uint32_t slotCount = 1;
+    while (slotCount < m_files.size() * 2) {
+        slotCount *= 2;
+    }
+
+    AssetPack::Header header{};
+    std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.version = PACK_VERSION;
+    header.fileCount = static_cast<std::uint32_t>(m_files.size());
+    header.slotCount = slotCount;
+    header.blobCount = static_cast<std::uint32_t>(m_blobs.size());
+    header.slotsOffset = sizeof(AssetPack::Header);
+    header.blobsOffset = header.slotsOffset + std::uint64_t{slotCount} * sizeof(AssetPack::Slot);
+    header.stringsOffset = header.blobsOffset + m_blobs.size() * sizeof(AssetPack::Blob);
+
+    std::string strings;
+    std::vector<AssetPack::Slot> slots(slotCount, AssetPack::Slot{0, 0, 0, EMPTY_SLOT, 0});
+    for (const auto &[filePath, blob] : m_files) {
+        const std::uint64_t hash = packHash(filePath.data(), filePath.size());
+        std::uint32_t index = static_cast<std::uint32_t>(hash) & (slotCount - 1);
+        while (slots[index].blob != EMPTY_SLOT) {
+            index = (index + 1) & (slotCount - 1);
+        }
+        slots[index] = AssetPack::Slot{hash, static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(filePath.size()), blob, 0};
+        strings += filePath;
+    }
+    header.stringsSize = strings.size();
+
+    // blob contents, compressed where it pays off
+    std::vector<AssetPack::Blob> blobs(m_blobs.size());
+    std::vector<std::vector<unsigned char>> compressed(m_blobs.size());
+    std::uint64_t offset = alignUp(header.stringsOffset + header.stringsSize);
+    for (std::size_t i = 0; i < m_blobs.size(); ++i) {
+        const std::string &contents = m_blobs[i].contents;
+        blobs[i] = AssetPack::Blob{offset, contents.size(), contents.size(), m_blobs[i].hash, 0, 0};
+        if (compress && !contents.empty()) {
+            lz4Compress(reinterpret_cast<const unsigned char *>(contents.data()), contents.size(), compressed[i]);
+            if (static_cast<double>(compressed[i].size()) < static_cast<double>(contents.size()) * MIN_COMPRESSION) {
+                blobs[i].storedSize = compressed[i].size();
+                blobs[i].flags = BLOB_LZ4;
+            } else {
+                compressed[i].clear();
+            }
+        }
+        offset = alignUp(offset + blobs[i].storedSize);
+    }
+    header.fileSize = offset;
+
+    std::FILE *file = std::fopen(path, "wb");
+    if (!file) {
+        std::cout << "ERROR::ASSET_PACK::FILE_NOT_WRITABLE\n" << path << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> padding(PACK_ALIGNMENT, 0);
+    std::uint64_t written = 0;
+    auto put = [&](const void *data, std::uint64_t size) {
+        written += std::fwrite(data, 1, static_cast<std::size_t>(size), file);
+    };
+    auto padTo = [&](std::uint64_t target) {
+        put(padding.data(), target - written);
+    };
+    put(&header, sizeof(header));
+    put(slots.data(), slots.size() * sizeof(AssetPack::Slot));
+    put(blobs.data(), blobs.size() * sizeof(AssetPack::Blob));
+    put(strings.data(), strings.size());
+    for (std::size_t i = 0; i < m_blobs.size(); ++i) {
+        padTo(blobs[i].offset);
+        if (blobs[i].flags & BLOB_LZ4) {
+            put(compressed[i].data(), compressed[i].size());
+        } else {
+            put(m_blobs[i].contents.data(), m_blobs[i].contents.size());
+        }
+    }
+    padTo(header.fileSize);
+    const bool complete = written == header.fileSize;
+    std::fclose(file);
+    if (!complete) {
+        std::cout << "ERROR::ASSET_PACK::WRITE_FAILED\n" << path << std::endl;
+    }
+    return complete;
+}
@@ -0,0 +1,92 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// single file asset archive for deployment, built by the asset_pack tool
+// layout: header, directory, blob table, path strings, then the blobs, each starting on a
+// PACK_ALIGNMENT boundary so they can be handed out straight from the mapping
+// - the directory is an open addressing hash table of path hashes, a lookup is one hash and
+//   usually one probe, opening a pack reads nothing but the header
+// - blobs are content addressed, files with the same contents share one blob
+// - a blob is LZ4 compressed only if that saved enough to be worth the decompression
+constexpr std::uint32_t PACK_ALIGNMENT{4096};
+
+// 64 bit FNV-1a, used for the directory and for finding duplicate blobs
+std::uint64_t packHash(const void *data, std::size_t size);
+
+// read side: maps the whole file and indexes into it
+class AssetPack {
+public:
+    AssetPack() = default;
+    ~AssetPack();
+
+    AssetPack(const AssetPack &) = delete;
+    AssetPack &operator=(const AssetPack &) = delete;
+
+    bool open(const char *path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    bool contains(std::string_view path) const;
+    // the file's bytes inside the mapping, valid until close(), empty if it's missing or
+    // compressed, read() those
+    std::span<const unsigned char> view(std::string_view path) const;
+    // copy of the file's contents, decompressed if needed
+    bool read(std::string_view path, std::string &contents) const;
+
+    std::uint32_t fileCount() const;
+    std::uint32_t blobCount() const;
+
+private:
+    friend class AssetPackWriter;
+
+    struct Header;
+    struct Slot;
+    struct Blob;
+
+    const Blob *find(std::string_view path) const;
+    const Header &header() const;
+
+    const unsigned char *m_data{nullptr};
+    std::size_t m_size{0};
+    // without mmap the file is read into here instead
+    std::vector<unsigned char> m_copy;
+};
+
+// write side, used by the asset_pack tool
+class AssetPackWriter {
+public:
+    // path is what the file is looked up by later, '/' separated
+    // false if the path was already added, the pack keeps the first file
+    bool add(const std::string &path, std::string contents);
+    // compress: try LZ4 on every blob
+    bool write(const char *path, bool compress) const;
+
+    std::size_t fileCount() const { return m_files.size(); }
+    std::size_t blobCount() const { return m_blobs.size(); }
+    // bytes not stored because a blob with the same contents was already there
+    std::size_t dedupedBytes() const { return m_dedupedBytes; }
+
+private:
+    struct Blob {
+        std::string contents;
+        std::uint64_t hash;
+    };
+
+    std::vector<Blob> m_blobs;
+    std::unordered_multimap<std::uint64_t, std::uint32_t> m_blobsByHash;
+    // path -> blob
+    std::vector<std::pair<std::string, std::uint32_t>> m_files;
+    std::unordered_set<std::string> m_paths;
+    std::size_t m_dedupedBytes{0};
+};
+
+#endif
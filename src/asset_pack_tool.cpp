@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "asset_pack.h"
+
+// asset_pack: packs every file under a directory into one pack file, looked up by their path
+// relative to that directory, e.g. `asset_pack assets.pak assets` makes "shaders/forward.vert"
+// --lz4 compresses the blobs that shrink enough
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cout << "usage: asset_pack <output.pak> <directory> [--lz4]" << std::endl;
+        return 1;
+    }
+    const bool compress = argc > 3 && std::strcmp(argv[3], "--lz4") == 0;
+    const std::filesystem::path root(argv[2]);
+
+    std::error_code error;
+    std::vector<std::filesystem::path> files;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(root, error)) {
+        if (entry.is_regular_file()) {
+            files.push_back(entry.path());
+        }
+    }
+    if (error) {
+        std::cout << "ERROR::ASSET_PACK::DIRECTORY_NOT_READABLE\n" << root << std::endl;
+        return 1;
+    }
+    // sorted so the same directory always gives the same pack
+    std::sort(files.begin(), files.end());
+
+    AssetPackWriter writer;
+    std::size_t totalBytes = 0;
+    for (const auto &file : files) {
+        std::ifstream stream(file, std::ios::binary);
+        if (!stream) {
+            std::cout << "ERROR::ASSET_PACK::FILE_NOT_READABLE\n" << file << std::endl;
+            return 1;
+        }
+        std::ostringstream contents;
+        contents << stream.rdbuf();
+        totalBytes += contents.str().size();
+        if (!writer.add(file.lexically_relative(root).generic_string(), contents.str())) {
+            return 1;
+        }
+    }
+
+    if (!writer.write(argv[1], compress)) {
+        return 1;
+    }
+    std::cout << writer.fileCount() << " files, " << writer.blobCount() << " blobs, " << totalBytes / 1024 << " KiB, "
+              << writer.dedupedBytes() / 1024 << " KiB deduplicated, " << std::filesystem::file_size(argv[1]) / 1024
+              << " KiB pack" << std::endl;
+    return 0;
+}
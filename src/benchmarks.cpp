@@ -0,0 +1,123 @@
+#include "benchmarks.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "GLFW/glfw3.h"
+
+void benchmarkPost(PostChain &post) {
+    PostSettings settings;
+    settings.bloom = settings.toneMapping = settings.colorGrading = settings.vignette = settings.fxaa = true;
+    for (BloomResolution resolution : {BloomResolution::Half, BloomResolution::Quarter}) {
+        settings.bloomResolution = resolution;
+        post.build(settings);
+        post.benchmark(3840, 2160, 10); // warm up
+        double ms = post.benchmark(3840, 2160, 100);
+        std::cout << "post chain at 3840x2160, " << (resolution == BloomResolution::Half ? "half" : "quarter")
+                  << " resolution bloom: " << ms << " ms per frame" << std::endl;
+    }
+}
+
+void benchmarkText(TextRenderer &text) {
+    const int width = 1920;
+    const int height = 1080;
+    const int labelCount = 5000;
+    const int frames = 100;
+
+    GLuint fbo, color;
+    glGenFramebuffers(1, &fbo);
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glViewport(0, 0, width, height);
+
+    // per object debug stats, the strings stay the same from frame to frame
+    std::vector<std::string> labels;
+    for (int i = 0; i < labelCount; ++i) {
+        char label[64];
+        std::snprintf(label, sizeof(label), "object %04d: %.2f ms", i, static_cast<double>(i % 97) * 0.13);
+        labels.emplace_back(label);
+    }
+
+    GLuint queries[2];
+    glGenQueries(2, queries);
+    double cpuSeconds = 0.0;
+    for (int frame = 0; frame <= frames; ++frame) {
+        // frame 0 builds the layout cache and isn't counted
+        if (frame == 1) {
+            glFinish();
+            glQueryCounter(queries[0], GL_TIMESTAMP);
+        }
+        const double start = glfwGetTime();
+        text.begin(width, height);
+        for (int i = 0; i < labelCount; ++i) {
+            const float x = static_cast<float>(i % 12) * 160.0f;
+            const float y = static_cast<float>(i / 12 % 90) * 12.0f;
+            text.drawText(labels[static_cast<std::size_t>(i)], x, y, 10.0f, 0xffffffff);
+        }
+        text.end();
+        if (frame > 0) {
+            cpuSeconds += glfwGetTime() - start;
+        }
+    }
+    glQueryCounter(queries[1], GL_TIMESTAMP);
+
+    GLuint64 begin = 0, end = 0;
+    glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &end);
+    glDeleteQueries(2, queries);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &color);
+
+    std::cout << "text: " << labelCount << " labels, " << text.glyphsDrawn() << " glyphs, "
+              << text.drawCalls() << " draw call(s) per frame" << std::endl;
+    std::cout << "text: " << cpuSeconds * 1000.0 / frames << " ms CPU, "
+              << static_cast<double>(end - begin) / 1e6 / frames << " ms GPU per frame" << std::endl;
+}
+
+namespace {
+    // where the timer benchmark's sums go, so its reads can't be optimized away
+    volatile std::uint64_t timerSink;
+}
+
+void benchmarkTimer() {
+    const int calls = 10000000;
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t glfwSum = 0;
+    const auto glfwStart = Clock::now();
+    const std::uint64_t firstTick = glfwGetTimerValue();
+    for (int i = 0; i < calls; ++i) {
+        glfwSum += glfwGetTimerValue();
+    }
+    const std::uint64_t lastTick = glfwGetTimerValue();
+    const auto glfwEnd = Clock::now();
+
+    std::int64_t clockSum = 0;
+    const auto clockStart = Clock::now();
+    for (int i = 0; i < calls; ++i) {
+        clockSum += Clock::now().time_since_epoch().count();
+    }
+    const auto clockEnd = Clock::now();
+
+    const double glfwNs = std::chrono::duration<double, std::nano>(glfwEnd - glfwStart).count();
+    const double clockNs = std::chrono::duration<double, std::nano>(clockEnd - clockStart).count();
+    const std::uint64_t frequency = glfwGetTimerFrequency();
+    // the glfw timer measured its own loop, compare with what steady_clock saw
+    const double glfwMeasuredNs = static_cast<double>(lastTick - firstTick) * 1e9 / static_cast<double>(frequency);
+
+    std::cout << "timer: glfwGetTimerValue at " << frequency << " Hz"
+              << (frequency == 1000000000 ? " (clock_gettime)" : " (TSC)") << ": " << glfwNs / calls
+              << " ns per call" << std::endl;
+    std::cout << "timer: steady_clock (clock_gettime): " << clockNs / calls << " ns per call" << std::endl;
+    std::cout << "timer: glfw timer off from steady_clock by " << (glfwMeasuredNs - glfwNs) / glfwNs * 1e6
+              << " ppm over " << glfwNs / 1e6 << " ms" << std::endl;
+    timerSink = glfwSum + static_cast<std::uint64_t>(clockSum);
+}
@@ -0,0 +1,19 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include "postprocess.h"
+#include "text.h"
+
+// offscreen benchmarks run with `open_gl --bench-<name>`, they print their results to stdout
+
+// the full post chain at 3840x2160, once with half and once with quarter resolution bloom
+void benchmarkPost(PostChain &post);
+
+// thousands of unchanging debug labels per frame, CPU and GPU time of the text renderer
+void benchmarkText(TextRenderer &text);
+
+// per call cost of glfwGetTimerValue, what the CPU zones read, against steady_clock, which is
+// clock_gettime, and the drift between the two over the run
+void benchmarkTimer();
+
+#endif
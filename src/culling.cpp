@@ -0,0 +1,49 @@
+#include "culling.h"
+
+#include <algorithm>
+
+bool boxInFrustum(const mat4x4 viewProjection, const float boundsMin[3], const float boundsMax[3]) {
+    // the planes are the last row of the matrix plus or minus one of the others, linmath is column
+    // major so row r is m[0][r], m[1][r], m[2][r], m[3][r]
+    for (int row = 0; row < 3; ++row) {
+        for (float sign : {1.0f, -1.0f}) {
+            float plane[4];
+            for (int column = 0; column < 4; ++column) {
+                plane[column] = viewProjection[column][3] + sign * viewProjection[column][row];
+            }
+            // the corner furthest along the plane's normal
+            float distance = plane[3];
+            for (int axis = 0; axis < 3; ++axis) {
+                distance += plane[axis] * (plane[axis] >= 0.0f ? boundsMax[axis] : boundsMin[axis]);
+            }
+            if (distance < 0.0f) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void growByFrustum(const mat4x4 viewProjection, float boundsMin[3], float boundsMax[3]) {
+    mat4x4 inverse;
+    mat4x4_invert(inverse, viewProjection);
+    for (int corner = 0; corner < 8; ++corner) {
+        vec4 ndc{(corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f, 1.0f};
+        vec4 world;
+        mat4x4_mul_vec4(world, inverse, ndc);
+        for (int axis = 0; axis < 3; ++axis) {
+            const float value = world[axis] / world[3];
+            boundsMin[axis] = std::min(boundsMin[axis], value);
+            boundsMax[axis] = std::max(boundsMax[axis], value);
+        }
+    }
+}
+
+bool boxesOverlap(const float aMin[3], const float aMax[3], const float bMin[3], const float bMax[3]) {
+    for (int axis = 0; axis < 3; ++axis) {
+        if (aMax[axis] < bMin[axis] || aMin[axis] > bMax[axis]) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,17 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include "../glfw/deps/linmath.h"
+
+// world space bounding box tests against camera frustums, shared by the views
+
+// false if the box is completely outside one of the planes of viewProjection's frustum
+// conservative: a box outside the frustum but not outside any single plane still passes
+bool boxInFrustum(const mat4x4 viewProjection, const float boundsMin[3], const float boundsMax[3]);
+
+// grows boundsMin / boundsMax to also contain the frustum of viewProjection
+void growByFrustum(const mat4x4 viewProjection, float boundsMin[3], float boundsMax[3]);
+
+bool boxesOverlap(const float aMin[3], const float aMax[3], const float bMin[3], const float bMax[3]);
+
+#endif
@@ -0,0 +1,490 @@
+#include "deferred.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "profiler.h"
+#include "shader.h"
+#include "uniform_blocks.h"
+
+namespace {
+    const char *geometryVertexSource = "#version 330 core\n"
+                                       "layout (location = 0) in vec3 aPos;\n"
+                                       "#ifdef VERTEX_NORMALS\n"
+                                       "layout (location = 1) in vec3 aNormal;\n"
+                                       "out vec3 viewNormal;\n"
+                                       "#endif\n"
+                                       VIEW_BLOCK_GLSL
+                                       "out vec3 viewPos;\n"
+                                       "void main()\n"
+                                       "{\n"
+                                       "    vec4 pos = view * vec4(aPos, 1.0);\n"
+                                       "    viewPos = pos.xyz;\n"
+                                       "#ifdef VERTEX_NORMALS\n"
+                                       "    viewNormal = mat3(view) * aNormal;\n"
+                                       "#endif\n"
+                                       "    gl_Position = projection * pos;\n"
+                                       "}\0";
+
+    // most meshes only carry positions, their normal is the flat face normal from screen space derivatives
+    const char *geometryFragmentSource = "#version 330 core\n"
+                                         "layout (location = 0) out vec4 gAlbedo;\n"
+                                         "layout (location = 1) out vec4 gNormal;\n"
+                                         "layout (location = 2) out vec2 gMaterial;\n"
+                                         "in vec3 viewPos;\n"
+                                         "#ifdef VERTEX_NORMALS\n"
+                                         "in vec3 viewNormal;\n"
+                                         "#endif\n"
+                                         OBJECT_BLOCK_GLSL
+                                         "uniform bool octahedralNormals;\n"
+                                         "vec2 octWrap(vec2 v)\n"
+                                         "{\n"
+                                         "    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);\n"
+                                         "}\n"
+                                         "void main()\n"
+                                         "{\n"
+                                         "#ifdef VERTEX_NORMALS\n"
+                                         "    vec3 n = normalize(viewNormal);\n"
+                                         "#else\n"
+                                         "    vec3 n = normalize(cross(dFdx(viewPos), dFdy(viewPos)));\n"
+                                         "#endif\n"
+                                         "    gAlbedo = vec4(albedo, 1.0);\n"
+                                         "    if (octahedralNormals) {\n"
+                                         "        n /= abs(n.x) + abs(n.y) + abs(n.z);\n"
+                                         "        vec2 e = n.z >= 0.0 ? n.xy : octWrap(n.xy);\n"
+                                         "        gNormal = vec4(e * 0.5 + 0.5, 0.0, 0.0);\n"
+                                         "    } else {\n"
+                                         "        gNormal = vec4(n, 0.0);\n"
+                                         "    }\n"
+                                         "    gMaterial = vec2(roughness, metallic);\n"
+                                         "}\0";
+
+    const char *lightingFragmentSource = "#version 330 core\n"
+                                         "out vec4 FragColor;\n"
+                                         "uniform sampler2D gAlbedo;\n"
+                                         "uniform sampler2D gNormal;\n"
+                                         "uniform sampler2D gMaterial;\n"
+                                         "uniform sampler2D gDepth;\n"
+                                         "uniform samplerBuffer lights;\n"
+                                         "uniform isamplerBuffer tiles;\n"
+                                         "uniform mat4 invProjection;\n"
+                                         "uniform bool perspective;\n"
+                                         "uniform bool octahedralNormals;\n"
+                                         FRAME_BLOCK_GLSL
+                                         "uniform int tileSize;\n"
+                                         "uniform int tilesX;\n"
+                                         "uniform vec3 ambient;\n"
+                                         "uniform vec3 sunDirection;\n"
+                                         "uniform vec3 sunRadiance;\n"
+                                         "uniform sampler2DArrayShadow shadowMap;\n"
+                                         "uniform mat4 viewToShadow[4];\n"
+                                         "uniform vec4 cascadeSplits;\n"
+                                         "uniform vec2 cameraDepthRange;\n"
+                                         "uniform int cascadeCount;\n"
+                                         "float sunShadow(vec3 pos, vec3 n)\n"
+                                         "{\n"
+                                         "    float t = (-pos.z - cameraDepthRange.x) / (cameraDepthRange.y - cameraDepthRange.x);\n"
+                                         "    int cascade = cascadeCount - 1;\n"
+                                         "    for (int i = 0; i < cascadeCount; ++i) {\n"
+                                         "        if (t <= cascadeSplits[i]) { cascade = i; break; }\n"
+                                         "    }\n"
+                                         "    vec4 s = viewToShadow[cascade] * vec4(pos + n * 0.002, 1.0);\n"
+                                         "    s.xyz /= s.w;\n"
+                                         "    if (any(lessThan(s.xyz, vec3(0.0))) || any(greaterThan(s.xyz, vec3(1.0)))) return 1.0;\n"
+                                         "    // 3x3 PCF on top of the hardware's bilinear comparison\n"
+                                         "    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);\n"
+                                         "    float lit = 0.0;\n"
+                                         "    for (int y = -1; y <= 1; ++y)\n"
+                                         "        for (int x = -1; x <= 1; ++x)\n"
+                                         "            lit += texture(shadowMap, vec4(s.xy + vec2(x, y) * texel, float(cascade), s.z));\n"
+                                         "    return lit / 9.0;\n"
+                                         "}\n"
+                                         "vec3 decodeNormal(vec4 e)\n"
+                                         "{\n"
+                                         "    if (!octahedralNormals) return normalize(e.xyz);\n"
+                                         "    vec2 f = e.xy * 2.0 - 1.0;\n"
+                                         "    vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));\n"
+                                         "    float t = clamp(-n.z, 0.0, 1.0);\n"
+                                         "    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);\n"
+                                         "    return normalize(n);\n"
+                                         "}\n"
+                                         "void main()\n"
+                                         "{\n"
+                                         "    ivec2 pixel = ivec2(gl_FragCoord.xy);\n"
+                                         "    float depth = texelFetch(gDepth, pixel, 0).r;\n"
+                                         "    // nothing was drawn here, keep the clear colour\n"
+                                         "    if (depth == 1.0) discard;\n"
+                                         "    vec4 clip = vec4(gl_FragCoord.xy / screenSize * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);\n"
+                                         "    vec4 view = invProjection * clip;\n"
+                                         "    vec3 pos = view.xyz / view.w;\n"
+                                         "    vec3 albedo = texelFetch(gAlbedo, pixel, 0).rgb;\n"
+                                         "    vec3 n = decodeNormal(texelFetch(gNormal, pixel, 0));\n"
+                                         "    vec2 material = texelFetch(gMaterial, pixel, 0).rg;\n"
+                                         "    vec3 v = perspective ? normalize(-pos) : vec3(0.0, 0.0, 1.0);\n"
+                                         "    vec3 diffuseColor = albedo * (1.0 - material.y);\n"
+                                         "    vec3 specularColor = mix(vec3(0.04), albedo, material.y);\n"
+                                         "    float shininess = mix(256.0, 4.0, material.x);\n"
+                                         "    vec3 color = ambient * albedo;\n"
+                                         "    vec3 sunL = -sunDirection;\n"
+                                         "    float sunNDotL = max(dot(n, sunL), 0.0);\n"
+                                         "    if (sunNDotL > 0.0) {\n"
+                                         "        float sunSpec = pow(max(dot(n, normalize(sunL + v)), 0.0), shininess);\n"
+                                         "        color += (diffuseColor * sunNDotL + specularColor * sunSpec) * sunRadiance * sunShadow(pos, n);\n"
+                                         "    }\n"
+                                         "    ivec2 tile = pixel / tileSize;\n"
+                                         "    int tileIndex = tile.y * tilesX + tile.x;\n"
+                                         "    int first = texelFetch(tiles, tileIndex * 2).r;\n"
+                                         "    int count = texelFetch(tiles, tileIndex * 2 + 1).r;\n"
+                                         "    for (int i = 0; i < count; ++i) {\n"
+                                         "        int light = texelFetch(tiles, first + i).r;\n"
+                                         "        vec4 posRadius = texelFetch(lights, light * 2);\n"
+                                         "        vec3 radiance = texelFetch(lights, light * 2 + 1).rgb;\n"
+                                         "        vec3 l = posRadius.xyz - pos;\n"
+                                         "        float dist = length(l);\n"
+                                         "        if (dist >= posRadius.w) continue;\n"
+                                         "        l /= dist;\n"
+                                         "        float falloff = 1.0 - dist / posRadius.w;\n"
+                                         "        float nDotL = max(dot(n, l), 0.0);\n"
+                                         "        float spec = pow(max(dot(n, normalize(l + v)), 0.0), shininess);\n"
+                                         "        color += (diffuseColor * nDotL + specularColor * spec) * radiance * falloff * falloff;\n"
+                                         "    }\n"
+                                         "    FragColor = vec4(color, 1.0);\n"
+                                         "}\0";
+
+    // texture units used by the lighting pass
+    const GLuint GBUFFER_UNIT{0};
+    const GLuint LIGHT_UNIT{4};
+    const GLuint TILE_UNIT{5};
+    const GLuint SHADOW_UNIT{6};
+
+    // uniforms set every frame
+    const ShaderName OCTAHEDRAL_NORMALS{internShaderName("octahedralNormals")};
+    const ShaderName INV_PROJECTION{internShaderName("invProjection")};
+    const ShaderName PERSPECTIVE{internShaderName("perspective")};
+    const ShaderName TILES_X{internShaderName("tilesX")};
+    const ShaderName AMBIENT{internShaderName("ambient")};
+    const ShaderName SUN_DIRECTION{internShaderName("sunDirection")};
+    const ShaderName SUN_RADIANCE{internShaderName("sunRadiance")};
+
+    // bits of the geometry pass' variant mask, same order as the feature list given to ShaderVariants
+    const std::uint32_t GEOMETRY_VERTEX_NORMALS{1u << 0};
+
+    Material meshMaterial(const Mesh &mesh) {
+        Material material;
+        material.variant = mesh.vertexNormals ? GEOMETRY_VERTEX_NORMALS : 0u;
+        material.block = ObjectBlock{{mesh.albedo[0], mesh.albedo[1], mesh.albedo[2]}, mesh.roughness, mesh.metallic, {}};
+        material.state.cullBackFaces = mesh.cullBackFaces;
+        return material;
+    }
+
+    // a perspective projection has -1 in the w row, so w is -z; an orthographic one has 0 and w = 1
+    bool isPerspective(const mat4x4 projection) {
+        return projection[2][3] < 0.0f && projection[3][3] == 0.0f;
+    }
+}
+
+DeferredRenderer::DeferredRenderer()
+        : m_geometryVariants(geometryVertexSource, geometryFragmentSource, {"VERTEX_NORMALS"}, "GBUFFER", bindUniformBlocks) {
+}
+
+bool DeferredRenderer::init(int width, int height, JobSystem &jobs, UniformStream &uniforms, GpuResources &resources,
+                            const GBufferConfig &config, const ShadowConfig &shadowConfig) {
+    m_uniforms = &uniforms;
+    m_resources = &resources;
+    if (!m_gbuffer.create(width, height, config, resources)) {
+        return false;
+    }
+    if (!m_shadows.init(shadowConfig, jobs, resources)) {
+        return false;
+    }
+
+    // both geometry variants up front, building one in the middle of a frame would stall it
+    m_lightingProgram = compileProgram(fullscreenVertexSource, lightingFragmentSource, "LIGHTING");
+    if (m_geometryVariants.get(0) == 0 || m_geometryVariants.get(GEOMETRY_VERTEX_NORMALS) == 0 || m_lightingProgram == 0) {
+        return false;
+    }
+    bindUniformBlocks(m_lightingProgram);
+    m_lightingReflection.reflect(m_lightingProgram);
+    if (!m_materials.init(resources)) {
+        return false;
+    }
+
+    // samplers never change units, so they only have to be set once
+    glUseProgram(m_lightingProgram);
+    glUniform1i(glGetUniformLocation(m_lightingProgram, "gAlbedo"), GBUFFER_UNIT);
+    glUniform1i(glGetUniformLocation(m_lightingProgram, "gNormal"), GBUFFER_UNIT + 1);
+    glUniform1i(glGetUniformLocation(m_lightingProgram, "gMaterial"), GBUFFER_UNIT + 2);
+    glUniform1i(glGetUniformLocation(m_lightingProgram, "gDepth"), GBUFFER_UNIT + 3);
+    glUniform1i(glGetUniformLocation(m_lightingProgram, "lights"), LIGHT_UNIT);
+    glUniform1i(glGetUniformLocation(m_lightingProgram, "tiles"), TILE_UNIT);
+    glUniform1i(glGetUniformLocation(m_lightingProgram, "tileSize"), TILE_SIZE);
+    glUseProgram(0);
+
+    glGenVertexArrays(1, &m_emptyVao);
+
+    m_lightBufferHandle = resources.createBuffer("light list");
+    m_tileBufferHandle = resources.createBuffer("tile light lists");
+    m_lightBuffer = resources.buffer(m_lightBufferHandle);
+    m_tileBuffer = resources.buffer(m_tileBufferHandle);
+    glGenTextures(1, &m_lightTexture);
+    glGenTextures(1, &m_tileTexture);
+    // a texture buffer keeps pointing at its buffer object when glBufferData reallocates the storage
+    glBindBuffer(GL_TEXTURE_BUFFER, m_lightBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, m_lightTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_lightBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, m_tileBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, m_tileTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32I, m_tileBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    glGenQueries(4, &m_timerQueries[0][0]);
+
+    std::cout << "G-buffer: " << m_gbuffer.bytesPerPixel() << " bytes per pixel, "
+              << m_gbuffer.frameBandwidthBytes() / (1024.0 * 1024.0) << " MiB per frame at "
+              << width << "x" << height << std::endl;
+    return true;
+}
+
+void DeferredRenderer::destroy() {
+    m_gbuffer.destroy();
+    m_shadows.destroy();
+    m_geometryVariants.destroy();
+    m_materials.destroy();
+    glDeleteProgram(m_lightingProgram);
+    glDeleteVertexArrays(1, &m_emptyVao);
+    if (m_resources != nullptr) {
+        m_resources->release(m_lightBufferHandle);
+        m_resources->release(m_tileBufferHandle);
+    }
+    m_lightBuffer = m_tileBuffer = 0;
+    GLuint textures[]{m_lightTexture, m_tileTexture};
+    glDeleteTextures(2, textures);
+    glDeleteQueries(4, &m_timerQueries[0][0]);
+}
+
+void DeferredRenderer::binLights(const Scene &scene) {
+    static const std::size_t zone = profiler.addZone("light binning");
+    CpuZone timer(zone);
+    const int width = m_gbuffer.width();
+    const int height = m_gbuffer.height();
+    m_tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    const int tileCount = m_tilesX * m_tilesY;
+
+    // light i takes two RGBA32F texels: view space position + radius, colour * intensity
+    m_lightData.clear();
+    // tile t has its [first, count] header at 2t, the light indices follow after all headers
+    std::vector<std::vector<GLint>> tileLights(static_cast<std::size_t>(tileCount));
+
+    // a perspective projection's near plane is at z = -near in view space
+    const bool perspective = isPerspective(scene.projection);
+    const float nearPlane = perspective ? scene.projection[3][2] / (scene.projection[2][2] - 1.0f) : 0.0f;
+
+    for (std::size_t i = 0; i < scene.lights.size(); ++i) {
+        const PointLight &light = scene.lights[i];
+        vec4 world{light.position[0], light.position[1], light.position[2], 1.0f};
+        vec4 view;
+        mat4x4_mul_vec4(view, scene.view, world);
+        const float r = light.radius;
+        m_lightData.insert(m_lightData.end(), {view[0], view[1], view[2], r,
+                                               light.color[0] * light.intensity,
+                                               light.color[1] * light.intensity,
+                                               light.color[2] * light.intensity, 0.0f});
+        // entirely behind the near plane, it would only take up slots in every tile
+        if (perspective && view[2] - r >= -nearPlane) {
+            continue;
+        }
+
+        // project the corners of the light's bounding box, works for ortho and perspective cameras
+        float minX = 1.0f, minY = 1.0f, maxX = -1.0f, maxY = -1.0f;
+        bool crossesNearPlane = false;
+        for (int corner = 0; corner < 8; ++corner) {
+            vec4 p{view[0] + ((corner & 1) ? r : -r), view[1] + ((corner & 2) ? r : -r),
+                   view[2] + ((corner & 4) ? r : -r), 1.0f};
+            vec4 clip;
+            mat4x4_mul_vec4(clip, scene.projection, p);
+            if (clip[3] <= 1e-5f) {
+                crossesNearPlane = true;
+                break;
+            }
+            minX = std::min(minX, clip[0] / clip[3]);
+            maxX = std::max(maxX, clip[0] / clip[3]);
+            minY = std::min(minY, clip[1] / clip[3]);
+            maxY = std::max(maxY, clip[1] / clip[3]);
+        }
+        // the box reaches behind the camera but the light is partly in front, its projection is unbounded
+        if (crossesNearPlane) {
+            minX = minY = -1.0f;
+            maxX = maxY = 1.0f;
+        }
+        if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f) {
+            continue;
+        }
+
+        auto toTile = [](float ndc, int pixels, int tiles) {
+            int tile = static_cast<int>((ndc * 0.5f + 0.5f) * static_cast<float>(pixels)) / TILE_SIZE;
+            return std::clamp(tile, 0, tiles - 1);
+        };
+        const int x0 = toTile(minX, width, m_tilesX), x1 = toTile(maxX, width, m_tilesX);
+        const int y0 = toTile(minY, height, m_tilesY), y1 = toTile(maxY, height, m_tilesY);
+        for (int y = y0; y <= y1; ++y) {
+            for (int x = x0; x <= x1; ++x) {
+                std::vector<GLint> &list = tileLights[static_cast<std::size_t>(y * m_tilesX + x)];
+                if (static_cast<int>(list.size()) < MAX_LIGHTS_PER_TILE) {
+                    list.push_back(static_cast<GLint>(i));
+                }
+            }
+        }
+    }
+
+    m_tileData.assign(static_cast<std::size_t>(tileCount) * 2, 0);
+    for (int t = 0; t < tileCount; ++t) {
+        const std::vector<GLint> &list = tileLights[static_cast<std::size_t>(t)];
+        m_tileData[static_cast<std::size_t>(t) * 2] = static_cast<GLint>(m_tileData.size());
+        m_tileData[static_cast<std::size_t>(t) * 2 + 1] = static_cast<GLint>(list.size());
+        m_tileData.insert(m_tileData.end(), list.begin(), list.end());
+    }
+
+    // an empty texture buffer is not allowed, keep one dummy light around
+    if (m_lightData.empty()) {
+        m_lightData.assign(8, 0.0f);
+    }
+
+    // orphan the old storage so we never wait on the previous frame still reading it
+    m_resources->bufferData(m_lightBufferHandle, GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(m_lightData.size() * sizeof(float)),
+                            m_lightData.data(), GL_STREAM_DRAW);
+    m_resources->bufferData(m_tileBufferHandle, GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(m_tileData.size() * sizeof(GLint)),
+                            m_tileData.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void DeferredRenderer::readTimers() {
+    // the queries in this slot were issued two frames ago, only read them once they're done
+    GLuint *queries = m_timerQueries[m_frame % 2];
+    GLint available = 0;
+    glGetQueryObjectiv(queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return;
+    }
+
+    GLuint64 geometry = 0, lighting = 0;
+    glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &geometry);
+    glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &lighting);
+    m_geometryPassMs = static_cast<double>(geometry) / 1e6;
+    m_lightingPassMs = static_cast<double>(lighting) / 1e6;
+}
+
+void DeferredRenderer::render(const Scene &scene, int width, int height, GLuint targetFramebuffer) {
+    if (width <= 0 || height <= 0) {
+        return; // minimised
+    }
+    m_gbuffer.resize(width, height);
+
+    // only query objects that have been used once have a result to read
+    if (m_frame >= 2) {
+        readTimers();
+    }
+    GLuint *queries = m_timerQueries[m_frame % 2];
+
+    binLights(scene);
+    m_shadows.update(scene);
+
+    // ------------------ GEOMETRY PASS ------------------
+    glBeginQuery(GL_TIME_ELAPSED, queries[0]);
+    m_gbuffer.bindForWriting();
+    glEnable(GL_DEPTH_TEST);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // draws sorted by material, each look is switched to once however many meshes share it; the key
+    // is the material id in the high half and the mesh index in the low one
+    m_drawQueue.clear();
+    for (std::size_t i = 0; i < scene.meshes.size(); ++i) {
+        const MaterialId material = m_materials.intern(meshMaterial(scene.meshes[i]));
+        m_drawQueue.push_back(static_cast<std::uint64_t>(material) << 32 | i);
+    }
+    std::sort(m_drawQueue.begin(), m_drawQueue.end());
+    m_materials.upload();
+
+    UniformStream &uniforms = *m_uniforms;
+    ViewBlock view;
+    std::memcpy(view.view, scene.view, sizeof(mat4x4));
+    std::memcpy(view.projection, scene.projection, sizeof(mat4x4));
+    mat4x4_mul(view.viewProjection, scene.projection, scene.view);
+    const bool octahedral = m_gbuffer.config().normalEncoding == NormalEncoding::Octahedral16;
+    m_materialChanges = 0;
+    if (uniforms.write(VIEW_BLOCK_BINDING, view)) {
+        MaterialId current = 0;
+        std::uint32_t variant = 0;
+        bool culling = false;
+        for (std::size_t d = 0; d < m_drawQueue.size(); ++d) {
+            const auto id = static_cast<MaterialId>(m_drawQueue[d] >> 32);
+            if (d == 0 || id != current) {
+                const Material &material = m_materials.material(id);
+                if (d == 0 || material.variant != variant) {
+                    variant = material.variant;
+                    glUseProgram(m_geometryVariants.get(variant));
+                    glUniform1i(m_geometryVariants.reflection(variant).uniform(OCTAHEDRAL_NORMALS), octahedral);
+                }
+                if (material.state.cullBackFaces != culling) {
+                    culling = material.state.cullBackFaces;
+                    if (culling) {
+                        glEnable(GL_CULL_FACE);
+                    } else {
+                        glDisable(GL_CULL_FACE);
+                    }
+                }
+                m_materials.bind(id);
+                current = id;
+                ++m_materialChanges;
+            }
+            const Mesh &mesh = scene.meshes[m_drawQueue[d] & 0xffffffffu];
+            glBindVertexArray(mesh.vao);
+            glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, nullptr);
+        }
+        glDisable(GL_CULL_FACE);
+    }
+    glDisable(GL_DEPTH_TEST);
+    glEndQuery(GL_TIME_ELAPSED);
+
+    // ------------------ LIGHTING PASS ------------------
+    glBeginQuery(GL_TIME_ELAPSED, queries[1]);
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+    glViewport(0, 0, width, height);
+
+    mat4x4 invProjection;
+    mat4x4_invert(invProjection, scene.projection);
+    glUseProgram(m_lightingProgram);
+    glUniformMatrix4fv(m_lightingReflection.uniform(INV_PROJECTION), 1, GL_FALSE, &invProjection[0][0]);
+    glUniform1i(m_lightingReflection.uniform(PERSPECTIVE), isPerspective(scene.projection));
+    glUniform1i(m_lightingReflection.uniform(OCTAHEDRAL_NORMALS), octahedral);
+    glUniform1i(m_lightingReflection.uniform(TILES_X), m_tilesX);
+    glUniform3f(m_lightingReflection.uniform(AMBIENT), 0.05f, 0.05f, 0.05f);
+
+    // the sun is lit in view space like everything else in this pass
+    vec4 sunWorld{scene.sun.direction[0], scene.sun.direction[1], scene.sun.direction[2], 0.0f};
+    vec4 sunView;
+    mat4x4_mul_vec4(sunView, scene.view, sunWorld);
+    vec3 sunDirection{sunView[0], sunView[1], sunView[2]};
+    vec3_norm(sunDirection, sunDirection);
+    glUniform3fv(m_lightingReflection.uniform(SUN_DIRECTION), 1, sunDirection);
+    glUniform3f(m_lightingReflection.uniform(SUN_RADIANCE), scene.sun.color[0] * scene.sun.intensity,
+                scene.sun.color[1] * scene.sun.intensity, scene.sun.color[2] * scene.sun.intensity);
+    m_shadows.bind(m_lightingReflection, SHADOW_UNIT, scene);
+
+    m_gbuffer.bindTextures(GBUFFER_UNIT);
+    glActiveTexture(GL_TEXTURE0 + LIGHT_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, m_lightTexture);
+    glActiveTexture(GL_TEXTURE0 + TILE_UNIT);
+    glBindTexture(GL_TEXTURE_BUFFER, m_tileTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(m_emptyVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glEndQuery(GL_TIME_ELAPSED);
+
+    ++m_frame;
+}
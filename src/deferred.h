@@ -0,0 +1,87 @@
+#ifndef DEFERRED_H
+#define DEFERRED_H
+
+#include <cstdint>
+#include <vector>
+
+#include "gbuffer.h"
+#include "gpu_resources.h"
+#include "jobs.h"
+#include "material.h"
+#include "scene.h"
+#include "shader.h"
+#include "shader_reflection.h"
+#include "shadows.h"
+#include "uniform_stream.h"
+
+// deferred alternative to the forward path in main.cpp:
+// 1. geometry pass writes albedo / normal / material + depth into the g-buffer
+// 2. lights are binned into screen tiles on the CPU, the sun's shadow cascades are updated
+// 3. one fullscreen lighting pass reconstructs the position from depth and
+//    only evaluates the lights of the tile the pixel is in
+// the camera goes through a uniform block in uniforms, the lighting pass reads the target size from
+// the FrameBlock, which the caller binds for the frame
+// the meshes' looks are interned into a MaterialTable and the geometry pass draws them sorted by
+// material, a scene of many meshes but few looks switches program, state and block once per look
+class DeferredRenderer {
+public:
+    DeferredRenderer();
+
+    static constexpr int TILE_SIZE{16};
+    static constexpr int MAX_LIGHTS_PER_TILE{64};
+
+    // the targets and buffers belong to resources, which has to outlive the renderer
+    bool init(int width, int height, JobSystem &jobs, UniformStream &uniforms, GpuResources &resources,
+              const GBufferConfig &config = {}, const ShadowConfig &shadowConfig = {});
+    void destroy();
+
+    // draws the scene into targetFramebuffer, which has to be width x height
+    void render(const Scene &scene, int width, int height, GLuint targetFramebuffer = 0);
+
+    const GBuffer &gbuffer() const { return m_gbuffer; }
+    const ShadowCascades &shadows() const { return m_shadows; }
+    // GPU time of the passes, from timer queries of an earlier frame so reading them never stalls
+    double geometryPassMs() const { return m_geometryPassMs; }
+    double lightingPassMs() const { return m_lightingPassMs; }
+    // distinct looks seen so far and how many of them the last frame switched to
+    std::size_t materialCount() const { return m_materials.size(); }
+    std::size_t materialChanges() const { return m_materialChanges; }
+
+private:
+    void binLights(const Scene &scene);
+    void readTimers();
+
+    GBuffer m_gbuffer;
+    ShadowCascades m_shadows;
+    ShaderVariants m_geometryVariants;
+    GLuint m_lightingProgram{0};
+    ShaderReflection m_lightingReflection;
+    UniformStream *m_uniforms{nullptr};
+    MaterialTable m_materials;
+    // material << 32 | mesh index of every draw of the geometry pass
+    std::vector<std::uint64_t> m_drawQueue;
+    std::size_t m_materialChanges{0};
+    // core profile needs a VAO bound even for the attribute-less fullscreen triangle
+    GLuint m_emptyVao{0};
+
+    GpuResources *m_resources{nullptr};
+    // lights and the per tile light lists are uploaded as texture buffers
+    GpuHandle m_lightBufferHandle{GpuResources::NO_HANDLE};
+    GpuHandle m_tileBufferHandle{GpuResources::NO_HANDLE};
+    GLuint m_lightBuffer{0};
+    GLuint m_lightTexture{0};
+    GLuint m_tileBuffer{0};
+    GLuint m_tileTexture{0};
+    std::vector<float> m_lightData;
+    std::vector<GLint> m_tileData;
+    int m_tilesX{0};
+    int m_tilesY{0};
+
+    // two frames of [geometry, lighting] queries
+    GLuint m_timerQueries[2][2]{};
+    int m_frame{0};
+    double m_geometryPassMs{0.0};
+    double m_lightingPassMs{0.0};
+};
+
+#endif
@@ -0,0 +1,87 @@
+#include "dynamic_resolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+void DynamicResolution::init(const DynamicResolutionConfig &config) {
+    m_config = config;
+    m_scale = m_config.maxScale;
+    glGenQueries(QUERY_FRAMES * 2, &m_queries[0][0]);
+}
+
+void DynamicResolution::destroy() {
+    glDeleteQueries(QUERY_FRAMES * 2, &m_queries[0][0]);
+}
+
+void DynamicResolution::setEnabled(bool enabled) {
+    m_enabled = enabled;
+    m_scale = m_config.maxScale;
+    m_framesSinceChange = 0;
+}
+
+void DynamicResolution::beginFrame() {
+    // GL_TIME_ELAPSED can't nest with the per pass queries of the renderers, timestamps can
+    glQueryCounter(m_queries[m_frame % QUERY_FRAMES][0], GL_TIMESTAMP);
+}
+
+void DynamicResolution::endFrame() {
+    const unsigned slot = m_frame % QUERY_FRAMES;
+    glQueryCounter(m_queries[slot][1], GL_TIMESTAMP);
+    m_queryUsed[slot] = true;
+    ++m_frame;
+}
+
+void DynamicResolution::update(double cpuFrameMs) {
+    // oldest frame in the ring, the one that's about to be reused
+    const unsigned slot = m_frame % QUERY_FRAMES;
+    if (m_queryUsed[slot]) {
+        GLint available = 0;
+        glGetQueryObjectiv(m_queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(m_queries[slot][0], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(m_queries[slot][1], GL_QUERY_RESULT, &end);
+            const double gpuMs = static_cast<double>(end - begin) / 1e6;
+            m_gpuMs = m_gpuMs == 0.0 ? gpuMs : m_gpuMs * 0.9 + gpuMs * 0.1;
+        }
+        m_queryUsed[slot] = false;
+    }
+    m_cpuMs = m_cpuMs == 0.0 ? cpuFrameMs : m_cpuMs * 0.9 + cpuFrameMs * 0.1;
+
+    if (!m_enabled || m_gpuMs == 0.0 || ++m_framesSinceChange < m_config.settleFrames) {
+        return;
+    }
+
+    const double budget = m_config.targetFrameMs;
+    const bool gpuOverBudget = m_gpuMs > budget;
+    // a bit of headroom before scaling back up, otherwise it flips between two steps
+    const bool gpuHasHeadroom = m_gpuMs < budget * 0.8;
+    const bool cpuBound = m_cpuMs > budget && !gpuOverBudget;
+    if (cpuBound || (!gpuOverBudget && !gpuHasHeadroom)) {
+        return;
+    }
+
+    // one step at a time, the next measurement shows whether that was enough
+    const float step = m_config.scaleStep;
+    float next = m_scale;
+    if (gpuOverBudget) {
+        next = m_scale - step;
+    } else {
+        // GPU cost scales with the pixel count, which is scale^2, only go up if a step still fits
+        const float fits = m_scale * static_cast<float>(std::sqrt(budget * 0.9 / m_gpuMs));
+        if (fits >= m_scale + step) {
+            next = m_scale + step;
+        }
+    }
+    // snap to the step grid so repeated steps don't drift
+    next = std::clamp(std::round(next / step) * step, m_config.minScale, m_config.maxScale);
+    if (next != m_scale) {
+        m_scale = next;
+        m_framesSinceChange = 0;
+    }
+}
+
+void DynamicResolution::renderSize(int outputWidth, int outputHeight, int &width, int &height) const {
+    width = std::max(1, static_cast<int>(std::lround(static_cast<float>(outputWidth) * scale())));
+    height = std::max(1, static_cast<int>(std::lround(static_cast<float>(outputHeight) * scale())));
+}
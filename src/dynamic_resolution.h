@@ -0,0 +1,63 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include "../include/glad/glad.h"
+
+struct DynamicResolutionConfig {
+    // frame budget we try to hold
+    double targetFrameMs{1000.0 / 60.0};
+    // range of the render scale, applied to width and height
+    float minScale{0.5f};
+    float maxScale{1.0f};
+    // the scale only moves in steps of this size, every step reallocates the render targets
+    float scaleStep{0.05f};
+    // frames to wait after a change before the next one, the GPU timings lag a few frames behind
+    int settleFrames{15};
+};
+
+// picks the internal render resolution from the measured frame times:
+// - GPU time comes from timestamp queries around the frame, read a few frames later so they never stall
+// - CPU time is measured by the caller before the buffer swap, so waiting for vsync doesn't count
+// if the GPU misses the budget the scale goes down, if it has headroom it goes back up
+// if only the CPU is slow nothing changes, fewer pixels wouldn't help
+class DynamicResolution {
+public:
+    static constexpr int QUERY_FRAMES{4};
+
+    void init(const DynamicResolutionConfig &config = {});
+    void destroy();
+
+    // wrap all GPU work of the frame
+    void beginFrame();
+    void endFrame();
+    // call once per frame after endFrame() with the CPU time of the last frame, measured before
+    // the buffer swap so the vsync wait isn't counted
+    void update(double cpuFrameMs);
+
+    bool enabled() const { return m_enabled; }
+    // switching off goes straight back to full resolution
+    void setEnabled(bool enabled);
+
+    float scale() const { return m_enabled ? m_scale : 1.0f; }
+    // internal size for a given output size, never smaller than one pixel
+    void renderSize(int outputWidth, int outputHeight, int &width, int &height) const;
+
+    double gpuFrameMs() const { return m_gpuMs; }
+    double cpuFrameMs() const { return m_cpuMs; }
+
+private:
+    DynamicResolutionConfig m_config;
+    bool m_enabled{false};
+    float m_scale{1.0f};
+    int m_framesSinceChange{0};
+
+    // [frame][begin, end] timestamps
+    GLuint m_queries[QUERY_FRAMES][2]{};
+    bool m_queryUsed[QUERY_FRAMES]{};
+    unsigned m_frame{0};
+    // smoothed frame times
+    double m_gpuMs{0.0};
+    double m_cpuMs{0.0};
+};
+
+#endif
@@ -0,0 +1,190 @@
+#include "file_watcher.h"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // a changed file is read once it had no further events for this long, saving in an editor
+    // usually is a burst of writes
+    const int SETTLE_MS{50};
+
+    bool readFile(const std::string &path, std::string &contents) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        std::ostringstream stream;
+        stream << file.rdbuf();
+        contents = stream.str();
+        return true;
+    }
+
+    std::string directoryOf(const std::string &path) {
+        const std::size_t slash = path.find_last_of('/');
+        return slash == std::string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+    }
+
+    std::string fileNameOf(const std::string &path) {
+        const std::size_t slash = path.find_last_of('/');
+        return slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+}
+
+FileWatcher::FileWatcher() {
+#ifdef __linux__
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_changeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_inotify < 0 || m_wakeFd < 0 || m_changeFd < 0) {
+        std::cout << "ERROR::FILE_WATCHER::INOTIFY_FAILED" << std::endl;
+        return;
+    }
+    m_thread = std::thread([this] { watchLoop(); });
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (m_thread.joinable()) {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = write(m_wakeFd, &one, sizeof(one));
+        m_thread.join();
+    }
+    if (m_inotify >= 0) {
+        close(m_inotify);
+    }
+    if (m_wakeFd >= 0) {
+        close(m_wakeFd);
+    }
+    if (m_changeFd >= 0) {
+        close(m_changeFd);
+    }
+#endif
+}
+
+bool FileWatcher::watch(const std::string &path, Callback callback) {
+    std::string contents;
+    const bool loaded = readFile(path, contents);
+    if (loaded) {
+        callback(std::move(contents));
+    } else {
+        std::cout << "ERROR::FILE_WATCHER::FILE_NOT_READABLE\n" << path << std::endl;
+    }
+
+    // watched even if it doesn't exist yet, it gets picked up once it's created
+    const bool known = m_callbacks.contains(path);
+    m_callbacks[path].push_back(std::move(callback));
+    if (known) {
+        return loaded;
+    }
+#ifdef __linux__
+    if (m_inotify >= 0) {
+        const std::string directory = directoryOf(path);
+        const int descriptor = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (descriptor < 0) {
+            std::cout << "ERROR::FILE_WATCHER::DIRECTORY_NOT_WATCHABLE\n" << directory << std::endl;
+        } else {
+            m_directories[descriptor] = directory;
+        }
+        m_paths[directory + "/" + fileNameOf(path)] = path;
+    }
+#endif
+    return loaded;
+}
+
+void FileWatcher::update() {
+#ifdef __linux__
+    // reset before taking the changes, a change queued after this signals again
+    if (m_changeFd >= 0) {
+        std::uint64_t count;
+        [[maybe_unused]] const ssize_t drained = read(m_changeFd, &count, sizeof(count));
+    }
+#endif
+    std::vector<Change> changes;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_changes.empty()) {
+            return;
+        }
+        changes.swap(m_changes);
+    }
+    for (Change &change : changes) {
+        auto found = m_callbacks.find(change.path);
+        if (found == m_callbacks.end()) {
+            continue;
+        }
+        for (std::size_t i = 0; i < found->second.size(); ++i) {
+            // every callback but the last gets a copy
+            found->second[i](i + 1 < found->second.size() ? std::string(change.contents) : std::move(change.contents));
+        }
+    }
+}
+
+void FileWatcher::watchLoop() {
+#ifdef __linux__
+    using Clock = std::chrono::steady_clock;
+    // changed files and when they were last written
+    std::unordered_map<std::string, Clock::time_point> pending;
+    alignas(inotify_event) char buffer[4096];
+
+    while (true) {
+        pollfd fds[2]{{m_inotify, POLLIN, 0}, {m_wakeFd, POLLIN, 0}};
+        // sleep until something happens, or until the oldest pending file has settled
+        const int timeout = pending.empty() ? -1 : SETTLE_MS;
+        if (poll(fds, 2, timeout) < 0) {
+            continue;
+        }
+        if (fds[1].revents & POLLIN) {
+            return;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            ssize_t length;
+            while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (char *at = buffer; at < buffer + length;) {
+                    const auto *event = reinterpret_cast<const inotify_event *>(at);
+                    at += sizeof(inotify_event) + event->len;
+                    auto directory = m_directories.find(event->wd);
+                    if (directory == m_directories.end() || event->len == 0) {
+                        continue;
+                    }
+                    auto path = m_paths.find(directory->second + "/" + event->name);
+                    if (path != m_paths.end()) {
+                        pending[path->second] = Clock::now();
+                    }
+                }
+            }
+        }
+
+        const auto now = Clock::now();
+        for (auto entry = pending.begin(); entry != pending.end();) {
+            if (now - entry->second < std::chrono::milliseconds(SETTLE_MS)) {
+                ++entry;
+                continue;
+            }
+            Change change{entry->first, {}};
+            if (readFile(change.path, change.contents)) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                // a newer version replaces one that wasn't picked up yet
+                std::erase_if(m_changes, [&change](const Change &queued) { return queued.path == change.path; });
+                m_changes.push_back(std::move(change));
+                const std::uint64_t one = 1;
+                [[maybe_unused]] const ssize_t written = write(m_changeFd, &one, sizeof(one));
+            }
+            entry = pending.erase(entry);
+        }
+    }
+#endif
+}
@@ -0,0 +1,62 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// reloads files when they change on disk
+// - a background thread waits on inotify for the directories of the watched files and reads a
+//   changed file once the writes to it have settled, so the render thread never touches the disk
+// - the contents are handed to the file's callback from update(), on the thread calling it
+// - editors that save by writing a new file and renaming it over the old one are caught as well,
+//   that's why the directories are watched and not the files
+// without inotify (anything but Linux) files are loaded once and never reloaded
+class FileWatcher {
+public:
+    using Callback = std::function<void(std::string &&contents)>;
+
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    // reads the file right away and hands it to the callback before returning, then again on
+    // every change, false if it couldn't be read now
+    bool watch(const std::string &path, Callback callback);
+    // runs the callbacks of files that changed since the last call
+    void update();
+    // readable while changes are waiting for update(), for sleeping in glfwWaitEvents until a
+    // file changes, -1 without inotify
+    int changeFd() const { return m_changeFd; }
+
+private:
+    struct Change {
+        std::string path;
+        std::string contents;
+    };
+
+    void watchLoop();
+
+    std::unordered_map<std::string, std::vector<Callback>> m_callbacks;
+
+    std::mutex m_mutex;
+    // directory watch descriptor -> directory
+    std::unordered_map<int, std::string> m_directories;
+    // path as inotify reports it -> path as it was passed to watch()
+    std::unordered_map<std::string, std::string> m_paths;
+    std::vector<Change> m_changes;
+
+    int m_inotify{-1};
+    // written to wake the thread up for shutdown
+    int m_wakeFd{-1};
+    // written by the thread whenever it queues a change
+    int m_changeFd{-1};
+    std::thread m_thread;
+};
+
+#endif
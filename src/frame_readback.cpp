@@ -0,0 +1,140 @@
+#include "frame_readback.h"
+
+#include <cstring>
+#include <iostream>
+
+bool FrameReadback::init(int width, int height, GpuResources &resources) {
+    m_resources = &resources;
+    glGenFramebuffers(1, &m_framebuffer);
+    m_colorHandle = resources.createRenderbuffer("readback color");
+    m_depthHandle = resources.createRenderbuffer("readback depth");
+    m_color = resources.renderbuffer(m_colorHandle);
+    m_depth = resources.renderbuffer(m_depthHandle);
+    for (Slot &slot : m_slots) {
+        slot.handle = resources.createBuffer("readback pixel buffer");
+        slot.buffer = resources.buffer(slot.handle);
+    }
+    resize(width, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR::FRAME_READBACK::FRAMEBUFFER_INCOMPLETE\n" << status << std::endl;
+        destroy();
+        return false;
+    }
+    return true;
+}
+
+void FrameReadback::destroy() {
+    releaseSlots();
+    if (m_resources != nullptr) {
+        for (Slot &slot : m_slots) {
+            m_resources->release(slot.handle);
+        }
+        m_resources->release(m_colorHandle);
+        m_resources->release(m_depthHandle);
+    }
+    for (Slot &slot : m_slots) {
+        slot.buffer = 0;
+    }
+    glDeleteFramebuffers(1, &m_framebuffer);
+    m_framebuffer = m_color = m_depth = 0;
+    m_width = m_height = 0;
+}
+
+void FrameReadback::resize(int width, int height) {
+    if (width == m_width && height == m_height) {
+        return;
+    }
+    releaseSlots();
+    m_width = width;
+    m_height = height;
+
+    // same formats as the default framebuffer glfw asks for
+    glBindRenderbuffer(GL_RENDERBUFFER, m_color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    m_resources->setBytes(m_colorHandle, storageBytes(GL_RGBA8, width, height));
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    m_resources->setBytes(m_depthHandle, storageBytes(GL_DEPTH24_STENCIL8, width, height));
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depth);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    const GLsizeiptr frameBytes = static_cast<GLsizeiptr>(width) * height * 4;
+    for (Slot &slot : m_slots) {
+        m_resources->bufferData(slot.handle, GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void FrameReadback::capture() {
+    if (m_pending == FRAMES_IN_FLIGHT) {
+        // the oldest frame is in the slot this capture goes into; callers read it first, so this
+        // only guards the ring
+        Slot &oldest = m_slots[m_next];
+        glDeleteSync(oldest.fence);
+        oldest.fence = nullptr;
+        --m_pending;
+        ++m_droppedFrames;
+    }
+
+    Slot &slot = m_slots[m_next];
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    // into the bound pixel buffer, returns as soon as the copy is queued
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_next = (m_next + 1) % FRAMES_IN_FLIGHT;
+    ++m_pending;
+}
+
+bool FrameReadback::read(std::vector<unsigned char> &pixels, bool wait) {
+    if (m_pending == 0) {
+        return false;
+    }
+    Slot &slot = m_slots[(m_next - m_pending + FRAMES_IN_FLIGHT) % FRAMES_IN_FLIGHT];
+
+    // the flush makes sure the fence gets to the GPU at all, waiting on it could hang otherwise
+    const GLenum result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    --m_pending;
+    if (result == GL_WAIT_FAILED) {
+        std::cout << "ERROR::FRAME_READBACK::WAIT_FAILED" << std::endl;
+        return false;
+    }
+
+    const std::size_t frameBytes = static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height) * 4;
+    pixels.resize(frameBytes);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    const void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(frameBytes), GL_MAP_READ_BIT);
+    const bool copied = mapped != nullptr;
+    if (copied) {
+        std::memcpy(pixels.data(), mapped, frameBytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return copied;
+}
+
+void FrameReadback::releaseSlots() {
+    for (Slot &slot : m_slots) {
+        if (slot.fence != nullptr) {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+    }
+    m_next = 0;
+    m_pending = 0;
+}
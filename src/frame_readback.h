@@ -0,0 +1,70 @@
+#ifndef FRAME_READBACK_H
+#define FRAME_READBACK_H
+
+#include <cstddef>
+#include <vector>
+
+#include "../include/glad/glad.h"
+
+#include "gpu_resources.h"
+
+// stands in for the default framebuffer of a context that has none, like glfw's surfaceless EGL
+// contexts, and hands the finished frames back to the CPU
+// - frames are rendered into framebuffer() and copied into a ring of pixel buffer objects by
+//   capture(), which only queues the copy, so the CPU never waits for the frame to finish
+// - read() hands out the oldest captured frame once its fence passed, FRAMES_IN_FLIGHT frames
+//   later at the most; capturing into a full ring drops the oldest unread frame, so callers that
+//   need every frame read it with wait set first
+// pixels are RGBA8, rows bottom to top like glReadPixels returns them
+class FrameReadback {
+public:
+    static constexpr int FRAMES_IN_FLIGHT{3};
+
+    // the targets and pixel buffers belong to resources, which has to outlive the ring
+    bool init(int width, int height, GpuResources &resources);
+    void destroy();
+
+    // reallocates the target and the ring for another size, frames still in flight are dropped
+    void resize(int width, int height);
+
+    GLuint framebuffer() const { return m_framebuffer; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    // queues the copy of the current contents of framebuffer() into the next pixel buffer
+    void capture();
+    // copies the oldest captured frame into pixels, false if there is none or, unless wait is set,
+    // if the GPU hasn't finished it yet
+    bool read(std::vector<unsigned char> &pixels, bool wait);
+
+    // captured frames not read yet
+    int pending() const { return m_pending; }
+    // frames captured over a full ring, they were never read
+    std::size_t droppedFrames() const { return m_droppedFrames; }
+
+private:
+    struct Slot {
+        GpuHandle handle{GpuResources::NO_HANDLE};
+        GLuint buffer{0};
+        GLsync fence{nullptr};
+    };
+
+    void releaseSlots();
+
+    GpuResources *m_resources{nullptr};
+    GLuint m_framebuffer{0};
+    GpuHandle m_colorHandle{GpuResources::NO_HANDLE};
+    GpuHandle m_depthHandle{GpuResources::NO_HANDLE};
+    GLuint m_color{0};
+    GLuint m_depth{0};
+    int m_width{0};
+    int m_height{0};
+
+    Slot m_slots[FRAMES_IN_FLIGHT];
+    // slot the next capture goes into, the oldest pending one is m_pending slots before it
+    int m_next{0};
+    int m_pending{0};
+    std::size_t m_droppedFrames{0};
+};
+
+#endif
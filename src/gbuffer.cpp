@@ -0,0 +1,118 @@
+#include "gbuffer.h"
+
+#include <iostream>
+
+namespace {
+    GLuint createTarget(GpuResources &resources, GpuHandle &handle, const char *label, GLenum internalFormat, GLenum format,
+                        GLenum type, int width, int height) {
+        handle = resources.createTexture(label);
+        const GLuint texture = resources.texture(handle);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internalFormat), width, height, 0, format, type, nullptr);
+        resources.setBytes(handle, storageBytes(internalFormat, width, height));
+        // the lighting pass uses texelFetch, so no filtering or mipmaps are needed
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return texture;
+    }
+}
+
+bool GBuffer::create(int width, int height, const GBufferConfig &config, GpuResources &resources) {
+    m_resources = &resources;
+    m_config = config;
+    m_width = width;
+    m_height = height;
+    glGenFramebuffers(1, &m_fbo);
+    return createAttachments();
+}
+
+void GBuffer::destroy() {
+    releaseAttachments();
+    glDeleteFramebuffers(1, &m_fbo);
+    m_fbo = 0;
+}
+
+bool GBuffer::resize(int width, int height) {
+    if (width == m_width && height == m_height) {
+        return true;
+    }
+
+    releaseAttachments();
+    m_width = width;
+    m_height = height;
+    return createAttachments();
+}
+
+bool GBuffer::createAttachments() {
+    GpuResources &resources = *m_resources;
+    m_albedo = createTarget(resources, m_handles[0], "g-buffer albedo", GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, m_width, m_height);
+    if (m_config.normalEncoding == NormalEncoding::Octahedral16) {
+        m_normal = createTarget(resources, m_handles[1], "g-buffer normal", GL_RG16, GL_RG, GL_UNSIGNED_SHORT, m_width, m_height);
+    } else {
+        m_normal = createTarget(resources, m_handles[1], "g-buffer normal", GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, m_width, m_height);
+    }
+    m_material = createTarget(resources, m_handles[2], "g-buffer material", GL_RG8, GL_RG, GL_UNSIGNED_BYTE, m_width, m_height);
+    if (m_config.floatDepth) {
+        m_depth = createTarget(resources, m_handles[3], "g-buffer depth", GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT,
+                               m_width, m_height);
+    } else {
+        m_depth = createTarget(resources, m_handles[3], "g-buffer depth", GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT,
+                               GL_UNSIGNED_INT, m_width, m_height);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_albedo, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_normal, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, m_material, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth, 0);
+
+    const GLenum drawBuffers[]{GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
+    glDrawBuffers(3, drawBuffers);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR::GBUFFER::FRAMEBUFFER_INCOMPLETE\n" << status << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void GBuffer::releaseAttachments() {
+    if (m_resources != nullptr) {
+        for (GpuHandle &handle : m_handles) {
+            m_resources->release(handle);
+        }
+    }
+    m_albedo = m_normal = m_material = m_depth = 0;
+}
+
+void GBuffer::bindForWriting() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glViewport(0, 0, m_width, m_height);
+}
+
+void GBuffer::bindTextures(GLuint firstUnit) const {
+    const GLuint textures[]{m_albedo, m_normal, m_material, m_depth};
+    for (GLuint i = 0; i < 4; ++i) {
+        glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+std::size_t GBuffer::bytesPerPixel() const {
+    std::size_t albedo = 4;
+    std::size_t normal = m_config.normalEncoding == NormalEncoding::Octahedral16 ? 4 : 8;
+    std::size_t material = 2;
+    // 24 bit depth is padded to 32 bits by every driver we care about
+    std::size_t depth = 4;
+    return albedo + normal + material + depth;
+}
+
+std::size_t GBuffer::frameBandwidthBytes() const {
+    return bytesPerPixel() * static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height) * 2;
+}
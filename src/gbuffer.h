@@ -0,0 +1,65 @@
+#ifndef GBUFFER_H
+#define GBUFFER_H
+
+#include <cstddef>
+
+#include "../include/glad/glad.h"
+
+#include "gpu_resources.h"
+
+// how the view space normal is stored in the g-buffer
+enum class NormalEncoding {
+    Octahedral16, // RG16, two unorm channels, 4 bytes per pixel
+    Float16x4     // RGBA16F, uncompressed xyz, 8 bytes per pixel, kept around to compare against
+};
+
+struct GBufferConfig {
+    NormalEncoding normalEncoding{NormalEncoding::Octahedral16};
+    // GL_DEPTH_COMPONENT32F instead of GL_DEPTH_COMPONENT24
+    bool floatDepth{false};
+};
+
+// render targets of the deferred geometry pass:
+// 0 - RGBA8 albedo
+// 1 - view space normal, see NormalEncoding
+// 2 - RG8 roughness / metallic packed together
+// depth - used to reconstruct the view space position in the lighting pass
+class GBuffer {
+public:
+    // the attachments belong to resources, which has to outlive the g-buffer
+    bool create(int width, int height, const GBufferConfig &config, GpuResources &resources);
+    void destroy();
+    // recreates the attachments, does nothing if the size didn't change
+    bool resize(int width, int height);
+
+    void bindForWriting() const;
+    // binds albedo, normal, material and depth to four consecutive texture units
+    void bindTextures(GLuint firstUnit) const;
+
+    std::size_t bytesPerPixel() const;
+    // bytes moved through the g-buffer each frame: every pixel is written once by the
+    // geometry pass and read once by the lighting pass
+    std::size_t frameBandwidthBytes() const;
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    const GBufferConfig &config() const { return m_config; }
+
+private:
+    bool createAttachments();
+    void releaseAttachments();
+
+    GBufferConfig m_config;
+    int m_width{0};
+    int m_height{0};
+    GpuResources *m_resources{nullptr};
+    GLuint m_fbo{0};
+    // albedo, normal, material and depth
+    GpuHandle m_handles[4]{};
+    GLuint m_albedo{0};
+    GLuint m_normal{0};
+    GLuint m_material{0};
+    GLuint m_depth{0};
+};
+
+#endif
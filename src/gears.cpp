@@ -0,0 +1,142 @@
+#include "gears.h"
+
+#include <cmath>
+
+namespace {
+    // gear() of gears.c, glFoo calls swapped for the recorder's
+    void gear(ImmediateRecorder &gl, float innerRadius, float outerRadius, float width, int teeth, float toothDepth) {
+        const float pi = 3.14159265f;
+        const float r0 = innerRadius;
+        const float r1 = outerRadius - toothDepth / 2.0f;
+        const float r2 = outerRadius + toothDepth / 2.0f;
+        const float da = 2.0f * pi / static_cast<float>(teeth) / 4.0f;
+        const auto toothAngle = [pi, teeth](int i) { return static_cast<float>(i) * 2.0f * pi / static_cast<float>(teeth); };
+
+        gl.shadeModel(true);
+
+        gl.normal3f(0.0f, 0.0f, 1.0f);
+
+        // front face
+        gl.begin(ImmediatePrimitive::QuadStrip);
+        for (int i = 0; i <= teeth; ++i) {
+            const float angle = toothAngle(i);
+            gl.vertex3f(r0 * std::cos(angle), r0 * std::sin(angle), width * 0.5f);
+            gl.vertex3f(r1 * std::cos(angle), r1 * std::sin(angle), width * 0.5f);
+            if (i < teeth) {
+                gl.vertex3f(r0 * std::cos(angle), r0 * std::sin(angle), width * 0.5f);
+                gl.vertex3f(r1 * std::cos(angle + 3 * da), r1 * std::sin(angle + 3 * da), width * 0.5f);
+            }
+        }
+        gl.end();
+
+        // front sides of the teeth
+        gl.begin(ImmediatePrimitive::Quads);
+        for (int i = 0; i < teeth; ++i) {
+            const float angle = toothAngle(i);
+            gl.vertex3f(r1 * std::cos(angle), r1 * std::sin(angle), width * 0.5f);
+            gl.vertex3f(r2 * std::cos(angle + da), r2 * std::sin(angle + da), width * 0.5f);
+            gl.vertex3f(r2 * std::cos(angle + 2 * da), r2 * std::sin(angle + 2 * da), width * 0.5f);
+            gl.vertex3f(r1 * std::cos(angle + 3 * da), r1 * std::sin(angle + 3 * da), width * 0.5f);
+        }
+        gl.end();
+
+        gl.normal3f(0.0f, 0.0f, -1.0f);
+
+        // back face
+        gl.begin(ImmediatePrimitive::QuadStrip);
+        for (int i = 0; i <= teeth; ++i) {
+            const float angle = toothAngle(i);
+            gl.vertex3f(r1 * std::cos(angle), r1 * std::sin(angle), -width * 0.5f);
+            gl.vertex3f(r0 * std::cos(angle), r0 * std::sin(angle), -width * 0.5f);
+            if (i < teeth) {
+                gl.vertex3f(r1 * std::cos(angle + 3 * da), r1 * std::sin(angle + 3 * da), -width * 0.5f);
+                gl.vertex3f(r0 * std::cos(angle), r0 * std::sin(angle), -width * 0.5f);
+            }
+        }
+        gl.end();
+
+        // back sides of the teeth
+        gl.begin(ImmediatePrimitive::Quads);
+        for (int i = 0; i < teeth; ++i) {
+            const float angle = toothAngle(i);
+            gl.vertex3f(r1 * std::cos(angle + 3 * da), r1 * std::sin(angle + 3 * da), -width * 0.5f);
+            gl.vertex3f(r2 * std::cos(angle + 2 * da), r2 * std::sin(angle + 2 * da), -width * 0.5f);
+            gl.vertex3f(r2 * std::cos(angle + da), r2 * std::sin(angle + da), -width * 0.5f);
+            gl.vertex3f(r1 * std::cos(angle), r1 * std::sin(angle), -width * 0.5f);
+        }
+        gl.end();
+
+        // outward faces of the teeth
+        gl.begin(ImmediatePrimitive::QuadStrip);
+        for (int i = 0; i < teeth; ++i) {
+            const float angle = toothAngle(i);
+            gl.vertex3f(r1 * std::cos(angle), r1 * std::sin(angle), width * 0.5f);
+            gl.vertex3f(r1 * std::cos(angle), r1 * std::sin(angle), -width * 0.5f);
+            float u = r2 * std::cos(angle + da) - r1 * std::cos(angle);
+            float v = r2 * std::sin(angle + da) - r1 * std::sin(angle);
+            float length = std::sqrt(u * u + v * v);
+            gl.normal3f(v / length, -u / length, 0.0f);
+            gl.vertex3f(r2 * std::cos(angle + da), r2 * std::sin(angle + da), width * 0.5f);
+            gl.vertex3f(r2 * std::cos(angle + da), r2 * std::sin(angle + da), -width * 0.5f);
+            gl.normal3f(std::cos(angle), std::sin(angle), 0.0f);
+            gl.vertex3f(r2 * std::cos(angle + 2 * da), r2 * std::sin(angle + 2 * da), width * 0.5f);
+            gl.vertex3f(r2 * std::cos(angle + 2 * da), r2 * std::sin(angle + 2 * da), -width * 0.5f);
+            u = r1 * std::cos(angle + 3 * da) - r2 * std::cos(angle + 2 * da);
+            v = r1 * std::sin(angle + 3 * da) - r2 * std::sin(angle + 2 * da);
+            gl.normal3f(v, -u, 0.0f);
+            gl.vertex3f(r1 * std::cos(angle + 3 * da), r1 * std::sin(angle + 3 * da), width * 0.5f);
+            gl.vertex3f(r1 * std::cos(angle + 3 * da), r1 * std::sin(angle + 3 * da), -width * 0.5f);
+            gl.normal3f(std::cos(angle), std::sin(angle), 0.0f);
+        }
+        gl.vertex3f(r1, 0.0f, width * 0.5f);
+        gl.vertex3f(r1, 0.0f, -width * 0.5f);
+        gl.end();
+
+        gl.shadeModel(false);
+
+        // inside radius cylinder
+        gl.begin(ImmediatePrimitive::QuadStrip);
+        for (int i = 0; i <= teeth; ++i) {
+            const float angle = toothAngle(i);
+            gl.normal3f(-std::cos(angle), -std::sin(angle), 0.0f);
+            gl.vertex3f(r0 * std::cos(angle), r0 * std::sin(angle), -width * 0.5f);
+            gl.vertex3f(r0 * std::cos(angle), r0 * std::sin(angle), width * 0.5f);
+        }
+        gl.end();
+    }
+
+    struct GearParameters {
+        float color[3];
+        float innerRadius, outerRadius, width;
+        int teeth;
+        float x, y, degrees;
+    };
+}
+
+bool addGears(ImmediateRecorder &recorder, const mat4x4 placement, std::vector<Mesh> &meshes) {
+    // sizes, colours and first frame positions from gears.c
+    const GearParameters gears[]{{{0.8f, 0.1f, 0.0f}, 1.0f, 4.0f, 1.0f, 20, -3.0f, -2.0f, 0.0f},
+                                 {{0.0f, 0.8f, 0.2f}, 0.5f, 2.0f, 2.0f, 10, 3.1f, -2.0f, -9.0f},
+                                 {{0.2f, 0.2f, 1.0f}, 1.3f, 2.0f, 0.5f, 10, -3.1f, 4.2f, -25.0f}};
+    for (const GearParameters &parameters : gears) {
+        // the example positions its display lists with glTranslate / glRotate around glCallList,
+        // baked into the vertices here since the scene's meshes are in world space
+        mat4x4 translated, transform;
+        mat4x4_translate(translated, parameters.x, parameters.y, 0.0f);
+        mat4x4_rotate_Z(translated, translated, parameters.degrees * 3.14159265f / 180.0f);
+        mat4x4_mul(transform, placement, translated);
+
+        recorder.newList();
+        recorder.setTransform(transform);
+        recorder.material(parameters.color[0], parameters.color[1], parameters.color[2]);
+        gear(recorder, parameters.innerRadius, parameters.outerRadius, parameters.width, parameters.teeth, 0.7f);
+        Mesh mesh;
+        if (!recorder.endList(mesh)) {
+            return false;
+        }
+        // gears.c draws them with GL_CULL_FACE
+        mesh.cullBackFaces = true;
+        meshes.push_back(mesh);
+    }
+    return true;
+}
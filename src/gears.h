@@ -0,0 +1,15 @@
+#ifndef GEARS_H
+#define GEARS_H
+
+#include <vector>
+
+#include "immediate.h"
+#include "scene.h"
+
+// the three gears of glfw/examples/gears.c, recorded through the ImmediateRecorder with the
+// example's own glBegin / glEnd code, in the pose of its first frame
+// placement moves them from the example's space, about 10 units across, into the scene
+// appends one mesh per gear, false if a gear couldn't be made
+bool addGears(ImmediateRecorder &recorder, const mat4x4 placement, std::vector<Mesh> &meshes);
+
+#endif
@@ -0,0 +1,21 @@
+#include "gl_extensions.h"
+
+#include <cstring>
+
+PFNGLVIEWPORTARRAYVPROC glad_glViewportArrayv = nullptr;
+
+void loadGLExtensions(GLADloadproc load) {
+    glad_glViewportArrayv = reinterpret_cast<PFNGLVIEWPORTARRAYVPROC>(load("glViewportArrayv"));
+}
+
+bool hasGLExtension(const char *name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const auto *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (std::strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,21 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include "../include/glad/glad.h"
+
+// entry points past the GL 3.3 core glad was generated for, loaded into glad-style pointers so the
+// profiler's and the tracer's wrappers can be swapped in like for the core ones
+// - null when the driver doesn't export them, check the extension before calling
+
+// GL_ARB_viewport_array
+#define GL_MAX_VIEWPORTS 0x825B
+typedef void (APIENTRYP PFNGLVIEWPORTARRAYVPROC)(GLuint first, GLsizei count, const GLfloat *v);
+extern PFNGLVIEWPORTARRAYVPROC glad_glViewportArrayv;
+#define glViewportArrayv glad_glViewportArrayv
+
+// call right after gladLoadGLLoader, with the same loader
+void loadGLExtensions(GLADloadproc load);
+// whether the current context lists the extension, walks the whole list, cache the result
+bool hasGLExtension(const char *name);
+
+#endif
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "../include/glad/glad.h" // always link glad before glfw
+#include "GLFW/glfw3.h"
+
+#include "gl_extensions.h"
+#include "gl_trace.h"
+
+// gl_replay: plays a trace recorded with `open_gl --trace <file>` back without a window, on
+// OSMesa through glfw's null platform, and reports how long the driver took per frame
+// --finish waits for the GPU after every frame, without it only the CPU side of the calls is timed
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cout << "usage: gl_replay <trace> [--finish]" << std::endl;
+        return 1;
+    }
+    const bool finishFrames = argc > 2 && std::strcmp(argv[2], "--finish") == 0;
+
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    if (!glfwInit()) {
+        std::cout << "Failed to initialize GLFW" << std::endl;
+        return 1;
+    }
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow *window = glfwCreateWindow(800, 600, "gl_replay", nullptr, nullptr);
+    if (window == nullptr) {
+        std::cout << "Failed to create an OSMesa context" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    loadGLExtensions((GLADloadproc) glfwGetProcAddress);
+
+    GLTraceReplay replay;
+    if (!replay.open(argv[1])) {
+        glfwTerminate();
+        return 1;
+    }
+
+    std::vector<double> frameMs;
+    const auto start = std::chrono::steady_clock::now();
+    for (bool more = true; more;) {
+        const auto frameStart = std::chrono::steady_clock::now();
+        more = replay.replayFrame();
+        if (finishFrames) {
+            glFinish();
+        }
+        frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+    }
+    glFinish();
+    const double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // the last entry is whatever came after the final frame end, usually the cleanup
+    if (frameMs.size() > 1) {
+        frameMs.pop_back();
+    }
+    double sum = 0.0;
+    for (double ms : frameMs) {
+        sum += ms;
+    }
+    std::cout << replay.traceBytes() / 1024 << " KiB trace, " << frameMs.size() << " frames, "
+              << replay.callsReplayed() << " calls in " << totalMs << " ms" << std::endl;
+    std::cout << "per frame: " << sum / static_cast<double>(frameMs.size()) << " ms average, "
+              << *std::min_element(frameMs.begin(), frameMs.end()) << " ms min, "
+              << *std::max_element(frameMs.begin(), frameMs.end()) << " ms max" << std::endl;
+    std::cout << static_cast<double>(replay.callsReplayed()) / totalMs * 1000.0 << " calls per second" << std::endl;
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,1283 @@
+#include "gl_trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+#include "gl_extensions.h"
+#include "profiler.h"
+
+// trace layout: the magic and version, then one record per call, a 16 bit call id followed by the
+// arguments as they are, pointers as 64 bit values, and the client memory a call reads as a 32 bit
+// size plus the bytes
+namespace {
+    const char TRACE_MAGIC[4]{'G', 'L', 'T', 'R'};
+    const std::uint32_t TRACE_VERSION{4};
+    // size of a payload that was a null pointer
+    const std::uint32_t NO_PAYLOAD{std::numeric_limits<std::uint32_t>::max()};
+    // the write buffer is flushed at frame ends, or earlier once it gets this big
+    const std::size_t FLUSH_BYTES{64 * 1024 * 1024};
+
+    // calls recorded with all arguments as they are
+#define PLAIN_GL_CALLS(X) \
+    X(ActiveTexture) X(BlendFunc) X(BlitFramebuffer) X(Clear) X(ClearColor) X(Disable) X(DrawArrays) \
+    X(DrawArraysInstanced) X(DrawBuffer) X(DrawElements) X(DrawElementsBaseVertex) X(DrawElementsInstanced) X(Enable) \
+    X(EnableVertexAttribArray) X(EndQuery) X(Finish) X(PolygonMode) X(PolygonOffset) X(ReadBuffer) \
+    X(RenderbufferStorage) X(Scissor) X(TexParameteri) X(VertexAttribDivisor) X(VertexAttribPointer) X(Viewport)
+
+    // calls with object names, uniform locations, return values or client memory, written by hand
+#define TRACED_GL_CALLS(X) \
+    X(AttachShader) X(BeginQuery) X(BindBuffer) X(BindBufferRange) X(BindFramebuffer) X(BindRenderbuffer) X(BindTexture) \
+    X(BindVertexArray) X(BufferData) X(BufferSubData) X(ClientWaitSync) X(CompileShader) X(CreateProgram) \
+    X(CreateShader) X(DeleteBuffers) X(DeleteFramebuffers) X(DeleteProgram) X(DeleteQueries) \
+    X(DeleteRenderbuffers) X(DeleteShader) X(DeleteSync) X(DeleteTextures) X(DeleteVertexArrays) X(DrawBuffers) \
+    X(FenceSync) X(FramebufferRenderbuffer) X(FramebufferTexture2D) X(FramebufferTextureLayer) X(GenBuffers) \
+    X(GenFramebuffers) X(GenQueries) X(GenRenderbuffers) X(GenTextures) X(GenVertexArrays) X(GetQueryObjectiv) \
+    X(GetQueryObjectui64v) X(GetUniformBlockIndex) X(GetUniformLocation) X(LinkProgram) X(PixelStorei) X(QueryCounter) X(ReadPixels) X(ShaderSource) \
+    X(TexBuffer) X(TexImage2D) X(TexImage3D) X(TexSubImage2D) X(TexSubImage3D) X(Uniform1f) X(Uniform1i) X(Uniform1iv) \
+    X(Uniform2f) X(Uniform2fv) X(Uniform3f) X(Uniform3fv) X(Uniform4fv) X(UniformBlockBinding) X(UniformMatrix4fv) \
+    X(UnmapBuffer) \
+    X(UseProgram)
+
+#define CALL_ID(name) name,
+    enum class Call : std::uint16_t {
+        PLAIN_GL_CALLS(CALL_ID)
+        TRACED_GL_CALLS(CALL_ID)
+        ViewportArrayv,
+        FrameEnd
+    };
+#undef CALL_ID
+
+    struct TraceWriter {
+        std::FILE *file{nullptr};
+        std::vector<unsigned char> buffer;
+        GLint unpackAlignment{4};
+
+        // mapped ranges are written by the caller, their bytes are recorded when they're unmapped
+        struct Mapping {
+            GLenum target;
+            GLintptr offset;
+            GLsizeiptr length;
+            GLbitfield access;
+            const void *pointer;
+        };
+        std::vector<Mapping> mappings;
+
+        template<typename T>
+        void put(T value) {
+            if constexpr (std::is_pointer_v<T>) {
+                put(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value)));
+            } else {
+                static_assert(std::is_trivially_copyable_v<T>);
+                const auto *bytes = reinterpret_cast<const unsigned char *>(&value);
+                buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+            }
+        }
+
+        void call(Call id) {
+            if (buffer.size() > FLUSH_BYTES) {
+                flush();
+            }
+            put(static_cast<std::uint16_t>(id));
+        }
+
+        void payload(const void *data, std::size_t size) {
+            if (!data) {
+                put(NO_PAYLOAD);
+                return;
+            }
+            put(static_cast<std::uint32_t>(size));
+            const auto *bytes = static_cast<const unsigned char *>(data);
+            buffer.insert(buffer.end(), bytes, bytes + size);
+        }
+
+        void flush() {
+            if (file && !buffer.empty()) {
+                std::fwrite(buffer.data(), 1, buffer.size(), file);
+            }
+            buffer.clear();
+        }
+    };
+
+    // GL is only called from the render thread, so the one writer needs no lock
+    TraceWriter writer;
+
+    // client memory glTexImage and glTexSubImage read, rows are padded to GL_UNPACK_ALIGNMENT
+    std::size_t imageBytes(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type) {
+        const std::uint64_t row = static_cast<std::uint64_t>(width) * pixelBytes(format, type);
+        const auto alignment = static_cast<std::uint64_t>(writer.unpackAlignment);
+        const std::uint64_t stride = (row + alignment - 1) / alignment * alignment;
+        const std::uint64_t rows = static_cast<std::uint64_t>(height) * static_cast<std::uint64_t>(depth);
+        return rows == 0 ? 0 : static_cast<std::size_t>(stride * (rows - 1) + row);
+    }
+
+    // recording wrapper of a plain call, the driver's function is kept in real
+    template<auto *Slot, Call Id, typename Pointer = std::remove_pointer_t<decltype(Slot)>>
+    struct PlainCall;
+
+    template<auto *Slot, Call Id, typename R, typename... Args>
+    struct PlainCall<Slot, Id, R (APIENTRYP)(Args...)> {
+        static inline R (APIENTRYP real)(Args...) = nullptr;
+
+        static R APIENTRY record(Args... args) {
+            writer.call(Id);
+            (writer.put(args), ...);
+            return real(args...);
+        }
+    };
+
+#define REAL_SLOT(name) decltype(glad_gl##name) real##name{nullptr};
+    TRACED_GL_CALLS(REAL_SLOT)
+    REAL_SLOT(MapBufferRange)
+    REAL_SLOT(ViewportArrayv)
+#undef REAL_SLOT
+
+    void APIENTRY tracedAttachShader(GLuint program, GLuint shader) {
+        writer.call(Call::AttachShader);
+        writer.put(program);
+        writer.put(shader);
+        realAttachShader(program, shader);
+    }
+
+    void APIENTRY tracedBeginQuery(GLenum target, GLuint id) {
+        writer.call(Call::BeginQuery);
+        writer.put(target);
+        writer.put(id);
+        realBeginQuery(target, id);
+    }
+
+    void APIENTRY tracedBindBuffer(GLenum target, GLuint buffer) {
+        writer.call(Call::BindBuffer);
+        writer.put(target);
+        writer.put(buffer);
+        realBindBuffer(target, buffer);
+    }
+
+    void APIENTRY tracedBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+        writer.call(Call::BindBufferRange);
+        writer.put(target);
+        writer.put(index);
+        writer.put(buffer);
+        writer.put(offset);
+        writer.put(size);
+        realBindBufferRange(target, index, buffer, offset, size);
+    }
+
+    void APIENTRY tracedBindFramebuffer(GLenum target, GLuint framebuffer) {
+        writer.call(Call::BindFramebuffer);
+        writer.put(target);
+        writer.put(framebuffer);
+        realBindFramebuffer(target, framebuffer);
+    }
+
+    void APIENTRY tracedBindRenderbuffer(GLenum target, GLuint renderbuffer) {
+        writer.call(Call::BindRenderbuffer);
+        writer.put(target);
+        writer.put(renderbuffer);
+        realBindRenderbuffer(target, renderbuffer);
+    }
+
+    void APIENTRY tracedBindTexture(GLenum target, GLuint texture) {
+        writer.call(Call::BindTexture);
+        writer.put(target);
+        writer.put(texture);
+        realBindTexture(target, texture);
+    }
+
+    void APIENTRY tracedBindVertexArray(GLuint array) {
+        writer.call(Call::BindVertexArray);
+        writer.put(array);
+        realBindVertexArray(array);
+    }
+
+    void APIENTRY tracedBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) {
+        writer.call(Call::BufferData);
+        writer.put(target);
+        writer.put(size);
+        writer.put(usage);
+        writer.payload(data, static_cast<std::size_t>(size));
+        realBufferData(target, size, data, usage);
+    }
+
+    void APIENTRY tracedBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) {
+        writer.call(Call::BufferSubData);
+        writer.put(target);
+        writer.put(offset);
+        writer.payload(data, static_cast<std::size_t>(size));
+        realBufferSubData(target, offset, size, data);
+    }
+
+    GLenum APIENTRY tracedClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
+        writer.call(Call::ClientWaitSync);
+        writer.put(sync);
+        writer.put(flags);
+        writer.put(timeout);
+        return realClientWaitSync(sync, flags, timeout);
+    }
+
+    void APIENTRY tracedCompileShader(GLuint shader) {
+        writer.call(Call::CompileShader);
+        writer.put(shader);
+        realCompileShader(shader);
+    }
+
+    GLuint APIENTRY tracedCreateProgram() {
+        const GLuint program = realCreateProgram();
+        writer.call(Call::CreateProgram);
+        writer.put(program);
+        return program;
+    }
+
+    GLuint APIENTRY tracedCreateShader(GLenum type) {
+        const GLuint shader = realCreateShader(type);
+        writer.call(Call::CreateShader);
+        writer.put(type);
+        writer.put(shader);
+        return shader;
+    }
+
+    // glGen* and glDelete* all record the count and the names
+    void putNames(Call id, GLsizei count, const GLuint *names) {
+        writer.call(id);
+        writer.payload(names, static_cast<std::size_t>(count) * sizeof(GLuint));
+    }
+
+    void APIENTRY tracedDeleteBuffers(GLsizei n, const GLuint *names) {
+        putNames(Call::DeleteBuffers, n, names);
+        realDeleteBuffers(n, names);
+    }
+
+    void APIENTRY tracedDeleteFramebuffers(GLsizei n, const GLuint *names) {
+        putNames(Call::DeleteFramebuffers, n, names);
+        realDeleteFramebuffers(n, names);
+    }
+
+    void APIENTRY tracedDeleteQueries(GLsizei n, const GLuint *names) {
+        putNames(Call::DeleteQueries, n, names);
+        realDeleteQueries(n, names);
+    }
+
+    void APIENTRY tracedDeleteRenderbuffers(GLsizei n, const GLuint *names) {
+        putNames(Call::DeleteRenderbuffers, n, names);
+        realDeleteRenderbuffers(n, names);
+    }
+
+    void APIENTRY tracedDeleteTextures(GLsizei n, const GLuint *names) {
+        putNames(Call::DeleteTextures, n, names);
+        realDeleteTextures(n, names);
+    }
+
+    void APIENTRY tracedDeleteVertexArrays(GLsizei n, const GLuint *names) {
+        putNames(Call::DeleteVertexArrays, n, names);
+        realDeleteVertexArrays(n, names);
+    }
+
+    void APIENTRY tracedGenBuffers(GLsizei n, GLuint *names) {
+        realGenBuffers(n, names);
+        putNames(Call::GenBuffers, n, names);
+    }
+
+    void APIENTRY tracedGenFramebuffers(GLsizei n, GLuint *names) {
+        realGenFramebuffers(n, names);
+        putNames(Call::GenFramebuffers, n, names);
+    }
+
+    void APIENTRY tracedGenQueries(GLsizei n, GLuint *names) {
+        realGenQueries(n, names);
+        putNames(Call::GenQueries, n, names);
+    }
+
+    void APIENTRY tracedGenRenderbuffers(GLsizei n, GLuint *names) {
+        realGenRenderbuffers(n, names);
+        putNames(Call::GenRenderbuffers, n, names);
+    }
+
+    void APIENTRY tracedGenTextures(GLsizei n, GLuint *names) {
+        realGenTextures(n, names);
+        putNames(Call::GenTextures, n, names);
+    }
+
+    void APIENTRY tracedGenVertexArrays(GLsizei n, GLuint *names) {
+        realGenVertexArrays(n, names);
+        putNames(Call::GenVertexArrays, n, names);
+    }
+
+    void APIENTRY tracedDeleteProgram(GLuint program) {
+        writer.call(Call::DeleteProgram);
+        writer.put(program);
+        realDeleteProgram(program);
+    }
+
+    void APIENTRY tracedDeleteShader(GLuint shader) {
+        writer.call(Call::DeleteShader);
+        writer.put(shader);
+        realDeleteShader(shader);
+    }
+
+    void APIENTRY tracedDeleteSync(GLsync sync) {
+        writer.call(Call::DeleteSync);
+        writer.put(sync);
+        realDeleteSync(sync);
+    }
+
+    void APIENTRY tracedDrawBuffers(GLsizei n, const GLenum *buffers) {
+        writer.call(Call::DrawBuffers);
+        writer.payload(buffers, static_cast<std::size_t>(n) * sizeof(GLenum));
+        realDrawBuffers(n, buffers);
+    }
+
+    GLsync APIENTRY tracedFenceSync(GLenum condition, GLbitfield flags) {
+        GLsync sync = realFenceSync(condition, flags);
+        writer.call(Call::FenceSync);
+        writer.put(condition);
+        writer.put(flags);
+        writer.put(sync);
+        return sync;
+    }
+
+    void APIENTRY tracedFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer) {
+        writer.call(Call::FramebufferRenderbuffer);
+        writer.put(target);
+        writer.put(attachment);
+        writer.put(renderbufferTarget);
+        writer.put(renderbuffer);
+        realFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+    }
+
+    void APIENTRY tracedFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level) {
+        writer.call(Call::FramebufferTexture2D);
+        writer.put(target);
+        writer.put(attachment);
+        writer.put(textureTarget);
+        writer.put(texture);
+        writer.put(level);
+        realFramebufferTexture2D(target, attachment, textureTarget, texture, level);
+    }
+
+    void APIENTRY tracedFramebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer) {
+        writer.call(Call::FramebufferTextureLayer);
+        writer.put(target);
+        writer.put(attachment);
+        writer.put(texture);
+        writer.put(level);
+        writer.put(layer);
+        realFramebufferTextureLayer(target, attachment, texture, level, layer);
+    }
+
+    // query results are recorded as reads only, the replay asks for them too so waits on the GPU
+    // cost the same
+    void APIENTRY tracedGetQueryObjectiv(GLuint id, GLenum name, GLint *value) {
+        writer.call(Call::GetQueryObjectiv);
+        writer.put(id);
+        writer.put(name);
+        realGetQueryObjectiv(id, name, value);
+    }
+
+    void APIENTRY tracedGetQueryObjectui64v(GLuint id, GLenum name, GLuint64 *value) {
+        writer.call(Call::GetQueryObjectui64v);
+        writer.put(id);
+        writer.put(name);
+        realGetQueryObjectui64v(id, name, value);
+    }
+
+    GLuint APIENTRY tracedGetUniformBlockIndex(GLuint program, const GLchar *name) {
+        const GLuint index = realGetUniformBlockIndex(program, name);
+        writer.call(Call::GetUniformBlockIndex);
+        writer.put(program);
+        writer.put(index);
+        writer.payload(name, std::strlen(name) + 1);
+        return index;
+    }
+
+    GLint APIENTRY tracedGetUniformLocation(GLuint program, const GLchar *name) {
+        const GLint location = realGetUniformLocation(program, name);
+        writer.call(Call::GetUniformLocation);
+        writer.put(program);
+        writer.put(location);
+        writer.payload(name, std::strlen(name) + 1);
+        return location;
+    }
+
+    void APIENTRY tracedLinkProgram(GLuint program) {
+        writer.call(Call::LinkProgram);
+        writer.put(program);
+        realLinkProgram(program);
+    }
+
+    void APIENTRY tracedPixelStorei(GLenum name, GLint value) {
+        if (name == GL_UNPACK_ALIGNMENT) {
+            writer.unpackAlignment = value;
+        }
+        writer.call(Call::PixelStorei);
+        writer.put(name);
+        writer.put(value);
+        realPixelStorei(name, value);
+    }
+
+    // pixels is an offset into the bound GL_PIXEL_PACK_BUFFER or client memory the driver writes,
+    // either way nothing to record but the value
+    void APIENTRY tracedReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *pixels) {
+        writer.call(Call::ReadPixels);
+        writer.put(x);
+        writer.put(y);
+        writer.put(width);
+        writer.put(height);
+        writer.put(format);
+        writer.put(type);
+        writer.put(pixels);
+        realReadPixels(x, y, width, height, format, type, pixels);
+    }
+
+    void APIENTRY tracedQueryCounter(GLuint id, GLenum target) {
+        writer.call(Call::QueryCounter);
+        writer.put(id);
+        writer.put(target);
+        realQueryCounter(id, target);
+    }
+
+    // the strings are joined into one, so the replay passes a single source
+    void APIENTRY tracedShaderSource(GLuint shader, GLsizei count, const GLchar *const *strings, const GLint *lengths) {
+        std::string source;
+        for (GLsizei i = 0; i < count; ++i) {
+            if (lengths && lengths[i] >= 0) {
+                source.append(strings[i], static_cast<std::size_t>(lengths[i]));
+            } else {
+                source.append(strings[i]);
+            }
+        }
+        writer.call(Call::ShaderSource);
+        writer.put(shader);
+        writer.payload(source.c_str(), source.size() + 1);
+        realShaderSource(shader, count, strings, lengths);
+    }
+
+    void APIENTRY tracedTexBuffer(GLenum target, GLenum internalFormat, GLuint buffer) {
+        writer.call(Call::TexBuffer);
+        writer.put(target);
+        writer.put(internalFormat);
+        writer.put(buffer);
+        realTexBuffer(target, internalFormat, buffer);
+    }
+
+    void APIENTRY tracedTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+                                   GLint border, GLenum format, GLenum type, const void *pixels) {
+        writer.call(Call::TexImage2D);
+        writer.put(target);
+        writer.put(level);
+        writer.put(internalFormat);
+        writer.put(width);
+        writer.put(height);
+        writer.put(border);
+        writer.put(format);
+        writer.put(type);
+        writer.payload(pixels, imageBytes(width, height, 1, format, type));
+        realTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+    }
+
+    void APIENTRY tracedTexImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+                                   GLsizei depth, GLint border, GLenum format, GLenum type, const void *pixels) {
+        writer.call(Call::TexImage3D);
+        writer.put(target);
+        writer.put(level);
+        writer.put(internalFormat);
+        writer.put(width);
+        writer.put(height);
+        writer.put(depth);
+        writer.put(border);
+        writer.put(format);
+        writer.put(type);
+        writer.payload(pixels, imageBytes(width, height, depth, format, type));
+        realTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, pixels);
+    }
+
+    void APIENTRY tracedTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                      GLenum format, GLenum type, const void *pixels) {
+        writer.call(Call::TexSubImage2D);
+        writer.put(target);
+        writer.put(level);
+        writer.put(x);
+        writer.put(y);
+        writer.put(width);
+        writer.put(height);
+        writer.put(format);
+        writer.put(type);
+        writer.payload(pixels, imageBytes(width, height, 1, format, type));
+        realTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+    }
+
+    void APIENTRY tracedTexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width,
+                                      GLsizei height, GLsizei depth, GLenum format, GLenum type, const void *pixels) {
+        writer.call(Call::TexSubImage3D);
+        writer.put(target);
+        writer.put(level);
+        writer.put(x);
+        writer.put(y);
+        writer.put(z);
+        writer.put(width);
+        writer.put(height);
+        writer.put(depth);
+        writer.put(format);
+        writer.put(type);
+        writer.payload(pixels, imageBytes(width, height, depth, format, type));
+        realTexSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels);
+    }
+
+    void APIENTRY tracedUniform1f(GLint location, GLfloat v0) {
+        writer.call(Call::Uniform1f);
+        writer.put(location);
+        writer.put(v0);
+        realUniform1f(location, v0);
+    }
+
+    void APIENTRY tracedUniform1i(GLint location, GLint v0) {
+        writer.call(Call::Uniform1i);
+        writer.put(location);
+        writer.put(v0);
+        realUniform1i(location, v0);
+    }
+
+    void APIENTRY tracedUniform1iv(GLint location, GLsizei count, const GLint *values) {
+        writer.call(Call::Uniform1iv);
+        writer.put(location);
+        writer.put(count);
+        writer.payload(values, static_cast<std::size_t>(count) * sizeof(GLint));
+        realUniform1iv(location, count, values);
+    }
+
+    void APIENTRY tracedUniform2f(GLint location, GLfloat v0, GLfloat v1) {
+        writer.call(Call::Uniform2f);
+        writer.put(location);
+        writer.put(v0);
+        writer.put(v1);
+        realUniform2f(location, v0, v1);
+    }
+
+    void APIENTRY tracedUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
+        writer.call(Call::Uniform3f);
+        writer.put(location);
+        writer.put(v0);
+        writer.put(v1);
+        writer.put(v2);
+        realUniform3f(location, v0, v1, v2);
+    }
+
+    // the vector uniforms share one layout: location, count and the floats
+    void putUniformArray(Call id, GLint location, GLsizei count, const GLfloat *values, std::size_t components) {
+        writer.call(id);
+        writer.put(location);
+        writer.put(count);
+        writer.payload(values, static_cast<std::size_t>(count) * components * sizeof(GLfloat));
+    }
+
+    void APIENTRY tracedUniform2fv(GLint location, GLsizei count, const GLfloat *values) {
+        putUniformArray(Call::Uniform2fv, location, count, values, 2);
+        realUniform2fv(location, count, values);
+    }
+
+    void APIENTRY tracedUniform3fv(GLint location, GLsizei count, const GLfloat *values) {
+        putUniformArray(Call::Uniform3fv, location, count, values, 3);
+        realUniform3fv(location, count, values);
+    }
+
+    void APIENTRY tracedUniform4fv(GLint location, GLsizei count, const GLfloat *values) {
+        putUniformArray(Call::Uniform4fv, location, count, values, 4);
+        realUniform4fv(location, count, values);
+    }
+
+    void APIENTRY tracedUniformBlockBinding(GLuint program, GLuint blockIndex, GLuint binding) {
+        writer.call(Call::UniformBlockBinding);
+        writer.put(program);
+        writer.put(blockIndex);
+        writer.put(binding);
+        realUniformBlockBinding(program, blockIndex, binding);
+    }
+
+    void APIENTRY tracedUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *values) {
+        writer.call(Call::UniformMatrix4fv);
+        writer.put(location);
+        writer.put(count);
+        writer.put(transpose);
+        writer.payload(values, static_cast<std::size_t>(count) * 16 * sizeof(GLfloat));
+        realUniformMatrix4fv(location, count, transpose, values);
+    }
+
+    void APIENTRY tracedUseProgram(GLuint program) {
+        writer.call(Call::UseProgram);
+        writer.put(program);
+        realUseProgram(program);
+    }
+
+    void APIENTRY tracedViewportArrayv(GLuint first, GLsizei count, const GLfloat *v) {
+        writer.call(Call::ViewportArrayv);
+        writer.put(first);
+        writer.put(count);
+        writer.payload(v, static_cast<std::size_t>(count) * 4 * sizeof(GLfloat));
+        realViewportArrayv(first, count, v);
+    }
+
+    void *APIENTRY tracedMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+        void *pointer = realMapBufferRange(target, offset, length, access);
+        if (pointer && (access & GL_MAP_WRITE_BIT)) {
+            writer.mappings.push_back(TraceWriter::Mapping{target, offset, length, access, pointer});
+        }
+        return pointer;
+    }
+
+    // recorded as map, write and unmap in one, with whatever the caller wrote into the range
+    GLboolean APIENTRY tracedUnmapBuffer(GLenum target) {
+        writer.call(Call::UnmapBuffer);
+        writer.put(target);
+        auto mapping = std::find_if(writer.mappings.begin(), writer.mappings.end(),
+                                    [target](const TraceWriter::Mapping &m) { return m.target == target; });
+        if (mapping != writer.mappings.end()) {
+            writer.put(mapping->offset);
+            writer.put(mapping->access);
+            writer.payload(mapping->pointer, static_cast<std::size_t>(mapping->length));
+            writer.mappings.erase(mapping);
+        } else {
+            // mapped for reading, or before the trace started
+            writer.put(GLintptr{0});
+            writer.put(GLbitfield{0});
+            writer.payload(nullptr, 0);
+        }
+        return realUnmapBuffer(target);
+    }
+}
+
+bool startGLTrace(const char *path) {
+    if (writer.file) {
+        std::cout << "ERROR::GL_TRACE::ALREADY_TRACING\n" << path << std::endl;
+        return false;
+    }
+    writer.file = std::fopen(path, "wb");
+    if (!writer.file) {
+        std::cout << "ERROR::GL_TRACE::FILE_NOT_WRITABLE\n" << path << std::endl;
+        return false;
+    }
+    std::fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), writer.file);
+    std::fwrite(&TRACE_VERSION, sizeof(TRACE_VERSION), 1, writer.file);
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &writer.unpackAlignment);
+
+    // on top of whatever is installed already, e.g. the profiler's counting wrappers
+#define INSTALL_PLAIN(name) \
+    PlainCall<&glad_gl##name, Call::name>::real = glad_gl##name; \
+    glad_gl##name = PlainCall<&glad_gl##name, Call::name>::record;
+#define INSTALL_TRACED(name) \
+    real##name = glad_gl##name; \
+    glad_gl##name = traced##name;
+    PLAIN_GL_CALLS(INSTALL_PLAIN)
+    TRACED_GL_CALLS(INSTALL_TRACED)
+    INSTALL_TRACED(MapBufferRange)
+    // an extension entry point, only there when the driver exports it
+    if (glad_glViewportArrayv) {
+        INSTALL_TRACED(ViewportArrayv)
+    }
+#undef INSTALL_PLAIN
+#undef INSTALL_TRACED
+    return true;
+}
+
+void markGLTraceFrame() {
+    if (!writer.file) {
+        return;
+    }
+    writer.call(Call::FrameEnd);
+    writer.flush();
+}
+
+void stopGLTrace() {
+    if (!writer.file) {
+        return;
+    }
+#define RESTORE_PLAIN(name) glad_gl##name = PlainCall<&glad_gl##name, Call::name>::real;
+#define RESTORE_TRACED(name) glad_gl##name = real##name;
+    PLAIN_GL_CALLS(RESTORE_PLAIN)
+    TRACED_GL_CALLS(RESTORE_TRACED)
+    RESTORE_TRACED(MapBufferRange)
+    if (realViewportArrayv) {
+        RESTORE_TRACED(ViewportArrayv)
+        realViewportArrayv = nullptr;
+    }
+#undef RESTORE_PLAIN
+#undef RESTORE_TRACED
+
+    writer.flush();
+    std::fclose(writer.file);
+    writer.file = nullptr;
+    writer.mappings.clear();
+}
+
+namespace {
+    // reads the records back in the order they were written, past the end everything is zero
+    struct TraceReader {
+        const std::vector<unsigned char> &data;
+        std::size_t &position;
+        bool &truncated;
+
+        template<typename T>
+        T read() {
+            if constexpr (std::is_pointer_v<T>) {
+                return reinterpret_cast<T>(static_cast<std::uintptr_t>(read<std::uint64_t>()));
+            } else {
+                T value{};
+                if (position + sizeof(T) > data.size()) {
+                    truncated = true;
+                    return value;
+                }
+                std::memcpy(&value, data.data() + position, sizeof(T));
+                position += sizeof(T);
+                return value;
+            }
+        }
+
+        // nullptr for a recorded null pointer
+        const void *payload(std::size_t &size) {
+            const auto recorded = read<std::uint32_t>();
+            size = 0;
+            if (recorded == NO_PAYLOAD) {
+                return nullptr;
+            }
+            if (position + recorded > data.size()) {
+                truncated = true;
+                return nullptr;
+            }
+            const unsigned char *bytes = data.data() + position;
+            position += recorded;
+            size = recorded;
+            return bytes;
+        }
+
+        const void *payload() {
+            std::size_t size;
+            return payload(size);
+        }
+    };
+
+    template<auto *Slot, typename R, typename... Args>
+    void replayPlain(TraceReader &reader, R (APIENTRYP)(Args...)) {
+        // braced initialisation reads the arguments in order
+        std::tuple<Args...> args{reader.read<Args>()...};
+        std::apply(*Slot, args);
+    }
+
+    std::uint64_t locationKey(GLuint program, GLint location) {
+        return static_cast<std::uint64_t>(program) << 32 | static_cast<std::uint32_t>(location);
+    }
+}
+
+bool GLTraceReplay::open(const char *path) {
+    std::FILE *file = std::fopen(path, "rb");
+    if (!file) {
+        std::cout << "ERROR::GL_TRACE::FILE_NOT_FOUND\n" << path << std::endl;
+        return false;
+    }
+    // all of it up front, so the replay never waits on the disk
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    m_data.resize(size > 0 ? static_cast<std::size_t>(size) : 0);
+    const std::size_t read = std::fread(m_data.data(), 1, m_data.size(), file);
+    std::fclose(file);
+
+    std::uint32_t version = 0;
+    if (read != m_data.size() || m_data.size() < sizeof(TRACE_MAGIC) + sizeof(version) ||
+        std::memcmp(m_data.data(), TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+        std::cout << "ERROR::GL_TRACE::NOT_A_TRACE\n" << path << std::endl;
+        return false;
+    }
+    std::memcpy(&version, m_data.data() + sizeof(TRACE_MAGIC), sizeof(version));
+    if (version != TRACE_VERSION) {
+        std::cout << "ERROR::GL_TRACE::VERSION_MISMATCH\n" << version << std::endl;
+        return false;
+    }
+    m_position = sizeof(TRACE_MAGIC) + sizeof(version);
+    m_truncated = false;
+    return true;
+}
+
+bool GLTraceReplay::replayFrame() {
+    TraceReader reader{m_data, m_position, m_truncated};
+    while (m_position < m_data.size()) {
+        const auto call = reader.read<std::uint16_t>();
+        if (call == static_cast<std::uint16_t>(Call::FrameEnd)) {
+            return true;
+        }
+        replayCall(call);
+        ++m_calls;
+        if (m_truncated) {
+            std::cout << "ERROR::GL_TRACE::TRUNCATED\n" << m_position << std::endl;
+            return false;
+        }
+    }
+    return false;
+}
+
+GLuint GLTraceReplay::lookup(const Names &names, GLuint traced) {
+    auto found = names.find(traced);
+    return found != names.end() ? found->second : traced;
+}
+
+GLint GLTraceReplay::location(GLint traced) const {
+    if (traced < 0) {
+        return traced;
+    }
+    auto found = m_locations.find(locationKey(m_currentProgram, traced));
+    return found != m_locations.end() ? found->second : traced;
+}
+
+void GLTraceReplay::generate(Names &names, void (APIENTRYP create)(GLsizei, GLuint *)) {
+    TraceReader reader{m_data, m_position, m_truncated};
+    std::size_t size;
+    const auto *traced = static_cast<const GLuint *>(reader.payload(size));
+    const std::size_t count = size / sizeof(GLuint);
+    std::vector<GLuint> created(count);
+    create(static_cast<GLsizei>(count), created.data());
+    for (std::size_t i = 0; i < count; ++i) {
+        names[traced[i]] = created[i];
+    }
+}
+
+void GLTraceReplay::remove(Names &names, void (APIENTRYP destroy)(GLsizei, const GLuint *)) {
+    TraceReader reader{m_data, m_position, m_truncated};
+    std::size_t size;
+    const auto *traced = static_cast<const GLuint *>(reader.payload(size));
+    const std::size_t count = size / sizeof(GLuint);
+    std::vector<GLuint> replayed(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        replayed[i] = lookup(names, traced[i]);
+        names.erase(traced[i]);
+    }
+    destroy(static_cast<GLsizei>(count), replayed.data());
+}
+
+void GLTraceReplay::replayCall(std::uint16_t call) {
+    // arguments go into locals first, the evaluation order of function arguments isn't fixed
+    TraceReader reader{m_data, m_position, m_truncated};
+    switch (static_cast<Call>(call)) {
+#define REPLAY_PLAIN(name) \
+        case Call::name: \
+            replayPlain<&glad_gl##name>(reader, glad_gl##name); \
+            break;
+        PLAIN_GL_CALLS(REPLAY_PLAIN)
+#undef REPLAY_PLAIN
+
+        case Call::AttachShader: {
+            const auto program = reader.read<GLuint>();
+            const auto shader = reader.read<GLuint>();
+            glAttachShader(lookup(m_programs, program), lookup(m_programs, shader));
+            break;
+        }
+        case Call::BeginQuery: {
+            const auto target = reader.read<GLenum>();
+            const auto id = reader.read<GLuint>();
+            glBeginQuery(target, lookup(m_queries, id));
+            break;
+        }
+        case Call::BindBuffer: {
+            const auto target = reader.read<GLenum>();
+            const auto buffer = reader.read<GLuint>();
+            glBindBuffer(target, lookup(m_buffers, buffer));
+            break;
+        }
+        case Call::BindBufferRange: {
+            const auto target = reader.read<GLenum>();
+            const auto index = reader.read<GLuint>();
+            const auto buffer = reader.read<GLuint>();
+            const auto offset = reader.read<GLintptr>();
+            const auto size = reader.read<GLsizeiptr>();
+            glBindBufferRange(target, index, lookup(m_buffers, buffer), offset, size);
+            break;
+        }
+        case Call::BindFramebuffer: {
+            const auto target = reader.read<GLenum>();
+            const auto framebuffer = reader.read<GLuint>();
+            glBindFramebuffer(target, lookup(m_framebuffers, framebuffer));
+            break;
+        }
+        case Call::BindRenderbuffer: {
+            const auto target = reader.read<GLenum>();
+            const auto renderbuffer = reader.read<GLuint>();
+            glBindRenderbuffer(target, lookup(m_renderbuffers, renderbuffer));
+            break;
+        }
+        case Call::BindTexture: {
+            const auto target = reader.read<GLenum>();
+            const auto texture = reader.read<GLuint>();
+            glBindTexture(target, lookup(m_textures, texture));
+            break;
+        }
+        case Call::BindVertexArray:
+            glBindVertexArray(lookup(m_vertexArrays, reader.read<GLuint>()));
+            break;
+        case Call::BufferData: {
+            const auto target = reader.read<GLenum>();
+            const auto size = reader.read<GLsizeiptr>();
+            const auto usage = reader.read<GLenum>();
+            glBufferData(target, size, reader.payload(), usage);
+            break;
+        }
+        case Call::BufferSubData: {
+            const auto target = reader.read<GLenum>();
+            const auto offset = reader.read<GLintptr>();
+            std::size_t size;
+            const void *data = reader.payload(size);
+            glBufferSubData(target, offset, static_cast<GLsizeiptr>(size), data);
+            break;
+        }
+        case Call::ClientWaitSync: {
+            const auto sync = reader.read<std::uint64_t>();
+            const auto flags = reader.read<GLbitfield>();
+            const auto timeout = reader.read<GLuint64>();
+            auto found = m_syncs.find(sync);
+            if (found != m_syncs.end()) {
+                glClientWaitSync(found->second, flags, timeout);
+            }
+            break;
+        }
+        case Call::CompileShader:
+            glCompileShader(lookup(m_programs, reader.read<GLuint>()));
+            break;
+        case Call::CreateProgram:
+            m_programs[reader.read<GLuint>()] = glCreateProgram();
+            break;
+        case Call::CreateShader: {
+            const auto type = reader.read<GLenum>();
+            m_programs[reader.read<GLuint>()] = glCreateShader(type);
+            break;
+        }
+        case Call::DeleteBuffers:
+            remove(m_buffers, glad_glDeleteBuffers);
+            break;
+        case Call::DeleteFramebuffers:
+            remove(m_framebuffers, glad_glDeleteFramebuffers);
+            break;
+        case Call::DeleteQueries:
+            remove(m_queries, glad_glDeleteQueries);
+            break;
+        case Call::DeleteRenderbuffers:
+            remove(m_renderbuffers, glad_glDeleteRenderbuffers);
+            break;
+        case Call::DeleteTextures:
+            remove(m_textures, glad_glDeleteTextures);
+            break;
+        case Call::DeleteVertexArrays:
+            remove(m_vertexArrays, glad_glDeleteVertexArrays);
+            break;
+        case Call::DeleteProgram: {
+            const auto program = reader.read<GLuint>();
+            glDeleteProgram(lookup(m_programs, program));
+            std::erase_if(m_locations, [program](const auto &entry) { return entry.first >> 32 == program; });
+            std::erase_if(m_blockIndices, [program](const auto &entry) { return entry.first >> 32 == program; });
+            m_programs.erase(program);
+            break;
+        }
+        case Call::DeleteShader: {
+            const auto shader = reader.read<GLuint>();
+            glDeleteShader(lookup(m_programs, shader));
+            m_programs.erase(shader);
+            break;
+        }
+        case Call::DeleteSync: {
+            auto found = m_syncs.find(reader.read<std::uint64_t>());
+            if (found != m_syncs.end()) {
+                glDeleteSync(found->second);
+                m_syncs.erase(found);
+            }
+            break;
+        }
+        case Call::DrawBuffers: {
+            std::size_t size;
+            const auto *buffers = static_cast<const GLenum *>(reader.payload(size));
+            glDrawBuffers(static_cast<GLsizei>(size / sizeof(GLenum)), buffers);
+            break;
+        }
+        case Call::FenceSync: {
+            const auto condition = reader.read<GLenum>();
+            const auto flags = reader.read<GLbitfield>();
+            m_syncs[reader.read<std::uint64_t>()] = glFenceSync(condition, flags);
+            break;
+        }
+        case Call::FramebufferRenderbuffer: {
+            const auto target = reader.read<GLenum>();
+            const auto attachment = reader.read<GLenum>();
+            const auto renderbufferTarget = reader.read<GLenum>();
+            const auto renderbuffer = reader.read<GLuint>();
+            glFramebufferRenderbuffer(target, attachment, renderbufferTarget, lookup(m_renderbuffers, renderbuffer));
+            break;
+        }
+        case Call::FramebufferTexture2D: {
+            const auto target = reader.read<GLenum>();
+            const auto attachment = reader.read<GLenum>();
+            const auto textureTarget = reader.read<GLenum>();
+            const auto texture = reader.read<GLuint>();
+            const auto level = reader.read<GLint>();
+            glFramebufferTexture2D(target, attachment, textureTarget, lookup(m_textures, texture), level);
+            break;
+        }
+        case Call::FramebufferTextureLayer: {
+            const auto target = reader.read<GLenum>();
+            const auto attachment = reader.read<GLenum>();
+            const auto texture = reader.read<GLuint>();
+            const auto level = reader.read<GLint>();
+            const auto layer = reader.read<GLint>();
+            glFramebufferTextureLayer(target, attachment, lookup(m_textures, texture), level, layer);
+            break;
+        }
+        case Call::GenBuffers:
+            generate(m_buffers, glad_glGenBuffers);
+            break;
+        case Call::GenFramebuffers:
+            generate(m_framebuffers, glad_glGenFramebuffers);
+            break;
+        case Call::GenQueries:
+            generate(m_queries, glad_glGenQueries);
+            break;
+        case Call::GenRenderbuffers:
+            generate(m_renderbuffers, glad_glGenRenderbuffers);
+            break;
+        case Call::GenTextures:
+            generate(m_textures, glad_glGenTextures);
+            break;
+        case Call::GenVertexArrays:
+            generate(m_vertexArrays, glad_glGenVertexArrays);
+            break;
+        case Call::GetQueryObjectiv: {
+            const auto id = reader.read<GLuint>();
+            const auto name = reader.read<GLenum>();
+            GLint value;
+            glGetQueryObjectiv(lookup(m_queries, id), name, &value);
+            break;
+        }
+        case Call::GetQueryObjectui64v: {
+            const auto id = reader.read<GLuint>();
+            const auto name = reader.read<GLenum>();
+            GLuint64 value;
+            glGetQueryObjectui64v(lookup(m_queries, id), name, &value);
+            break;
+        }
+        case Call::GetUniformBlockIndex: {
+            const auto program = reader.read<GLuint>();
+            const auto traced = reader.read<GLuint>();
+            const auto *name = static_cast<const GLchar *>(reader.payload());
+            if (name && traced != GL_INVALID_INDEX) {
+                m_blockIndices[locationKey(program, static_cast<GLint>(traced))] =
+                        glGetUniformBlockIndex(lookup(m_programs, program), name);
+            }
+            break;
+        }
+        case Call::GetUniformLocation: {
+            const auto program = reader.read<GLuint>();
+            const auto traced = reader.read<GLint>();
+            const auto *name = static_cast<const GLchar *>(reader.payload());
+            if (name && traced >= 0) {
+                m_locations[locationKey(program, traced)] = glGetUniformLocation(lookup(m_programs, program), name);
+            }
+            break;
+        }
+        case Call::LinkProgram:
+            glLinkProgram(lookup(m_programs, reader.read<GLuint>()));
+            break;
+        case Call::PixelStorei: {
+            const auto name = reader.read<GLenum>();
+            const auto value = reader.read<GLint>();
+            glPixelStorei(name, value);
+            break;
+        }
+        case Call::ReadPixels: {
+            const auto x = reader.read<GLint>();
+            const auto y = reader.read<GLint>();
+            const auto width = reader.read<GLsizei>();
+            const auto height = reader.read<GLsizei>();
+            const auto format = reader.read<GLenum>();
+            const auto type = reader.read<GLenum>();
+            const auto pixels = reader.read<std::uint64_t>();
+            // the bindings are replayed too, so a pack buffer bound now was bound when it was traced
+            GLint packBuffer = 0;
+            glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &packBuffer);
+            if (packBuffer != 0) {
+                glReadPixels(x, y, width, height, format, type, reinterpret_cast<void *>(static_cast<std::uintptr_t>(pixels)));
+            } else if (width > 0 && height > 0) {
+                // the caller's memory is gone, rows padded for the largest GL_PACK_ALIGNMENT
+                const std::size_t row = static_cast<std::size_t>(width) * pixelBytes(format, type);
+                m_pixels.resize((row + 7) / 8 * 8 * static_cast<std::size_t>(height));
+                glReadPixels(x, y, width, height, format, type, m_pixels.data());
+            }
+            break;
+        }
+        case Call::QueryCounter: {
+            const auto id = reader.read<GLuint>();
+            const auto target = reader.read<GLenum>();
+            glQueryCounter(lookup(m_queries, id), target);
+            break;
+        }
+        case Call::ShaderSource: {
+            const auto shader = reader.read<GLuint>();
+            const auto *source = static_cast<const GLchar *>(reader.payload());
+            glShaderSource(lookup(m_programs, shader), 1, &source, nullptr);
+            break;
+        }
+        case Call::TexBuffer: {
+            const auto target = reader.read<GLenum>();
+            const auto internalFormat = reader.read<GLenum>();
+            const auto buffer = reader.read<GLuint>();
+            glTexBuffer(target, internalFormat, lookup(m_buffers, buffer));
+            break;
+        }
+        case Call::TexImage2D: {
+            const auto target = reader.read<GLenum>();
+            const auto level = reader.read<GLint>();
+            const auto internalFormat = reader.read<GLint>();
+            const auto width = reader.read<GLsizei>();
+            const auto height = reader.read<GLsizei>();
+            const auto border = reader.read<GLint>();
+            const auto format = reader.read<GLenum>();
+            const auto type = reader.read<GLenum>();
+            glTexImage2D(target, level, internalFormat, width, height, border, format, type, reader.payload());
+            break;
+        }
+        case Call::TexImage3D: {
+            const auto target = reader.read<GLenum>();
+            const auto level = reader.read<GLint>();
+            const auto internalFormat = reader.read<GLint>();
+            const auto width = reader.read<GLsizei>();
+            const auto height = reader.read<GLsizei>();
+            const auto depth = reader.read<GLsizei>();
+            const auto border = reader.read<GLint>();
+            const auto format = reader.read<GLenum>();
+            const auto type = reader.read<GLenum>();
+            glTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, reader.payload());
+            break;
+        }
+        case Call::TexSubImage2D: {
+            const auto target = reader.read<GLenum>();
+            const auto level = reader.read<GLint>();
+            const auto x = reader.read<GLint>();
+            const auto y = reader.read<GLint>();
+            const auto width = reader.read<GLsizei>();
+            const auto height = reader.read<GLsizei>();
+            const auto format = reader.read<GLenum>();
+            const auto type = reader.read<GLenum>();
+            glTexSubImage2D(target, level, x, y, width, height, format, type, reader.payload());
+            break;
+        }
+        case Call::TexSubImage3D: {
+            const auto target = reader.read<GLenum>();
+            const auto level = reader.read<GLint>();
+            const auto x = reader.read<GLint>();
+            const auto y = reader.read<GLint>();
+            const auto z = reader.read<GLint>();
+            const auto width = reader.read<GLsizei>();
+            const auto height = reader.read<GLsizei>();
+            const auto depth = reader.read<GLsizei>();
+            const auto format = reader.read<GLenum>();
+            const auto type = reader.read<GLenum>();
+            glTexSubImage3D(target, level, x, y, z, width, height, depth, format, type, reader.payload());
+            break;
+        }
+        case Call::Uniform1f: {
+            const auto traced = reader.read<GLint>();
+            glUniform1f(location(traced), reader.read<GLfloat>());
+            break;
+        }
+        case Call::Uniform1i: {
+            const auto traced = reader.read<GLint>();
+            glUniform1i(location(traced), reader.read<GLint>());
+            break;
+        }
+        case Call::Uniform1iv: {
+            const auto traced = reader.read<GLint>();
+            const auto count = reader.read<GLsizei>();
+            glUniform1iv(location(traced), count, static_cast<const GLint *>(reader.payload()));
+            break;
+        }
+        case Call::Uniform2f: {
+            const auto traced = reader.read<GLint>();
+            const auto v0 = reader.read<GLfloat>();
+            const auto v1 = reader.read<GLfloat>();
+            glUniform2f(location(traced), v0, v1);
+            break;
+        }
+        case Call::Uniform3f: {
+            const auto traced = reader.read<GLint>();
+            const auto v0 = reader.read<GLfloat>();
+            const auto v1 = reader.read<GLfloat>();
+            const auto v2 = reader.read<GLfloat>();
+            glUniform3f(location(traced), v0, v1, v2);
+            break;
+        }
+        case Call::Uniform2fv:
+        case Call::Uniform3fv:
+        case Call::Uniform4fv: {
+            const auto traced = reader.read<GLint>();
+            const auto count = reader.read<GLsizei>();
+            const auto *values = static_cast<const GLfloat *>(reader.payload());
+            if (static_cast<Call>(call) == Call::Uniform2fv) {
+                glUniform2fv(location(traced), count, values);
+            } else if (static_cast<Call>(call) == Call::Uniform3fv) {
+                glUniform3fv(location(traced), count, values);
+            } else {
+                glUniform4fv(location(traced), count, values);
+            }
+            break;
+        }
+        case Call::UniformBlockBinding: {
+            const auto program = reader.read<GLuint>();
+            const auto traced = reader.read<GLuint>();
+            const auto binding = reader.read<GLuint>();
+            const auto found = m_blockIndices.find(locationKey(program, static_cast<GLint>(traced)));
+            glUniformBlockBinding(lookup(m_programs, program), found != m_blockIndices.end() ? found->second : traced, binding);
+            break;
+        }
+        case Call::UniformMatrix4fv: {
+            const auto traced = reader.read<GLint>();
+            const auto count = reader.read<GLsizei>();
+            const auto transpose = reader.read<GLboolean>();
+            glUniformMatrix4fv(location(traced), count, transpose, static_cast<const GLfloat *>(reader.payload()));
+            break;
+        }
+        case Call::UnmapBuffer: {
+            const auto target = reader.read<GLenum>();
+            const auto offset = reader.read<GLintptr>();
+            const auto access = reader.read<GLbitfield>();
+            std::size_t size;
+            const void *data = reader.payload(size);
+            if (data && size > 0) {
+                void *mapped = glMapBufferRange(target, offset, static_cast<GLsizeiptr>(size), access);
+                if (mapped) {
+                    std::memcpy(mapped, data, size);
+                }
+                glUnmapBuffer(target);
+            }
+            break;
+        }
+        case Call::UseProgram: {
+            m_currentProgram = reader.read<GLuint>();
+            glUseProgram(lookup(m_programs, m_currentProgram));
+            break;
+        }
+        case Call::ViewportArrayv: {
+            const auto first = reader.read<GLuint>();
+            const auto count = reader.read<GLsizei>();
+            const auto *viewports = static_cast<const GLfloat *>(reader.payload());
+            // a trace from a driver with viewport arrays played back on one without
+            if (glViewportArrayv) {
+                glViewportArrayv(first, count, viewports);
+            } else if (viewports && count > 0) {
+                glViewport(static_cast<GLint>(viewports[0]), static_cast<GLint>(viewports[1]),
+                           static_cast<GLsizei>(viewports[2]), static_cast<GLsizei>(viewports[3]));
+            }
+            break;
+        }
+        case Call::FrameEnd:
+            break;
+        default:
+            std::cout << "ERROR::GL_TRACE::UNKNOWN_CALL\n" << call << std::endl;
+            m_truncated = true;
+            break;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef GL_TRACE_H
+#define GL_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/glad/glad.h"
+
+// GL call tracing: swaps glad's function pointers for wrappers that write every call, with its
+// arguments and the client memory it reads (buffer data, pixels, shader sources, uniform arrays),
+// into a binary trace, GLTraceReplay plays it back on another context
+// - start tracing right after the context is created, the trace has no snapshot of objects that
+//   existed before, and only from the render thread
+// - covers the GL entry points this renderer calls, anything else still reaches the driver but
+//   isn't recorded; pure queries like glGetShaderiv aren't recorded on purpose
+// - readbacks are recorded as glReadPixels only: a buffer mapped for reading isn't recorded, its
+//   unmap is written without data and replays as nothing, so the replay has the copies into the
+//   pack buffers but not the CPU's reads of them
+// - written to the file once per frame, so the tracing cost stays off the frame's GL calls
+bool startGLTrace(const char *path);
+// marks the end of a frame, call before swapping buffers
+void markGLTraceFrame();
+void stopGLTrace();
+
+// re-issues a trace on the current context as fast as the driver takes it, object names and
+// uniform locations are remapped to whatever the driver hands out this time
+class GLTraceReplay {
+public:
+    bool open(const char *path);
+    // issues the calls of the next frame, false once the trace is used up
+    bool replayFrame();
+
+    std::size_t callsReplayed() const { return m_calls; }
+    std::size_t traceBytes() const { return m_data.size(); }
+
+private:
+    using Names = std::unordered_map<GLuint, GLuint>;
+
+    void replayCall(std::uint16_t call);
+
+    static GLuint lookup(const Names &names, GLuint traced);
+    // glGen* and glDelete*, with the names read from the trace
+    void generate(Names &names, void (APIENTRYP create)(GLsizei, GLuint *));
+    void remove(Names &names, void (APIENTRYP destroy)(GLsizei, const GLuint *));
+    GLint location(GLint traced) const;
+
+    std::vector<unsigned char> m_data;
+    std::size_t m_position{0};
+    // set when a call runs past the end of the data
+    bool m_truncated{false};
+    std::size_t m_calls{0};
+
+    Names m_buffers;
+    Names m_textures;
+    Names m_framebuffers;
+    Names m_renderbuffers;
+    Names m_vertexArrays;
+    Names m_queries;
+    // shaders and programs share one name space
+    Names m_programs;
+    std::unordered_map<std::uint64_t, GLsync> m_syncs;
+    // (traced program, traced location) -> location
+    std::unordered_map<std::uint64_t, GLint> m_locations;
+    // (traced program, traced block index) -> block index
+    std::unordered_map<std::uint64_t, GLuint> m_blockIndices;
+    GLuint m_currentProgram{0};
+    // what glReadPixels into client memory writes to
+    std::vector<unsigned char> m_pixels;
+};
+
+#endif
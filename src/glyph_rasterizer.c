@@ -0,0 +1,103 @@
+#include "glyph_rasterizer.h"
+
+#include <stdlib.h>
+
+#define NK_IMPLEMENTATION
+#define NK_INCLUDE_DEFAULT_ALLOCATOR
+#define NK_INCLUDE_FONT_BAKING
+#define NK_INCLUDE_DEFAULT_FONT
+#include "../glfw/deps/nuklear.h"
+
+struct GlyphFont {
+    unsigned char *ttf;
+    struct nk_tt_fontinfo info;
+};
+
+static void *glyphAlloc(nk_handle unused, void *old, nk_size size) {
+    (void) unused;
+    (void) old;
+    return malloc(size);
+}
+
+static void glyphFree(nk_handle unused, void *memory) {
+    (void) unused;
+    free(memory);
+}
+
+GlyphFont *glyphFontCreateDefault(void) {
+    // base85 -> compressed -> ttf, same steps as nk_font_atlas_add_compressed_base85
+    const char *base85 = nk_proggy_clean_ttf_compressed_data_base85;
+    size_t compressedSize = (((int) nk_strlen(base85) + 4) / 5) * 4;
+    unsigned char *compressed = (unsigned char *) malloc(compressedSize);
+    if (!compressed) {
+        return NULL;
+    }
+    nk_decode_85(compressed, (const unsigned char *) base85);
+
+    unsigned int ttfSize = nk_decompress_length(compressed);
+    GlyphFont *font = (GlyphFont *) calloc(1, sizeof(GlyphFont));
+    unsigned char *ttf = (unsigned char *) malloc(ttfSize);
+    if (!font || !ttf) {
+        free(compressed);
+        free(font);
+        free(ttf);
+        return NULL;
+    }
+    nk_decompress(ttf, compressed, (unsigned int) compressedSize);
+    free(compressed);
+
+    font->ttf = ttf;
+    if (!nk_tt_InitFont(&font->info, font->ttf, 0)) {
+        glyphFontDestroy(font);
+        return NULL;
+    }
+    return font;
+}
+
+void glyphFontDestroy(GlyphFont *font) {
+    if (font) {
+        free(font->ttf);
+        free(font);
+    }
+}
+
+void glyphFontVerticalMetrics(const GlyphFont *font, float pixelHeight, float *ascent, float *descent, float *lineGap) {
+    int a, d, g;
+    float scale = nk_tt_ScaleForPixelHeight(&font->info, pixelHeight);
+    nk_tt_GetFontVMetrics(&font->info, &a, &d, &g);
+    *ascent = (float) a * scale;
+    *descent = (float) d * scale;
+    *lineGap = (float) g * scale;
+}
+
+int glyphFontHasGlyph(const GlyphFont *font, int codepoint) {
+    return nk_tt_FindGlyphIndex(&font->info, codepoint) != 0;
+}
+
+void glyphMetrics(const GlyphFont *font, int codepoint, float pixelHeight, GlyphMetrics *metrics) {
+    int glyph = nk_tt_FindGlyphIndex(&font->info, codepoint);
+    float scale = nk_tt_ScaleForPixelHeight(&font->info, pixelHeight);
+    int advance, bearing, x0, y0, x1, y1;
+    nk_tt_GetGlyphHMetrics(&font->info, glyph, &advance, &bearing);
+    nk_tt_GetGlyphBitmapBox(&font->info, glyph, scale, scale, &x0, &y0, &x1, &y1);
+    metrics->width = x1 - x0;
+    metrics->height = y1 - y0;
+    metrics->offsetX = x0;
+    metrics->offsetY = y0;
+    metrics->advance = (float) advance * scale;
+}
+
+void glyphRasterize(const GlyphFont *font, int codepoint, float pixelHeight, unsigned char *output, int stride) {
+    // every call gets its own allocator, the rasterizer keeps no other state
+    struct nk_allocator alloc;
+    alloc.userdata.ptr = NULL;
+    alloc.alloc = glyphAlloc;
+    alloc.free = glyphFree;
+
+    GlyphMetrics metrics;
+    glyphMetrics(font, codepoint, pixelHeight, &metrics);
+    int glyph = nk_tt_FindGlyphIndex(&font->info, codepoint);
+    float scale = nk_tt_ScaleForPixelHeight(&font->info, pixelHeight);
+    nk_tt_MakeGlyphBitmapSubpixel(&font->info, output, metrics.width, metrics.height, stride,
+                                  scale, scale, 0.0f, 0.0f, glyph, &alloc);
+}
@@ -0,0 +1,43 @@
+#ifndef GLYPH_RASTERIZER_H
+#define GLYPH_RASTERIZER_H
+
+// thin C wrapper around the TrueType rasterizer that ships inside glfw/deps/nuklear.h,
+// so we get real glyph outlines without pulling in another font library
+// a loaded font is read only, so glyphs can be rasterized from several threads at once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct GlyphFont GlyphFont;
+
+typedef struct GlyphMetrics {
+    // size of the glyph's bitmap and where its top left sits relative to the pen on the baseline
+    int width;
+    int height;
+    int offsetX;
+    int offsetY;
+    float advance;
+} GlyphMetrics;
+
+// the ProggyClean font built into nuklear, NULL on failure
+GlyphFont *glyphFontCreateDefault(void);
+void glyphFontDestroy(GlyphFont *font);
+
+// ascent / descent / line gap in pixels for the given pixel height
+void glyphFontVerticalMetrics(const GlyphFont *font, float pixelHeight, float *ascent, float *descent, float *lineGap);
+
+// 0 if the font has no glyph for the codepoint
+int glyphFontHasGlyph(const GlyphFont *font, int codepoint);
+
+// cheap, doesn't rasterize anything
+void glyphMetrics(const GlyphFont *font, int codepoint, float pixelHeight, GlyphMetrics *metrics);
+
+// writes 8 bit coverage of metrics.width x metrics.height pixels into output
+void glyphRasterize(const GlyphFont *font, int codepoint, float pixelHeight, unsigned char *output, int stride);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
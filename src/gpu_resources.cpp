@@ -0,0 +1,287 @@
+#include "gpu_resources.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "gl_extensions.h"
+
+namespace {
+    // not in the GL 3.3 core glad was generated for
+    const GLenum GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX{0x9048};
+    const GLenum GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX{0x9049};
+    const GLenum TEXTURE_FREE_MEMORY_ATI{0x87FC};
+
+    const char *typeName(GpuResourceType type) {
+        switch (type) {
+            case GpuResourceType::Buffer:
+                return "buffer";
+            case GpuResourceType::Texture:
+                return "texture";
+            case GpuResourceType::Renderbuffer:
+                return "renderbuffer";
+            case GpuResourceType::Program:
+                return "program";
+            case GpuResourceType::VertexArray:
+                return "vertex array";
+        }
+        return "object";
+    }
+}
+
+GpuMemoryInfo queryGpuMemory() {
+    static const bool nvx = hasGLExtension("GL_NVX_gpu_memory_info");
+    static const bool ati = hasGLExtension("GL_ATI_meminfo");
+    GpuMemoryInfo info;
+    if (nvx) {
+        glGetIntegerv(GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &info.totalKiB);
+        glGetIntegerv(GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &info.availableKiB);
+    } else if (ati) {
+        // total free, largest free block, total auxiliary free, largest auxiliary free block
+        GLint texture[4]{};
+        glGetIntegerv(TEXTURE_FREE_MEMORY_ATI, texture);
+        info.availableKiB = texture[0];
+    }
+    return info;
+}
+
+GLsizeiptr storageBytes(GLenum internalFormat, GLsizei width, GLsizei height, GLsizei depth) {
+    GLsizeiptr texel;
+    switch (internalFormat) {
+        case GL_R8:
+            texel = 1;
+            break;
+        case GL_RG8:
+            texel = 2;
+            break;
+        case GL_RGBA16F:
+        case GL_RGBA16:
+        case GL_RG32F:
+            texel = 8;
+            break;
+        case GL_RGBA32F:
+            texel = 16;
+            break;
+        default:
+            // GL_RGBA8, GL_RG16, GL_DEPTH_COMPONENT24 and 32F, GL_DEPTH24_STENCIL8 and the rest
+            texel = 4;
+            break;
+    }
+    return texel * width * height * depth;
+}
+
+GpuHandle GpuResources::createBuffer(const char *label) {
+    GLuint name = 0;
+    glGenBuffers(1, &name);
+    return add(GpuResourceType::Buffer, name, label);
+}
+
+GpuHandle GpuResources::createTexture(const char *label) {
+    GLuint name = 0;
+    glGenTextures(1, &name);
+    return add(GpuResourceType::Texture, name, label);
+}
+
+GpuHandle GpuResources::createRenderbuffer(const char *label) {
+    GLuint name = 0;
+    glGenRenderbuffers(1, &name);
+    return add(GpuResourceType::Renderbuffer, name, label);
+}
+
+GpuHandle GpuResources::createVertexArray(const char *label) {
+    GLuint name = 0;
+    glGenVertexArrays(1, &name);
+    return add(GpuResourceType::VertexArray, name, label);
+}
+
+GpuHandle GpuResources::adopt(GpuResourceType type, GLuint name, const char *label) {
+    return name != 0 ? add(type, name, label) : NO_HANDLE;
+}
+
+GpuHandle GpuResources::add(GpuResourceType type, GLuint name, const char *label) {
+    std::uint32_t index = m_freeHead;
+    if (index != INDEX_MASK) {
+        m_freeHead = m_slots[index].nextFree;
+    } else if (m_slots.size() < INDEX_MASK) {
+        index = static_cast<std::uint32_t>(m_slots.size());
+        m_slots.emplace_back();
+    } else {
+        std::cout << "ERROR::GPU_RESOURCES::OUT_OF_SLOTS\n" << label << std::endl;
+        deleteObject(Retired{type, name});
+        return NO_HANDLE;
+    }
+
+    // generations count 1 to MAX_GENERATION and wrap, so no handle is ever 0
+    Slot &slot = m_slots[index];
+    slot.generation = slot.lastGeneration % MAX_GENERATION + 1;
+    slot.lastGeneration = slot.generation;
+    slot.name = name;
+    slot.type = type;
+    slot.label = label;
+    slot.bytes = 0;
+    slot.lastUsedFrame = m_frame;
+    slot.evictable = false;
+    ++m_liveCount;
+    return slot.generation << INDEX_BITS | index;
+}
+
+void GpuResources::bufferData(GpuHandle buffer, GLenum target, GLsizeiptr size, const void *data, GLenum usage) {
+    const GLuint name = get(buffer, GpuResourceType::Buffer);
+    if (name == 0) {
+        return;
+    }
+    glBindBuffer(target, name);
+    glBufferData(target, size, data, usage);
+    setBytes(buffer, size);
+}
+
+void GpuResources::setBytes(GpuHandle handle, GLsizeiptr bytes) {
+    const std::uint32_t index = handle & INDEX_MASK;
+    if (handle == NO_HANDLE || index >= m_slots.size() || m_slots[index].generation != handle >> INDEX_BITS) {
+        return;
+    }
+    Slot &slot = m_slots[index];
+    m_bytes[static_cast<std::size_t>(slot.type)] += bytes - slot.bytes;
+    slot.bytes = bytes;
+}
+
+GLsizeiptr GpuResources::totalBytes() const {
+    GLsizeiptr total = 0;
+    for (GLsizeiptr bytes : m_bytes) {
+        total += bytes;
+    }
+    return total;
+}
+
+void GpuResources::setEvictable(GpuHandle handle, bool evictable) {
+    const std::uint32_t index = handle & INDEX_MASK;
+    if (handle != NO_HANDLE && index < m_slots.size() && m_slots[index].generation == handle >> INDEX_BITS) {
+        m_slots[index].evictable = evictable;
+    }
+}
+
+void GpuResources::release(GpuHandle &handle) {
+    const std::uint32_t index = handle & INDEX_MASK;
+    if (handle != NO_HANDLE && index < m_slots.size() && m_slots[index].generation == handle >> INDEX_BITS) {
+        releaseSlot(index);
+    }
+    handle = NO_HANDLE;
+}
+
+void GpuResources::releaseSlot(std::uint32_t index) {
+    Slot &slot = m_slots[index];
+    m_released.push_back(Retired{slot.type, slot.name});
+    m_bytes[static_cast<std::size_t>(slot.type)] -= slot.bytes;
+    slot.bytes = 0;
+    slot.evictable = false;
+    slot.generation = 0;
+    slot.name = 0;
+    slot.label = nullptr;
+    slot.nextFree = m_freeHead;
+    m_freeHead = index;
+    --m_liveCount;
+}
+
+void GpuResources::evict() {
+    m_evicted = 0;
+    GLsizeiptr total = totalBytes();
+    if (m_budget <= 0 || total <= m_budget) {
+        return;
+    }
+    // objects used this frame are still needed by its draws
+    m_candidates.clear();
+    for (std::uint32_t i = 0; i < m_slots.size(); ++i) {
+        const Slot &slot = m_slots[i];
+        if (slot.generation != 0 && slot.evictable && slot.bytes > 0 && slot.lastUsedFrame < m_frame) {
+            m_candidates.push_back(i);
+        }
+    }
+    std::sort(m_candidates.begin(), m_candidates.end(), [this](std::uint32_t a, std::uint32_t b) {
+        return m_slots[a].lastUsedFrame < m_slots[b].lastUsedFrame;
+    });
+    for (std::uint32_t index : m_candidates) {
+        if (total <= m_budget) {
+            break;
+        }
+        total -= m_slots[index].bytes;
+        releaseSlot(index);
+        ++m_evicted;
+    }
+}
+
+void GpuResources::endFrame() {
+    evict();
+    ++m_frame;
+    if (!m_released.empty()) {
+        m_retiredFrames.push_back(RetiredFrame{glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), std::move(m_released)});
+        m_released.clear();
+    }
+    // fences signal in order, the first one that hasn't keeps all later ones too
+    while (!m_retiredFrames.empty()) {
+        RetiredFrame &frame = m_retiredFrames.front();
+        const GLenum result = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        for (const Retired &object : frame.objects) {
+            deleteObject(object);
+        }
+        glDeleteSync(frame.fence);
+        m_retiredFrames.pop_front();
+    }
+}
+
+void GpuResources::destroy() {
+    // GL keeps objects that are still in use alive until the GPU is done with them, at shutdown
+    // there's no frame left to wait for
+    for (RetiredFrame &frame : m_retiredFrames) {
+        for (const Retired &object : frame.objects) {
+            deleteObject(object);
+        }
+        glDeleteSync(frame.fence);
+    }
+    m_retiredFrames.clear();
+    for (const Retired &object : m_released) {
+        deleteObject(object);
+    }
+    m_released.clear();
+
+    for (const Slot &slot : m_slots) {
+        if (slot.generation != 0) {
+            std::cout << "ERROR::GPU_RESOURCES::LEAKED\n" << typeName(slot.type) << " " << slot.name << " \""
+                      << slot.label << "\" of " << slot.bytes << " bytes was never released" << std::endl;
+            deleteObject(Retired{slot.type, slot.name});
+        }
+    }
+    m_slots.clear();
+    m_freeHead = INDEX_MASK;
+    m_liveCount = 0;
+    std::fill(std::begin(m_bytes), std::end(m_bytes), 0);
+}
+
+std::size_t GpuResources::pendingDeletes() const {
+    std::size_t count = m_released.size();
+    for (const RetiredFrame &frame : m_retiredFrames) {
+        count += frame.objects.size();
+    }
+    return count;
+}
+
+void GpuResources::deleteObject(const Retired &object) {
+    switch (object.type) {
+        case GpuResourceType::Buffer:
+            glDeleteBuffers(1, &object.name);
+            break;
+        case GpuResourceType::Texture:
+            glDeleteTextures(1, &object.name);
+            break;
+        case GpuResourceType::Renderbuffer:
+            glDeleteRenderbuffers(1, &object.name);
+            break;
+        case GpuResourceType::Program:
+            glDeleteProgram(object.name);
+            break;
+        case GpuResourceType::VertexArray:
+            glDeleteVertexArrays(1, &object.name);
+            break;
+    }
+}
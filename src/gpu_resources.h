@@ -0,0 +1,164 @@
+#ifndef GPU_RESOURCES_H
+#define GPU_RESOURCES_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "../include/glad/glad.h"
+
+enum class GpuResourceType : std::uint8_t {
+    Buffer,
+    Texture,
+    Renderbuffer,
+    Program,
+    VertexArray
+};
+
+// what the driver says about video memory, in KiB, -1 where it says nothing; from
+// GL_NVX_gpu_memory_info or GL_ATI_meminfo, which only report the free part
+struct GpuMemoryInfo {
+    GLint totalKiB{-1};
+    GLint availableKiB{-1};
+};
+GpuMemoryInfo queryGpuMemory();
+
+// bytes of width x height x depth texels of a sized internal format as drivers lay them out,
+// without mipmaps; 24 bit depth is padded to 32 bits
+GLsizeiptr storageBytes(GLenum internalFormat, GLsizei width, GLsizei height, GLsizei depth = 1);
+
+// 32 bits: slot index in the low 20, the slot's generation in the high 12; 0 is never handed out
+using GpuHandle = std::uint32_t;
+
+// owner of GL objects that are referred to by handle instead of by name
+// - slots live in one array and are reused through a free list, a handle is checked by comparing
+//   its generation with the slot's, so a handle to a released object reads as 0 instead of as
+//   whatever object got the name or the slot after it
+// - release() only retires the handle, the object is deleted by a later endFrame() once a fence
+//   placed after the frame that released it has passed, endFrame() never waits for one
+// - destroy() reports every object that was never released, one line each with its label
+// - the bytes of every object's storage are counted per type, set by bufferData() or setBytes(),
+//   which gives the footprint of this instance no matter what the driver reports
+// - with a budget, endFrame() evicts evictable objects, oldest touch() first, until the count is
+//   under it again; evicting is a release(), the owner notices by its handle reading as 0 and
+//   loads the data again. Objects touched this frame are never evicted, a mesh is only safe from
+//   being evicted in parts if all its handles are touched together
+// GL names only mean something in the context that made them, so every context that isn't shared
+// needs its own registry
+class GpuResources {
+public:
+    static constexpr GpuHandle NO_HANDLE{0};
+
+    // labels name the object in the leak report, they aren't copied, so pass string literals
+    GpuHandle createBuffer(const char *label);
+    GpuHandle createTexture(const char *label);
+    GpuHandle createRenderbuffer(const char *label);
+    GpuHandle createVertexArray(const char *label);
+    // takes over an object made elsewhere, e.g. a program from compileProgram() or the buffers of
+    // a recorded mesh; 0 gives NO_HANDLE
+    GpuHandle adopt(GpuResourceType type, GLuint name, const char *label);
+    GpuHandle adoptProgram(GLuint program, const char *label) { return adopt(GpuResourceType::Program, program, label); }
+
+    // the GL name, 0 for released, stale or foreign handles and handles of another type
+    GLuint get(GpuHandle handle, GpuResourceType type) const {
+        const std::uint32_t index = handle & INDEX_MASK;
+        if (index >= m_slots.size()) {
+            return 0;
+        }
+        const Slot &slot = m_slots[index];
+        return slot.generation == handle >> INDEX_BITS && slot.type == type ? slot.name : 0;
+    }
+    GLuint buffer(GpuHandle handle) const { return get(handle, GpuResourceType::Buffer); }
+    GLuint texture(GpuHandle handle) const { return get(handle, GpuResourceType::Texture); }
+    GLuint renderbuffer(GpuHandle handle) const { return get(handle, GpuResourceType::Renderbuffer); }
+    GLuint program(GpuHandle handle) const { return get(handle, GpuResourceType::Program); }
+    GLuint vertexArray(GpuHandle handle) const { return get(handle, GpuResourceType::VertexArray); }
+
+    // binds the buffer to target and gives it size bytes of storage, which are counted for it
+    void bufferData(GpuHandle buffer, GLenum target, GLsizeiptr size, const void *data, GLenum usage);
+    // bytes of storage made some other way, e.g. every level of a texture or a renderbuffer
+    void setBytes(GpuHandle handle, GLsizeiptr bytes);
+    GLsizeiptr bytes(GpuResourceType type) const { return m_bytes[static_cast<std::size_t>(type)]; }
+    GLsizeiptr totalBytes() const;
+
+    // evictable objects are the budget's to release, streamed data that can be loaded again
+    void setEvictable(GpuHandle handle, bool evictable);
+    // marks the object as used this frame
+    void touch(GpuHandle handle) {
+        const std::uint32_t index = handle & INDEX_MASK;
+        if (index < m_slots.size() && m_slots[index].generation == handle >> INDEX_BITS) {
+            m_slots[index].lastUsedFrame = m_frame;
+        }
+    }
+    // bytes endFrame() evicts down to, 0 for no budget
+    void setBudget(GLsizeiptr bytes) { m_budget = bytes; }
+    GLsizeiptr budget() const { return m_budget; }
+    // objects evicted by the last endFrame()
+    std::size_t evicted() const { return m_evicted; }
+
+    // retires the handle now and deletes the object once the GPU is done with this frame, handle
+    // becomes NO_HANDLE; stale handles are ignored
+    void release(GpuHandle &handle);
+
+    // evicts down to the budget, fences the objects released this frame and deletes the ones whose
+    // frame finished, once per frame after its draws were issued
+    void endFrame();
+    // deletes everything, objects still alive are reported as leaks first; before glfwTerminate()
+    void destroy();
+
+    std::size_t liveCount() const { return m_liveCount; }
+    // released but not deleted yet
+    std::size_t pendingDeletes() const;
+
+private:
+    static constexpr unsigned INDEX_BITS{20};
+    static constexpr std::uint32_t INDEX_MASK{(1u << INDEX_BITS) - 1};
+    static constexpr std::uint32_t MAX_GENERATION{(1u << (32 - INDEX_BITS)) - 1};
+    static constexpr std::size_t TYPE_COUNT{5};
+
+    struct Slot {
+        GLuint name{0};
+        // 0 while the slot is free
+        std::uint32_t generation{0};
+        // last generation the slot had, the next one continues from it
+        std::uint32_t lastGeneration{0};
+        GpuResourceType type{GpuResourceType::Buffer};
+        const char *label{nullptr};
+        std::uint32_t nextFree{0};
+        GLsizeiptr bytes{0};
+        std::uint64_t lastUsedFrame{0};
+        bool evictable{false};
+    };
+
+    struct Retired {
+        GpuResourceType type;
+        GLuint name;
+    };
+
+    // objects released in one frame and the fence after it
+    struct RetiredFrame {
+        GLsync fence;
+        std::vector<Retired> objects;
+    };
+
+    GpuHandle add(GpuResourceType type, GLuint name, const char *label);
+    void releaseSlot(std::uint32_t index);
+    void evict();
+    static void deleteObject(const Retired &object);
+
+    std::vector<Slot> m_slots;
+    // head of the free list, INDEX_MASK when it's empty
+    std::uint32_t m_freeHead{INDEX_MASK};
+    std::size_t m_liveCount{0};
+    GLsizeiptr m_bytes[TYPE_COUNT]{};
+    GLsizeiptr m_budget{0};
+    std::uint64_t m_frame{1};
+    std::size_t m_evicted{0};
+    // evictable slot indices, sorted by last use when over budget
+    std::vector<std::uint32_t> m_candidates;
+
+    std::vector<Retired> m_released;
+    std::deque<RetiredFrame> m_retiredFrames;
+};
+
+#endif
@@ -0,0 +1,278 @@
+#include "immediate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    std::uint8_t toByte(float value) {
+        return static_cast<std::uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+std::size_t ImmediateRecorder::VertexHash::operator()(const Vertex &vertex) const {
+    // FNV-1a over the bytes, the vertices are compared byte by byte too
+    const auto *bytes = reinterpret_cast<const unsigned char *>(&vertex);
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < sizeof(Vertex); ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+bool ImmediateRecorder::VertexEqual::operator()(const Vertex &a, const Vertex &b) const {
+    return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+}
+
+void ImmediateRecorder::newList() {
+    m_recording = true;
+    m_inPrimitive = false;
+    m_vertices.clear();
+    std::fill(m_vertexSlots.begin(), m_vertexSlots.end(), EMPTY_SLOT);
+    m_indices.clear();
+    m_recordedVertices = 0;
+    m_albedo[0] = m_albedo[1] = m_albedo[2] = 1.0f;
+    mat4x4_identity(m_transform);
+}
+
+bool ImmediateRecorder::endList(Mesh &mesh) {
+    if (!m_recording || m_inPrimitive) {
+        std::cout << "ERROR::IMMEDIATE::END_LIST_WITHOUT_LIST_OR_INSIDE_BEGIN" << std::endl;
+        return false;
+    }
+    m_recording = false;
+    if (m_indices.empty()) {
+        return false;
+    }
+
+    // positions, then normals, then colours, each tightly packed
+    const auto count = static_cast<GLsizeiptr>(m_vertices.size());
+    const GLsizeiptr positionBytes = count * 3 * static_cast<GLsizeiptr>(sizeof(float));
+    const GLsizeiptr colorBytes = count * 4;
+    std::vector<float> attributes(static_cast<std::size_t>(count) * 6);
+    std::vector<std::uint8_t> colors(static_cast<std::size_t>(colorBytes));
+    std::copy(m_vertices[0].position, m_vertices[0].position + 3, mesh.boundsMin);
+    std::copy(m_vertices[0].position, m_vertices[0].position + 3, mesh.boundsMax);
+    for (std::size_t i = 0; i < m_vertices.size(); ++i) {
+        const Vertex &vertex = m_vertices[i];
+        for (std::size_t k = 0; k < 3; ++k) {
+            attributes[i * 3 + k] = vertex.position[k];
+            attributes[m_vertices.size() * 3 + i * 3 + k] = vertex.normal[k];
+            mesh.boundsMin[k] = std::min(mesh.boundsMin[k], vertex.position[k]);
+            mesh.boundsMax[k] = std::max(mesh.boundsMax[k], vertex.position[k]);
+        }
+        std::copy(vertex.color, vertex.color + 4, colors.begin() + static_cast<std::ptrdiff_t>(i * 4));
+    }
+
+    if (m_resources != nullptr) {
+        mesh.handles[0] = m_resources->createVertexArray("immediate list vertex array");
+        mesh.handles[1] = m_resources->createBuffer("immediate list vertex buffer");
+        mesh.handles[2] = m_resources->createBuffer("immediate list index buffer");
+        mesh.vao = m_resources->vertexArray(mesh.handles[0]);
+        mesh.vertexBuffer = m_resources->buffer(mesh.handles[1]);
+        mesh.indexBuffer = m_resources->buffer(mesh.handles[2]);
+    } else {
+        glGenVertexArrays(1, &mesh.vao);
+        glGenBuffers(1, &mesh.vertexBuffer);
+        glGenBuffers(1, &mesh.indexBuffer);
+    }
+    glBindVertexArray(mesh.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, 2 * positionBytes + colorBytes, nullptr, GL_STATIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, 2 * positionBytes, attributes.data());
+    glBufferSubData(GL_ARRAY_BUFFER, 2 * positionBytes, colorBytes, colors.data());
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *) nullptr);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *) positionBytes);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, 4, (void *) (2 * positionBytes));
+    for (GLuint i = 0; i < 3; ++i) {
+        glEnableVertexAttribArray(i);
+    }
+    const auto indexBytes = static_cast<GLsizeiptr>(m_indices.size() * sizeof(std::uint32_t));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, m_indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (m_resources != nullptr) {
+        m_resources->setBytes(mesh.handles[1], 2 * positionBytes + colorBytes);
+        m_resources->setBytes(mesh.handles[2], indexBytes);
+        for (GpuHandle handle : mesh.handles) {
+            m_resources->setEvictable(handle, m_evictable);
+        }
+    }
+
+    mesh.indexCount = static_cast<GLsizei>(m_indices.size());
+    mesh.vertexNormals = true;
+    std::copy(m_albedo, m_albedo + 3, mesh.albedo);
+    return true;
+}
+
+void ImmediateRecorder::setResources(GpuResources *resources, bool evictable) {
+    m_resources = resources;
+    m_evictable = evictable;
+}
+
+void ImmediateRecorder::deleteList(Mesh &mesh) {
+    glDeleteVertexArrays(1, &mesh.vao);
+    glDeleteBuffers(1, &mesh.vertexBuffer);
+    glDeleteBuffers(1, &mesh.indexBuffer);
+    mesh.vao = mesh.vertexBuffer = mesh.indexBuffer = 0;
+    mesh.indexCount = 0;
+}
+
+void ImmediateRecorder::begin(ImmediatePrimitive primitive) {
+    if (!m_recording || m_inPrimitive) {
+        std::cout << "ERROR::IMMEDIATE::BEGIN_OUTSIDE_LIST_OR_NESTED" << std::endl;
+        return;
+    }
+    m_inPrimitive = true;
+    m_primitive = primitive;
+    m_primitiveVertices.clear();
+}
+
+void ImmediateRecorder::end() {
+    if (!m_inPrimitive) {
+        std::cout << "ERROR::IMMEDIATE::END_WITHOUT_BEGIN" << std::endl;
+        return;
+    }
+    m_inPrimitive = false;
+
+    // triangles that lost an edge to identical vertices, e.g. where a strip repeats a vertex, are dropped;
+    // flat ones take the normal and colour of the provoking vertex GL would use for the primitive
+    const std::vector<Vertex> &v = m_primitiveVertices;
+    const auto addTriangle = [this, &v](std::size_t a, std::size_t b, std::size_t c, std::size_t provoking) {
+        Vertex corners[3]{v[a], v[b], v[c]};
+        if (m_flat) {
+            for (Vertex &corner : corners) {
+                std::copy(v[provoking].normal, v[provoking].normal + 3, corner.normal);
+                std::copy(v[provoking].color, v[provoking].color + 4, corner.color);
+            }
+        }
+        const VertexEqual equal;
+        if (equal(corners[0], corners[1]) || equal(corners[1], corners[2]) || equal(corners[0], corners[2])) {
+            return;
+        }
+        for (const Vertex &corner : corners) {
+            m_indices.push_back(addVertex(corner));
+        }
+    };
+    const std::size_t count = v.size();
+    switch (m_primitive) {
+        case ImmediatePrimitive::Triangles:
+            for (std::size_t i = 0; i + 2 < count; i += 3) {
+                addTriangle(i, i + 1, i + 2, i + 2);
+            }
+            break;
+        case ImmediatePrimitive::TriangleStrip:
+            // every other triangle is flipped to keep the winding of the first
+            for (std::size_t i = 2; i < count; ++i) {
+                if (i % 2 == 0) {
+                    addTriangle(i - 2, i - 1, i, i);
+                } else {
+                    addTriangle(i - 1, i - 2, i, i);
+                }
+            }
+            break;
+        case ImmediatePrimitive::TriangleFan:
+            for (std::size_t i = 2; i < count; ++i) {
+                addTriangle(0, i - 1, i, i);
+            }
+            break;
+        case ImmediatePrimitive::Polygon:
+            // GL_POLYGON is convex, a fan around the first vertex covers it
+            for (std::size_t i = 2; i < count; ++i) {
+                addTriangle(0, i - 1, i, 0);
+            }
+            break;
+        case ImmediatePrimitive::Quads:
+            for (std::size_t i = 0; i + 3 < count; i += 4) {
+                addTriangle(i, i + 1, i + 2, i + 3);
+                addTriangle(i, i + 2, i + 3, i + 3);
+            }
+            break;
+        case ImmediatePrimitive::QuadStrip:
+            // quad k is 2k, 2k + 1, 2k + 3, 2k + 2
+            for (std::size_t i = 0; i + 3 < count; i += 2) {
+                addTriangle(i, i + 1, i + 3, i + 3);
+                addTriangle(i, i + 3, i + 2, i + 3);
+            }
+            break;
+    }
+}
+
+std::uint32_t ImmediateRecorder::addVertex(const Vertex &vertex) {
+    if ((m_vertices.size() + 1) * 2 > m_vertexSlots.size()) {
+        growVertexSlots();
+    }
+    const std::size_t mask = m_vertexSlots.size() - 1;
+    for (std::size_t slot = VertexHash{}(vertex) & mask;; slot = (slot + 1) & mask) {
+        const std::uint32_t index = m_vertexSlots[slot];
+        if (index == EMPTY_SLOT) {
+            m_vertexSlots[slot] = static_cast<std::uint32_t>(m_vertices.size());
+            m_vertices.push_back(vertex);
+            return m_vertexSlots[slot];
+        }
+        if (VertexEqual{}(m_vertices[index], vertex)) {
+            return index;
+        }
+    }
+}
+
+void ImmediateRecorder::growVertexSlots() {
+    m_vertexSlots.assign(std::max<std::size_t>(m_vertexSlots.size() * 2, 1024), EMPTY_SLOT);
+    const std::size_t mask = m_vertexSlots.size() - 1;
+    for (std::uint32_t index = 0; index < m_vertices.size(); ++index) {
+        std::size_t slot = VertexHash{}(m_vertices[index]) & mask;
+        while (m_vertexSlots[slot] != EMPTY_SLOT) {
+            slot = (slot + 1) & mask;
+        }
+        m_vertexSlots[slot] = index;
+    }
+}
+
+void ImmediateRecorder::vertex3f(float x, float y, float z) {
+    if (!m_inPrimitive) {
+        std::cout << "ERROR::IMMEDIATE::VERTEX_OUTSIDE_BEGIN" << std::endl;
+        return;
+    }
+    ++m_recordedVertices;
+
+    Vertex vertex{};
+    vec4 position{x, y, z, 1.0f}, transformed;
+    mat4x4_mul_vec4(transformed, m_transform, position);
+    vec4 normal{m_normal[0], m_normal[1], m_normal[2], 0.0f}, transformedNormal;
+    mat4x4_mul_vec4(transformedNormal, m_transform, normal);
+    const float length = std::sqrt(vec3_mul_inner(transformedNormal, transformedNormal));
+    for (int k = 0; k < 3; ++k) {
+        vertex.position[k] = transformed[k];
+        vertex.normal[k] = length > 0.0f ? transformedNormal[k] / length : 0.0f;
+    }
+    std::copy(m_color, m_color + 4, vertex.color);
+    m_primitiveVertices.push_back(vertex);
+}
+
+void ImmediateRecorder::shadeModel(bool flat) {
+    m_flat = flat;
+}
+
+void ImmediateRecorder::normal3f(float x, float y, float z) {
+    m_normal[0] = x;
+    m_normal[1] = y;
+    m_normal[2] = z;
+}
+
+void ImmediateRecorder::color3f(float r, float g, float b) {
+    m_color[0] = toByte(r);
+    m_color[1] = toByte(g);
+    m_color[2] = toByte(b);
+}
+
+void ImmediateRecorder::material(float r, float g, float b) {
+    m_albedo[0] = r;
+    m_albedo[1] = g;
+    m_albedo[2] = b;
+}
+
+void ImmediateRecorder::setTransform(const mat4x4 transform) {
+    std::memcpy(m_transform, transform, sizeof(mat4x4));
+}
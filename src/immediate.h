@@ -0,0 +1,112 @@
+#ifndef IMMEDIATE_H
+#define IMMEDIATE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../include/glad/glad.h"
+#include "../glfw/deps/linmath.h"
+
+#include "gpu_resources.h"
+#include "scene.h"
+
+// the glBegin modes that make faces, core GL only has the first three
+enum class ImmediatePrimitive {
+    Triangles,
+    TriangleStrip,
+    TriangleFan,
+    Quads,
+    QuadStrip,
+    Polygon
+};
+
+// glNewList / glBegin / glEnd / glEndList for core profile, to port legacy content like the gears
+// of glfw/examples/gears.c without rewriting it
+// - vertices take the current normal, colour and transform like glVertex does and go into the
+//   recorder's arrays, which keep their capacity from list to list, recording only allocates while
+//   the lists grow
+// - identical vertices are stored once, found through an open addressing table of indices that's
+//   cleared in place, strips, fans and quads become indexed triangles
+// - with shadeModel(true) every triangle takes the normal and colour of its provoking vertex like
+//   GL_FLAT, its corners then only merge with those of triangles that got the same ones
+// - endList() uploads the list once into a Mesh, replaying it is one glDrawElements, the same as
+//   calling a display list but without the driver unrolling it every time
+// the meshes' buffers hold all positions first, then the normals, then the colours, so positions
+// stay tightly packed at attribute 0 for every renderer of the scene; normals are at 1, colours
+// at 2 as normalised bytes
+class ImmediateRecorder {
+public:
+    // starts with the identity transform and a white material, normal and colour carry over
+    void newList();
+    // uploads the list, false if it's empty or a glBegin is still open
+    // the mesh owns the VAO and buffers, free them with deleteList(), unless they went to a registry
+    bool endList(Mesh &mesh);
+    static void deleteList(Mesh &mesh);
+    // lists uploaded from now on belong to resources, the mesh gets their handles; evictable ones
+    // may be released by the budget while unused, the owner records them again once a handle reads 0
+    void setResources(GpuResources *resources, bool evictable);
+
+    // glShadeModel, GL_FLAT when set; carries over from list to list like the GL state
+    void shadeModel(bool flat);
+
+    void begin(ImmediatePrimitive primitive);
+    void end();
+
+    void vertex3f(float x, float y, float z);
+    void normal3f(float x, float y, float z);
+    void color3f(float r, float g, float b);
+    // glMaterial's diffuse colour, becomes the albedo of the whole list
+    void material(float r, float g, float b);
+    // applied to the vertices and normals recorded after it, like glLoadMatrix inside a list;
+    // normals only come out right for rotations and uniform scales
+    void setTransform(const mat4x4 transform);
+
+    // vertices passed to vertex3f() and the ones kept after merging duplicates, by the last list;
+    // flat shading can keep more than were passed
+    std::size_t recordedVertices() const { return m_recordedVertices; }
+    std::size_t uniqueVertices() const { return m_vertices.size(); }
+
+private:
+    struct Vertex {
+        float position[3];
+        float normal[3];
+        std::uint8_t color[4];
+    };
+    static_assert(sizeof(Vertex) == 28, "Vertex is hashed and compared byte by byte");
+
+    struct VertexHash {
+        std::size_t operator()(const Vertex &vertex) const;
+    };
+    struct VertexEqual {
+        bool operator()(const Vertex &a, const Vertex &b) const;
+    };
+
+    // index of the vertex in m_vertices, added if there's no identical one yet
+    std::uint32_t addVertex(const Vertex &vertex);
+    // doubles the slot table and reinserts m_vertices
+    void growVertexSlots();
+
+    static constexpr std::uint32_t EMPTY_SLOT{0xffffffffu};
+
+    GpuResources *m_resources{nullptr};
+    bool m_evictable{false};
+
+    bool m_recording{false};
+    bool m_inPrimitive{false};
+    bool m_flat{false};
+    ImmediatePrimitive m_primitive{ImmediatePrimitive::Triangles};
+    float m_normal[3]{0.0f, 0.0f, 1.0f};
+    std::uint8_t m_color[4]{255, 255, 255, 255};
+    float m_albedo[3]{1.0f, 1.0f, 1.0f};
+    mat4x4 m_transform;
+
+    std::vector<Vertex> m_vertices;
+    // indices into m_vertices by hash with linear probing, a power of two at most half full
+    std::vector<std::uint32_t> m_vertexSlots;
+    // the open primitive's vertices, triangulated into m_indices by end()
+    std::vector<Vertex> m_primitiveVertices;
+    std::vector<std::uint32_t> m_indices;
+    std::size_t m_recordedVertices{0};
+};
+
+#endif
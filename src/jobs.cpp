@@ -0,0 +1,90 @@
+#include "jobs.h"
+
+JobSystem::JobSystem(unsigned workerCount) {
+    m_workers.reserve(workerCount);
+    for (unsigned i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (std::thread &worker : m_workers) {
+        worker.join();
+    }
+}
+
+unsigned JobSystem::defaultWorkerCount() {
+    // leave one core for the render thread
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 0;
+}
+
+void JobSystem::submit(std::function<void()> job, JobCounter *counter) {
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(Job{std::move(job), counter});
+    }
+    m_wake.notify_one();
+}
+
+void JobSystem::wait(JobCounter &counter) {
+    while (counter.pending.load(std::memory_order_acquire) > 0) {
+        // help out instead of sleeping, the job we wait for may still be queued
+        if (!runOne()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::parallelFor(std::size_t count, const std::function<void(std::size_t)> &job) {
+    JobCounter counter;
+    for (std::size_t i = 0; i < count; ++i) {
+        submit([&job, i] { job(i); }, &counter);
+    }
+    wait(counter);
+}
+
+void JobSystem::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_quit || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return; // quitting and nothing left to do
+            }
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        run(job);
+    }
+}
+
+bool JobSystem::runOne() {
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_queue.empty()) {
+            return false;
+        }
+        job = std::move(m_queue.front());
+        m_queue.pop_front();
+    }
+    run(job);
+    return true;
+}
+
+void JobSystem::run(Job &job) {
+    job.function();
+    if (job.counter) {
+        job.counter->pending.fetch_sub(1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// counts the unfinished jobs of one batch, wait() on it to block until they are all done
+struct JobCounter {
+    std::atomic<int> pending{0};
+};
+
+// small pool of worker threads pulling jobs from one shared queue
+// jobs must not touch GL, only the thread owning the context may do that
+class JobSystem {
+public:
+    // 0 workers is allowed, jobs then run on the thread that waits for them
+    explicit JobSystem(unsigned workerCount = defaultWorkerCount());
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    void submit(std::function<void()> job, JobCounter *counter = nullptr);
+    // runs queued jobs on the calling thread until the counter reaches zero
+    void wait(JobCounter &counter);
+    // calls job(i) for every i in [0, count) across the workers and returns once all calls finished
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)> &job);
+
+    unsigned workerCount() const { return static_cast<unsigned>(m_workers.size()); }
+
+    static unsigned defaultWorkerCount();
+
+private:
+    struct Job {
+        std::function<void()> function;
+        JobCounter *counter{nullptr};
+    };
+
+    void workerLoop();
+    bool runOne();
+    static void run(Job &job);
+
+    std::vector<std::thread> m_workers;
+    std::deque<Job> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_quit{false};
+};
+
+#endif
@@ -0,0 +1,144 @@
+#include "lz4.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    // a match needs at least this many bytes
+    const std::size_t MIN_MATCH{4};
+    // the format requires the last 5 bytes to be literals and the last match to start 12 bytes
+    // before the end at the latest
+    const std::size_t LAST_LITERALS{5};
+    const std::size_t MATCH_LIMIT{12};
+    const std::size_t MAX_OFFSET{65535};
+    const int HASH_BITS{16};
+
+    std::uint32_t read32(const unsigned char *at) {
+        std::uint32_t value;
+        std::memcpy(&value, at, sizeof(value));
+        return value;
+    }
+
+    // lengths of 15 and more spill into extra bytes of 255 each plus the remainder
+    void putLength(std::vector<unsigned char> &out, std::size_t length) {
+        for (; length >= 255; length -= 255) {
+            out.push_back(255);
+        }
+        out.push_back(static_cast<unsigned char>(length));
+    }
+
+    void putSequence(std::vector<unsigned char> &out, const unsigned char *literals, std::size_t literalLength,
+                     std::size_t offset, std::size_t matchLength) {
+        const std::size_t matchCode = matchLength - MIN_MATCH;
+        const auto literalToken = static_cast<unsigned char>(literalLength < 15 ? literalLength : 15);
+        const auto matchToken = static_cast<unsigned char>(matchCode < 15 ? matchCode : 15);
+        out.push_back(static_cast<unsigned char>(literalToken << 4 | matchToken));
+        if (literalLength >= 15) {
+            putLength(out, literalLength - 15);
+        }
+        out.insert(out.end(), literals, literals + literalLength);
+        out.push_back(static_cast<unsigned char>(offset & 0xff));
+        out.push_back(static_cast<unsigned char>(offset >> 8));
+        if (matchCode >= 15) {
+            putLength(out, matchCode - 15);
+        }
+    }
+
+    void putLastLiterals(std::vector<unsigned char> &out, const unsigned char *literals, std::size_t literalLength) {
+        out.push_back(static_cast<unsigned char>((literalLength < 15 ? literalLength : 15) << 4));
+        if (literalLength >= 15) {
+            putLength(out, literalLength - 15);
+        }
+        out.insert(out.end(), literals, literals + literalLength);
+    }
+
+    // reads the extra bytes of a length that was 15 in the token
+    bool readLength(const unsigned char *source, std::size_t sourceSize, std::size_t &in, std::size_t &length) {
+        unsigned char extra;
+        do {
+            if (in >= sourceSize) {
+                return false;
+            }
+            extra = source[in++];
+            length += extra;
+        } while (extra == 255);
+        return true;
+    }
+}
+
+void lz4Compress(const unsigned char *source, std::size_t size, std::vector<unsigned char> &out) {
+    out.clear();
+    out.reserve(size + size / 255 + 16);
+    std::size_t anchor = 0;
+    if (size > MATCH_LIMIT) {
+        // last position seen for a hash of 4 bytes, plus one so 0 means none
+        std::vector<std::uint32_t> table(std::size_t{1} << HASH_BITS, 0);
+        const std::size_t limit = size - MATCH_LIMIT;
+        for (std::size_t i = 0; i < limit;) {
+            const std::uint32_t sequence = read32(source + i);
+            const std::uint32_t hash = sequence * 2654435761u >> (32 - HASH_BITS);
+            const std::size_t candidate = table[hash];
+            table[hash] = static_cast<std::uint32_t>(i + 1);
+            if (candidate == 0 || i - (candidate - 1) > MAX_OFFSET || read32(source + candidate - 1) != sequence) {
+                ++i;
+                continue;
+            }
+
+            const std::size_t match = candidate - 1;
+            std::size_t length = MIN_MATCH;
+            while (i + length < size - LAST_LITERALS && source[match + length] == source[i + length]) {
+                ++length;
+            }
+            putSequence(out, source + anchor, i - anchor, i - match, length);
+            i += length;
+            anchor = i;
+        }
+    }
+    putLastLiterals(out, source + anchor, size - anchor);
+}
+
+bool lz4Decompress(const unsigned char *source, std::size_t sourceSize, unsigned char *destination, std::size_t destinationSize) {
+    std::size_t in = 0;
+    std::size_t out = 0;
+    while (in < sourceSize) {
+        const unsigned char token = source[in++];
+
+        std::size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(source, sourceSize, in, literalLength)) {
+            return false;
+        }
+        if (literalLength > sourceSize - in || literalLength > destinationSize - out) {
+            return false;
+        }
+        std::memcpy(destination + out, source + in, literalLength);
+        in += literalLength;
+        out += literalLength;
+        // the last sequence has no match
+        if (in == sourceSize) {
+            break;
+        }
+
+        if (sourceSize - in < 2) {
+            return false;
+        }
+        const std::size_t offset = source[in] | static_cast<std::size_t>(source[in + 1]) << 8;
+        in += 2;
+        if (offset == 0 || offset > out) {
+            return false;
+        }
+        std::size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(source, sourceSize, in, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > destinationSize - out) {
+            return false;
+        }
+        // byte by byte, the match may overlap what it's copying into
+        for (std::size_t i = 0; i < matchLength; ++i) {
+            destination[out + i] = destination[out - offset + i];
+        }
+        out += matchLength;
+    }
+    return out == destinationSize;
+}
@@ -0,0 +1,17 @@
+#ifndef LZ4_H
+#define LZ4_H
+
+#include <cstddef>
+#include <vector>
+
+// LZ4 block format, compatible with the reference implementation's LZ4_decompress_safe
+// the compressor is the simple greedy one, fast rather than tight, good enough for packing assets
+
+// compresses size bytes into out, replacing what was in it
+void lz4Compress(const unsigned char *source, std::size_t size, std::vector<unsigned char> &out);
+
+// decompresses a block into exactly destinationSize bytes, false if the block is corrupt or
+// doesn't decompress to that size; never reads or writes outside the two buffers
+bool lz4Decompress(const unsigned char *source, std::size_t sourceSize, unsigned char *destination, std::size_t destinationSize);
+
+#endif
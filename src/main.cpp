@@ -1,9 +1,47 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <optional>
+#include <string>
 
 #include "../include/glad/glad.h" // always link glad before glfw
 #include "GLFW/glfw3.h"
 
-// stored vertex shader GLSL - OpenGL Shading Language
+#include "asset_pack.h"
+#include "benchmarks.h"
+#include "deferred.h"
+#include "dynamic_resolution.h"
+#include "file_watcher.h"
+#include "frame_readback.h"
+#include "gears.h"
+#include "gl_extensions.h"
+#include "gl_trace.h"
+#include "gpu_resources.h"
+#include "immediate.h"
+#include "jobs.h"
+#include "multi_view.h"
+#include "perf_hud.h"
+#include "postprocess.h"
+#include "profiler.h"
+#include "render_farm.h"
+#include "scene.h"
+#include "shader.h"
+#include "split_view.h"
+#include "sprite_batch.h"
+#include "text.h"
+#include "uniform_blocks.h"
+#include "uniform_stream.h"
+
+// shaders and other assets are loaded from here and reloaded when they're saved
+#ifndef ASSET_DIR
+#define ASSET_DIR "assets"
+#endif
+
+// stored vertex shader GLSL - OpenGL Shading Language, only used when assets/shaders can't be loaded
 const char *vertexShaderSource = "#version 330 core\n"
                                  "layout (location = 0) in vec3 aPos;\n"
                                  "void main()\n"
@@ -23,7 +61,8 @@ const char *fragmentShaderSource = "#version 330 core\n"
 // function prototypes
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 
-void processInput(GLFWwindow *window);
+void processInput(GLFWwindow *window, Scene &scene, PostChain &post, DynamicResolution &dynamicResolution, PerfHud &hud,
+                  SplitView &splitView);
 
 GLuint processVertexShader();
 
@@ -35,9 +74,23 @@ GLuint processShaderProgram();
 const unsigned int SCREEN_WIDTH{800};
 const unsigned int SCREEN_HEIGHT{600};
 
-GLFWwindow *initWindow() {
+// current framebuffer size in pixels, kept up to date by framebuffer_size_callback
+int framebufferWidth{0};
+int framebufferHeight{0};
+
+// headless: no real window, glfw's null platform with an OSMesa context, or with a surfaceless EGL
+// context when surfaceless is set, which has no default framebuffer at all
+GLFWwindow *initWindow(bool headless, bool surfaceless) {
     // glfw: init and configure
+    if (headless) {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
+    // the CPU zones read the timer a lot, rdtsc is several times cheaper than clock_gettime
+    glfwInitHint(GLFW_TSC_TIMER, GLFW_TRUE);
     glfwInit();
+    if (headless) {
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, surfaceless ? GLFW_EGL_CONTEXT_API : GLFW_OSMESA_CONTEXT_API);
+    }
     // set glfw version to 3.3, so if that isn't the case our program will fail
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -61,13 +114,51 @@ GLFWwindow *initWindow() {
         std::cout << "Failed to initialize GLAD" << std::endl;
         return nullptr;
     }
+    loadGLExtensions((GLADloadproc) glfwGetProcAddress);
+    // draw calls, state changes and uploads for the performance HUD
+    installGLCounters();
 
     return window;
 }
 
-int main() {
+int main(int argc, char **argv) {
+
+    // --replay-input <file>: play input recorded with --record-input back headless, as fast as
+    // frames render but with the recorded frame times, so every run of it is the same
+    const bool replayInput = argc > 2 && std::strcmp(argv[1], "--replay-input") == 0;
+    // --render-farm <workers> <images> <directory>: render images of the scene from a camera
+    // circling it headless, on that many OSMesa contexts at once, and quit
+    const bool renderFarm = argc > 4 && std::strcmp(argv[1], "--render-farm") == 0;
+    if (renderFarm) {
+        // every worker already keeps a core busy, llvmpipe's own threads would only compete with them
+        setenv("LP_NUM_THREADS", "1", 0);
+    }
+    // --egl as the last argument: run the headless modes on a surfaceless EGL context instead of
+    // OSMesa, like on a headless GPU server; frames are rendered into an FBO and read back
+    const bool headless = replayInput || renderFarm;
+    const bool surfaceless = headless && std::strcmp(argv[argc - 1], "--egl") == 0;
+    GLFWwindow *window = initWindow(headless, surfaceless);
+    if (window == nullptr) {
+        return -1;
+    }
 
-    GLFWwindow *window = initWindow();
+    // --trace <file>: record every GL call of the run, play it back with gl_replay
+    if (argc > 2 && std::strcmp(argv[1], "--trace") == 0) {
+        startGLTrace(argv[2]);
+    }
+    // --record-input <file>: record keyboard and mouse input for --replay-input
+    if (argc > 2 && std::strcmp(argv[1], "--record-input") == 0) {
+        glfwStartInputRecording(argv[2]);
+    }
+    if (replayInput && !glfwStartInputReplay(window, argv[2])) {
+        glfwTerminate();
+        return -1;
+    }
+
+    // worker threads for CPU side frame work like culling, never touch GL from them
+    JobSystem jobs;
+    // owns the GL objects made here, deletes released ones once the GPU is done with them
+    GpuResources resources;
 
     /*
 // we have to define 3 vertices in 3D (OpenGL handles all its graphics in 3D)
@@ -97,14 +188,11 @@ int main() {
 
     // VAO - vertex array object
     // if we want to draw something, we take the corresponding VAO, bind, draw, unbind VAO again
-    GLuint VAO;
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
+    GpuHandle VAO = resources.createVertexArray("shape vertex array");
+    glBindVertexArray(resources.vertexArray(VAO));
 
     // VBO - vertex buffer object
-    GLuint VBO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GpuHandle VBO = resources.createBuffer("shape vertex buffer");
     /*
 1. what type of buffer we want data from
 2. size of data in bytes we want to pass
@@ -114,13 +202,12 @@ STREAM, set once, used a few times at most
 STATIC, set once, used many times
 DYNAMIC, changed alot, used alot
 */ // paremeters of glBufferData
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    // the registry binds it and counts its bytes
+    resources.bufferData(VBO, GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
     // EBO - element buffer object
-    GLuint EBO;
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    GpuHandle EBO = resources.createBuffer("shape element buffer");
+    resources.bufferData(EBO, GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
     /*
     // telling opengl how to interpret vertex data / vertex attribute pointers
@@ -134,38 +221,509 @@ DYNAMIC, changed alot, used alot
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *) nullptr);
     glEnableVertexAttribArray(0);
 
+    // scene: what we draw and which pipeline draws it
+    Scene scene;
+    scene.renderPath = RenderPath::Forward;
+    Mesh shape{resources.vertexArray(VAO), resources.buffer(VBO), resources.buffer(EBO), 6};
+    // every way out releases the shape, what's still alive at resources.destroy() is reported as a leak
+    auto releaseShape = [&resources, &VAO, &VBO, &EBO] {
+        resources.release(VAO);
+        resources.release(VBO);
+        resources.release(EBO);
+    };
+    std::copy(vertices, vertices + 3, shape.boundsMin);
+    std::copy(vertices, vertices + 3, shape.boundsMax);
+    for (std::size_t i = 3; i < sizeof(vertices) / sizeof(float); i += 3) {
+        for (std::size_t k = 0; k < 3; ++k) {
+            shape.boundsMin[k] = std::min(shape.boundsMin[k], vertices[i + k]);
+            shape.boundsMax[k] = std::max(shape.boundsMax[k], vertices[i + k]);
+        }
+    }
+    scene.meshes.push_back(shape);
+    // --gears [<MiB>]: also the gears of glfw's gears example, recorded in immediate mode style,
+    // shown by the deferred path, the split view and the view windows; with a GPU memory budget
+    // they're evicted while the forward path shows only the shape, and recorded again once needed
+    const std::size_t gearsBegin = scene.meshes.size();
+    const bool gears = argc > 1 && std::strcmp(argv[1], "--gears") == 0;
+    if (gears && argc > 2) {
+        resources.setBudget(static_cast<GLsizeiptr>(std::max(0, std::atoi(argv[2]))) * 1024 * 1024);
+    }
+    std::size_t gearRecordings = 0;
+    auto recordGears = [&resources, &scene, &gearRecordings] {
+        ImmediateRecorder recorder;
+        recorder.setResources(&resources, true);
+        mat4x4 placement;
+        mat4x4_translate(placement, 0.5f, 0.55f, 0.0f);
+        mat4x4_scale_aniso(placement, placement, 0.06f, 0.06f, 0.06f);
+        ++gearRecordings;
+        // the shadow cache holds the old ones
+        ++scene.staticVersion;
+        if (addGears(recorder, placement, scene.meshes) && gearRecordings == 1) {
+            std::cout << "gears: " << recorder.recordedVertices() << " vertices recorded in the last list, "
+                      << recorder.uniqueVertices() << " after merging" << std::endl;
+        }
+    };
+    // releases what the budget left of them too, a stale handle is ignored
+    auto releaseGears = [&resources, &scene, gearsBegin] {
+        for (std::size_t i = gearsBegin; i < scene.meshes.size(); ++i) {
+            for (GpuHandle &handle : scene.meshes[i].handles) {
+                resources.release(handle);
+            }
+        }
+    };
+    if (gears) {
+        recordGears();
+    }
+    scene.lights.push_back(PointLight{{0.25f, 0.1f, 0.5f}, 0.8f, {1.0f, 0.9f, 0.8f}, 1.5f});
+    scene.lights.push_back(PointLight{{0.9f, 0.2f, 0.3f}, 0.5f, {0.3f, 0.5f, 1.0f}, 2.0f});
+    mat4x4_identity(scene.view);
+    mat4x4_identity(scene.projection);
+
+    // deferred path: g-buffer + tiled lighting, used by scenes with RenderPath::Deferred
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+
+    // without a default framebuffer the frame goes into this one instead and is read back
+    FrameReadback readback;
+    if (surfaceless && !readback.init(framebufferWidth, framebufferHeight, resources)) {
+        releaseGears();
+        releaseShape();
+        resources.destroy();
+        glfwTerminate();
+        return -1;
+    }
+    const GLuint screenFramebuffer = readback.framebuffer();
+    std::vector<unsigned char> frame;
+    std::vector<std::uint64_t> frameHashes;
+    // uniform blocks of the frame, the camera and the meshes, streamed through one buffer
+    UniformStream uniforms;
+    uniforms.init(resources);
+    DeferredRenderer deferred;
+    if (!deferred.init(framebufferWidth, framebufferHeight, jobs, uniforms, resources)) {
+        std::cout << "Failed to initialize deferred renderer, falling back to forward" << std::endl;
+    }
+
+    // post processing: everything starts disabled, the scene then goes straight to the screen
+    PostChain post;
+    if (!post.init(framebufferWidth, framebufferHeight, resources)) {
+        std::cout << "Failed to initialize post processing" << std::endl;
+    }
+
+    // dynamic resolution: renders below the framebuffer size when the GPU misses the frame budget
+    DynamicResolution dynamicResolution;
+    dynamicResolution.init();
+
+    // 2D overlay, drawn on top of everything in screen pixels
+    SpriteBatch ui;
+    if (!ui.init(resources)) {
+        std::cout << "Failed to initialize sprite batch" << std::endl;
+    }
+
+    // SDF text for HUD and debug labels
+    TextRenderer text;
+    if (!text.init(jobs, resources)) {
+        std::cout << "Failed to initialize text rendering" << std::endl;
+    }
+
+    // --bench-<name>: run one of the offscreen benchmarks instead of the app and quit
+    if (argc > 1 && std::strncmp(argv[1], "--bench-", 8) == 0) {
+        if (std::strcmp(argv[1], "--bench-post") == 0) {
+            benchmarkPost(post);
+        } else if (std::strcmp(argv[1], "--bench-text") == 0) {
+            benchmarkText(text);
+        } else if (std::strcmp(argv[1], "--bench-timer") == 0) {
+            benchmarkTimer();
+        } else {
+            std::cout << "Unknown benchmark " << argv[1] << std::endl;
+        }
+        readback.destroy();
+        text.destroy();
+        ui.destroy();
+        dynamicResolution.destroy();
+        post.destroy();
+        deferred.destroy();
+        uniforms.destroy();
+        releaseGears();
+        releaseShape();
+        resources.destroy();
+        glfwTerminate();
+        return 0;
+    }
+
+    if (renderFarm) {
+        const unsigned workerCount = static_cast<unsigned>(std::max(1, std::atoi(argv[2])));
+        const int imageCount = std::max(1, std::atoi(argv[3]));
+
+        // the camera goes once around the shape, looking at its center
+        const float center[3]{(shape.boundsMin[0] + shape.boundsMax[0]) * 0.5f,
+                              (shape.boundsMin[1] + shape.boundsMax[1]) * 0.5f,
+                              (shape.boundsMin[2] + shape.boundsMax[2]) * 0.5f};
+        std::vector<RenderJob> farmJobs(static_cast<std::size_t>(imageCount));
+        for (int i = 0; i < imageCount; ++i) {
+            RenderJob &job = farmJobs[static_cast<std::size_t>(i)];
+            char name[32];
+            std::snprintf(name, sizeof(name), "/frame_%04d.png", i);
+            job.outputPath = std::string(argv[4]) + name;
+            job.width = SCREEN_WIDTH;
+            job.height = SCREEN_HEIGHT;
+            const float angle = 6.2831853f * static_cast<float>(i) / static_cast<float>(imageCount);
+            vec3 eye{center[0] + 1.5f * std::sin(angle), center[1] + 0.5f, center[2] + 1.5f * std::cos(angle)};
+            vec3 target{center[0], center[1], center[2]};
+            vec3 up{0.0f, 1.0f, 0.0f};
+            mat4x4_look_at(job.view, eye, target, up);
+            mat4x4_perspective(job.projection, 1.0f, static_cast<float>(job.width) / static_cast<float>(job.height), 0.1f, 10.0f);
+        }
+
+        // every worker uploads the shape into its own context, VAOs and programs aren't shared
+        auto buildScene = [&](Scene &workerScene, GLuint &forwardProgram) {
+            workerScene = scene;
+            GLuint vao, buffers[2];
+            glGenVertexArrays(1, &vao);
+            glBindVertexArray(vao);
+            glGenBuffers(2, buffers);
+            glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *) nullptr);
+            glEnableVertexAttribArray(0);
+            glBindVertexArray(0);
+            workerScene.meshes.front().vao = vao;
+            workerScene.meshes.front().vertexBuffer = buffers[0];
+            workerScene.meshes.front().indexBuffer = buffers[1];
+            forwardProgram = processShaderProgram();
+            return forwardProgram != 0;
+        };
+
+        const auto start = std::chrono::steady_clock::now();
+        const std::vector<RenderJobTiming> timings = runRenderFarm(farmJobs, workerCount, jobs, buildScene);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::size_t written = 0;
+        for (std::size_t i = 0; i < timings.size(); ++i) {
+            const RenderJobTiming &timing = timings[i];
+            written += timing.written ? 1 : 0;
+            std::cout << "render farm: " << farmJobs[i].outputPath << " on worker " << timing.worker << ": render "
+                      << timing.renderMs << " ms, readback " << timing.readbackMs << " ms, write " << timing.writeMs
+                      << " ms" << std::endl;
+        }
+        std::cout << "render farm: " << written << " of " << farmJobs.size() << " images on " << workerCount
+                  << " workers in " << seconds << " s, " << static_cast<double>(written) / seconds << " images/s"
+                  << std::endl;
+
+        readback.destroy();
+        text.destroy();
+        ui.destroy();
+        dynamicResolution.destroy();
+        post.destroy();
+        deferred.destroy();
+        uniforms.destroy();
+        releaseGears();
+        releaseShape();
+        resources.destroy();
+        glfwTerminate();
+        return written == farmJobs.size() ? 0 : 1;
+    }
+
+    // forward path shaders, rebuilt whenever assets/shaders/forward.* are saved
+    FileWatcher assets;
+    HotProgram forwardProgram;
+    GpuHandle fallbackProgram{GpuResources::NO_HANDLE};
+    // --pack <file>: take the assets from a pack built with the asset_pack tool instead, no reloading
+    AssetPack pack;
+    if (argc > 2 && std::strcmp(argv[1], "--pack") == 0 && pack.open(argv[2])) {
+        std::string vertexSource, fragmentSource;
+        if (pack.read("shaders/forward.vert", vertexSource) && pack.read("shaders/forward.frag", fragmentSource)) {
+            fallbackProgram = resources.adoptProgram(compileProgram(vertexSource.c_str(), fragmentSource.c_str(), "FORWARD"),
+                                                     "forward program from the pack");
+        }
+        if (fallbackProgram == GpuResources::NO_HANDLE) {
+            fallbackProgram = resources.adoptProgram(processShaderProgram(), "built-in forward program");
+        }
+    } else if (!forwardProgram.load(assets, ASSET_DIR "/shaders/forward.vert", ASSET_DIR "/shaders/forward.frag", "FORWARD")) {
+        // no usable files, draw with the shaders compiled into the binary until they're fixed
+        fallbackProgram = resources.adoptProgram(processShaderProgram(), "built-in forward program");
+    }
+    // saved assets also wake the wait while minimised; glfw only waits on fds on X11, the other
+    // platforms would report GLFW_FEATURE_UNAVAILABLE, there the wait times out to look for changes
+    const bool wakeOnAssets = glfwGetPlatform() == GLFW_PLATFORM_X11 && assets.changeFd() >= 0 &&
+                              glfwAddEventFd(assets.changeFd());
+
+    // performance HUD, F4
+    PerfHud hud;
+    const std::size_t sceneZone = profiler.addZone("scene");
+    const std::size_t postZone = profiler.addZone("post processing");
+    const std::size_t overlayZone = profiler.addZone("overlay");
+    const std::size_t viewsZone = profiler.addZone("views");
+
+    // --views <count>: that many more windows showing the scene from four cameras around it, views
+    // past the fourth repeat a camera the way a monitoring wall mirrors a feed
+    MultiView multiView;
+    if (argc > 2 && std::strcmp(argv[1], "--views") == 0) {
+        const int viewCount = std::max(1, std::atoi(argv[2]));
+        if (multiView.init(window, viewCount, SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2)) {
+            const float center[3]{(shape.boundsMin[0] + shape.boundsMax[0]) * 0.5f,
+                                  (shape.boundsMin[1] + shape.boundsMax[1]) * 0.5f,
+                                  (shape.boundsMin[2] + shape.boundsMax[2]) * 0.5f};
+            for (int i = 0; i < multiView.viewCount(); ++i) {
+                const float angle = 1.5707963f * static_cast<float>(i % 4) + 0.4f;
+                vec3 eye{center[0] + 1.5f * std::sin(angle), center[1] + 0.5f, center[2] + 1.5f * std::cos(angle)};
+                vec3 target{center[0], center[1], center[2]};
+                vec3 up{0.0f, 1.0f, 0.0f};
+                mat4x4 view, projection;
+                mat4x4_look_at(view, eye, target, up);
+                mat4x4_perspective(projection, 1.0f, static_cast<float>(SCREEN_WIDTH) / static_cast<float>(SCREEN_HEIGHT), 0.1f, 10.0f);
+                multiView.setCamera(i, view, projection);
+            }
+        }
+    }
+
+    // split view, F5: front, top and side orthographic and one perspective camera orbiting the scene
+    SplitView splitView;
+    const float sceneCenter[3]{(shape.boundsMin[0] + shape.boundsMax[0]) * 0.5f,
+                               (shape.boundsMin[1] + shape.boundsMax[1]) * 0.5f,
+                               (shape.boundsMin[2] + shape.boundsMax[2]) * 0.5f};
+    if (splitView.init(resources)) {
+        const vec3 eyes[3]{{0.0f, 0.0f, 2.0f}, {0.0f, 2.0f, 0.0f}, {2.0f, 0.0f, 0.0f}};
+        const vec3 ups[3]{{0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, {0.0f, 1.0f, 0.0f}};
+        for (int i = 0; i < 3; ++i) {
+            vec3 eye{sceneCenter[0] + eyes[i][0], sceneCenter[1] + eyes[i][1], sceneCenter[2] + eyes[i][2]};
+            vec3 target{sceneCenter[0], sceneCenter[1], sceneCenter[2]};
+            vec3 up{ups[i][0], ups[i][1], ups[i][2]};
+            mat4x4 view, projection;
+            mat4x4_look_at(view, eye, target, up);
+            const float aspect = static_cast<float>(SCREEN_WIDTH) / static_cast<float>(SCREEN_HEIGHT);
+            mat4x4_ortho(projection, -1.2f * aspect, 1.2f * aspect, -1.2f, 1.2f, 0.1f, 4.0f);
+            splitView.setCamera(i, view, projection);
+        }
+    }
+
     // render loop
+    double lastFrameTime = glfwGetTime();
+    float lastFrameSeconds = 0.0f;
     while (!glfwWindowShouldClose(window)) {
         // input
-        processInput(window);
-
-        // rendering here
+        processInput(window, scene, post, dynamicResolution, hud, splitView);
+
+        // edited shaders and assets, the old versions keep drawing until the new ones are built
+        assets.update();
+        forwardProgram.update();
+
+        // minimised, nothing to draw into
+        if (framebufferWidth == 0 || framebufferHeight == 0) {
+            if (wakeOnAssets) {
+                glfwWaitEvents();
+            } else {
+                glfwWaitEventsTimeout(0.25);
+            }
+            continue;
+        }
+        if (surfaceless) {
+            readback.resize(framebufferWidth, framebufferHeight);
+        }
+        dynamicResolution.beginFrame();
+
+        // the paths that draw the gears keep them from being evicted, and record them again if they were
+        if (gears && (splitView.enabled() || scene.renderPath == RenderPath::Deferred || multiView.viewCount() > 0)) {
+            bool evicted = false;
+            for (std::size_t i = gearsBegin; i < scene.meshes.size(); ++i) {
+                const Mesh &mesh = scene.meshes[i];
+                evicted = evicted || resources.vertexArray(mesh.handles[0]) == 0 || resources.buffer(mesh.handles[1]) == 0 ||
+                          resources.buffer(mesh.handles[2]) == 0;
+            }
+            if (evicted) {
+                for (std::size_t i = gearsBegin; i < scene.meshes.size(); ++i) {
+                    multiView.forgetMesh(scene.meshes[i]);
+                }
+                releaseGears();
+                scene.meshes.erase(scene.meshes.begin() + static_cast<std::ptrdiff_t>(gearsBegin), scene.meshes.end());
+                recordGears();
+                splitView.invalidate();
+            }
+            for (std::size_t i = gearsBegin; i < scene.meshes.size(); ++i) {
+                for (GpuHandle handle : scene.meshes[i].handles) {
+                    resources.touch(handle);
+                }
+            }
+        }
+
+        // rendering here, into the post chain's HDR target when any post step is on or when
+        // rendering below the framebuffer size, the chain then also does the upscale
+        int renderWidth, renderHeight;
+        dynamicResolution.renderSize(framebufferWidth, framebufferHeight, renderWidth, renderHeight);
+        const bool offscreen = post.active() || renderWidth != framebufferWidth || renderHeight != framebufferHeight;
+        GLuint sceneTarget = screenFramebuffer;
+        if (offscreen) {
+            post.resize(renderWidth, renderHeight);
+            sceneTarget = post.sceneFramebuffer();
+        }
+        uniforms.write(FRAME_BLOCK_BINDING, FrameBlock{{static_cast<float>(renderWidth), static_cast<float>(renderHeight)},
+                                                       static_cast<float>(glfwGetTime()), lastFrameSeconds});
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneTarget);
+        glViewport(0, 0, renderWidth, renderHeight);
         glClearColor(0.2f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        // process shaders through a program which is linked to the shaders
-        // use whenever we want to render something
-        GLuint shaderProgram = processShaderProgram();
-        glUseProgram(shaderProgram);
-
-        // unbind VAO after drawing
-        glBindVertexArray(VAO);
-
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
-        glBindVertexArray(0); // todo: what does this do?
+        // CPU zones of the frame, emplacing the next one closes the previous one
+        std::optional<CpuZone> zone(std::in_place, sceneZone);
+        if (splitView.enabled()) {
+            // only the orbiting camera moves, the orthographic quadrants are drawn once
+            const float angle = static_cast<float>(glfwGetTime()) * 0.5f;
+            vec3 eye{sceneCenter[0] + 1.5f * std::sin(angle), sceneCenter[1] + 0.5f, sceneCenter[2] + 1.5f * std::cos(angle)};
+            vec3 target{sceneCenter[0], sceneCenter[1], sceneCenter[2]};
+            vec3 up{0.0f, 1.0f, 0.0f};
+            mat4x4 view, projection;
+            mat4x4_look_at(view, eye, target, up);
+            mat4x4_perspective(projection, 1.0f, static_cast<float>(renderWidth) / static_cast<float>(renderHeight), 0.1f, 10.0f);
+            splitView.setCamera(3, view, projection);
+            splitView.render(scene, renderWidth, renderHeight, sceneTarget);
+        } else if (scene.renderPath == RenderPath::Deferred) {
+            deferred.render(scene, renderWidth, renderHeight, sceneTarget);
+        } else {
+            // the newest version of the forward shaders that built
+            glUseProgram(forwardProgram.program() != 0 ? forwardProgram.program() : resources.program(fallbackProgram));
+
+            // unbind VAO after drawing
+            glBindVertexArray(resources.vertexArray(VAO));
+
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+            glBindVertexArray(0); // todo: what does this do?
+        }
+
+        zone.emplace(postZone);
+        if (offscreen) {
+            post.apply(screenFramebuffer, framebufferWidth, framebufferHeight);
+        }
+
+        // status bar: one square per toggle, lit while it's on
+        glBindFramebuffer(GL_FRAMEBUFFER, screenFramebuffer);
+        glViewport(0, 0, framebufferWidth, framebufferHeight);
+        zone.emplace(overlayZone);
+        ui.begin(framebufferWidth, framebufferHeight);
+        const PostSettings &postSettings = post.settings();
+        const bool toggles[]{scene.renderPath == RenderPath::Deferred, dynamicResolution.enabled(), splitView.enabled(),
+                             postSettings.toneMapping, postSettings.bloom, postSettings.fxaa,
+                             postSettings.colorGrading, postSettings.vignette};
+        for (std::size_t i = 0; i < std::size(toggles); ++i) {
+            const float x = 8.0f + static_cast<float>(i) * 20.0f;
+            ui.drawRect(x, 8.0f, 16.0f, 16.0f, SpriteBatch::packRGBA(0, 0, 0, 160));
+            if (toggles[i]) {
+                ui.drawRect(x + 3.0f, 11.0f, 10.0f, 10.0f, SpriteBatch::packRGBA(120, 220, 120));
+            }
+        }
+        ui.end();
+
+        text.begin(framebufferWidth, framebufferHeight);
+        const char *pathLabel = scene.renderPath == RenderPath::Deferred ? "deferred" : "forward";
+        if (splitView.enabled()) {
+            const SplitView::ViewportSelection selection = splitView.viewportSelection();
+            pathLabel = selection == SplitView::ViewportSelection::Instanced        ? "split view, instanced"
+                        : selection == SplitView::ViewportSelection::GeometryShader ? "split view, geometry shader"
+                                                                                    : "split view";
+        }
+        text.drawText(pathLabel, 8.0f, 28.0f, 16.0f, SpriteBatch::packRGBA(230, 230, 230));
+        hud.draw(text, 8.0f, 52.0f, DynamicResolutionConfig{}.targetFrameMs);
+        text.end();
+        // the view windows swap without waiting, before the main window's swap waits for vblank
+        if (multiView.viewCount() > 0) {
+            zone.emplace(viewsZone);
+            multiView.render(scene);
+        }
+        zone.reset();
+        dynamicResolution.endFrame();
+        uniforms.endFrame();
+        resources.endFrame();
+        // surfaceless: queue the copy of this frame, take back the earlier ones that are done by now;
+        // with a full ring the oldest is waited for, the hash can't depend on how far the GPU lags
+        if (surfaceless) {
+            if (readback.pending() == FrameReadback::FRAMES_IN_FLIGHT && readback.read(frame, true)) {
+                frameHashes.push_back(packHash(frame.data(), frame.size()));
+            }
+            readback.capture();
+            while (readback.read(frame, false)) {
+                frameHashes.push_back(packHash(frame.data(), frame.size()));
+            }
+        }
+        const double cpuMs = (glfwGetTime() - lastFrameTime) * 1000.0;
+
+        markGLTraceFrame();
 
         // glfw: check and call IO(key press, release, mouse move) events, swap the buffer
         glfwPollEvents();
         glfwSwapBuffers(window);
+
+        double now = glfwGetTime();
+        const double frameMs = (now - lastFrameTime) * 1000.0;
+        // the frame time includes the vsync wait, which would make every frame look CPU bound
+        dynamicResolution.update(cpuMs);
+        lastFrameTime = now;
+        lastFrameSeconds = static_cast<float>(frameMs / 1000.0);
+
+        profiler.endFrame();
+        if (scene.renderPath == RenderPath::Deferred) {
+            hud.gpuZone("geometry", deferred.geometryPassMs());
+            hud.gpuZone("lighting", deferred.lightingPassMs());
+        }
+        if (offscreen) {
+            hud.gpuZone("bloom", post.bloomMs());
+            hud.gpuZone("tone map and grading", post.fusedMs());
+            hud.gpuZone("fxaa", post.fxaaMs());
+        }
+        hud.endFrame(profiler, frameMs, cpuMs, dynamicResolution.gpuFrameMs());
     }
 
+    if (wakeOnAssets) {
+        glfwRemoveEventFd(assets.changeFd());
+    }
+    if (surfaceless) {
+        while (readback.read(frame, true)) {
+            frameHashes.push_back(packHash(frame.data(), frame.size()));
+        }
+        // one hash over every frame, the same input and settings give the same hash on the same driver
+        std::cout << "headless: " << frameHashes.size() << " frames read back, " << readback.droppedFrames()
+                  << " dropped, hash " << std::hex << packHash(frameHashes.data(), frameHashes.size() * sizeof(std::uint64_t))
+                  << std::dec << std::endl;
+    }
+    // this instance's footprint while everything is still alive, for boxes that run many of them
+    const GpuMemoryInfo memory = queryGpuMemory();
+    std::cout << "GPU memory: " << resources.totalBytes() << " bytes in " << resources.liveCount() << " objects, "
+              << resources.bytes(GpuResourceType::Buffer) << " in buffers, " << resources.bytes(GpuResourceType::Texture)
+              << " in textures, " << resources.bytes(GpuResourceType::Renderbuffer) << " in renderbuffers";
+    if (resources.budget() > 0) {
+        std::cout << ", budget " << resources.budget() << " bytes, gears recorded " << gearRecordings << " times";
+    }
+    if (memory.availableKiB >= 0) {
+        std::cout << ", driver reports " << memory.availableKiB << " KiB free";
+        if (memory.totalKiB >= 0) {
+            std::cout << " of " << memory.totalKiB << " KiB";
+        }
+    }
+    std::cout << std::endl;
+    readback.destroy();
+    for (std::size_t i = gearsBegin; i < scene.meshes.size(); ++i) {
+        multiView.forgetMesh(scene.meshes[i]);
+    }
+    releaseGears();
+    multiView.destroy();
+    splitView.destroy();
+    forwardProgram.destroy();
+    resources.release(fallbackProgram);
+    releaseShape();
+    text.destroy();
+    ui.destroy();
+    dynamicResolution.destroy();
+    post.destroy();
+    deferred.destroy();
+    uniforms.destroy();
+    resources.destroy();
+    stopGLTrace();
+
     // glfw: terminate, clearing all previously allocated GLFW resources.
     glfwTerminate();
     return 0;
 }
 
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
-void processInput(GLFWwindow *window) {
+void processInput(GLFWwindow *window, Scene &scene, PostChain &post, DynamicResolution &dynamicResolution, PerfHud &hud,
+                  SplitView &splitView) {
     // press ESC to exit program
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
         glfwSetWindowShouldClose(window, true);
@@ -178,6 +736,55 @@ void processInput(GLFWwindow *window) {
         // otherwise render as filled
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
     }
+
+    // press F2 to switch the scene between forward and deferred rendering
+    static bool f2WasPressed{false};
+    bool f2Pressed = glfwGetKey(window, GLFW_KEY_F2) == GLFW_PRESS;
+    if (f2Pressed && !f2WasPressed) {
+        scene.renderPath = scene.renderPath == RenderPath::Forward ? RenderPath::Deferred : RenderPath::Forward;
+    }
+    f2WasPressed = f2Pressed;
+
+    // press F3 to toggle dynamic resolution scaling
+    static bool f3WasPressed{false};
+    bool f3Pressed = glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS;
+    if (f3Pressed && !f3WasPressed) {
+        dynamicResolution.setEnabled(!dynamicResolution.enabled());
+    }
+    f3WasPressed = f3Pressed;
+
+    // press F4 to show the performance HUD
+    static bool f4WasPressed{false};
+    bool f4Pressed = glfwGetKey(window, GLFW_KEY_F4) == GLFW_PRESS;
+    if (f4Pressed && !f4WasPressed) {
+        hud.setVisible(!hud.visible());
+    }
+    f4WasPressed = f4Pressed;
+
+    // press F5 to show the scene from four cameras at once
+    static bool f5WasPressed{false};
+    bool f5Pressed = glfwGetKey(window, GLFW_KEY_F5) == GLFW_PRESS;
+    if (f5Pressed && !f5WasPressed) {
+        splitView.setEnabled(!splitView.enabled());
+    }
+    f5WasPressed = f5Pressed;
+
+    // press 1-5 to toggle the post processing steps
+    static bool digitWasPressed[5]{};
+    PostSettings settings = post.settings();
+    bool *toggles[5]{&settings.toneMapping, &settings.bloom, &settings.fxaa, &settings.colorGrading, &settings.vignette};
+    bool changed = false;
+    for (int i = 0; i < 5; ++i) {
+        bool pressed = glfwGetKey(window, GLFW_KEY_1 + i) == GLFW_PRESS;
+        if (pressed && !digitWasPressed[i]) {
+            *toggles[i] = !*toggles[i];
+            changed = true;
+        }
+        digitWasPressed[i] = pressed;
+    }
+    if (changed) {
+        post.build(settings);
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -185,6 +792,8 @@ void framebuffer_size_callback(GLFWwindow *window, int width, int height) {
     // make sure the viewport matches the new window dimensions; note that width and
     // height will be significantly larger than specified on retina displays.
     glViewport(0, 0, width, height);
+    framebufferWidth = width;
+    framebufferHeight = height;
 }
 
 GLuint processVertexShader() {
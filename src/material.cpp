@@ -0,0 +1,88 @@
+#include "material.h"
+
+#include <cstring>
+
+bool MaterialTable::init(GpuResources &resources, std::size_t capacity) {
+    m_resources = &resources;
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    const GLsizeiptr blockAlignment = alignment > 0 ? alignment : 256;
+    m_stride = (static_cast<GLsizeiptr>(sizeof(ObjectBlock)) + blockAlignment - 1) / blockAlignment * blockAlignment;
+    m_capacity = capacity > 0 ? capacity : 1;
+
+    m_handle = resources.createBuffer("material blocks");
+    resources.bufferData(m_handle, GL_COPY_WRITE_BUFFER, m_stride * static_cast<GLsizeiptr>(m_capacity), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    m_buffer = resources.buffer(m_handle);
+    return m_buffer != 0;
+}
+
+void MaterialTable::destroy() {
+    if (m_resources != nullptr) {
+        m_resources->release(m_handle);
+    }
+    m_buffer = 0;
+    m_materials.clear();
+    m_ids.clear();
+    m_uploaded = 0;
+}
+
+MaterialId MaterialTable::intern(const Material &material) {
+    const auto [found, inserted] = m_ids.try_emplace(material, static_cast<MaterialId>(m_materials.size()));
+    if (inserted) {
+        m_materials.push_back(material);
+    }
+    return found->second;
+}
+
+void MaterialTable::upload() {
+    m_uploadedBytes = 0;
+    if (m_uploaded == m_materials.size()) {
+        return;
+    }
+
+    // a larger buffer starts empty, so everything goes up again
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    if (m_materials.size() > m_capacity) {
+        while (m_capacity < m_materials.size()) {
+            m_capacity *= 2;
+        }
+        m_resources->bufferData(m_handle, GL_COPY_WRITE_BUFFER, m_stride * static_cast<GLsizeiptr>(m_capacity), nullptr,
+                                GL_STATIC_DRAW);
+        m_uploaded = 0;
+    }
+
+    const std::size_t count = m_materials.size() - m_uploaded;
+    m_staging.assign(static_cast<std::size_t>(m_stride) * count, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::memcpy(m_staging.data() + static_cast<std::size_t>(m_stride) * i, &m_materials[m_uploaded + i].block, sizeof(ObjectBlock));
+    }
+    m_uploadedBytes = static_cast<GLsizeiptr>(m_staging.size());
+    glBufferSubData(GL_COPY_WRITE_BUFFER, m_stride * static_cast<GLintptr>(m_uploaded), m_uploadedBytes, m_staging.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    m_uploaded = m_materials.size();
+}
+
+void MaterialTable::bind(MaterialId id) const {
+    glBindBufferRange(GL_UNIFORM_BUFFER, OBJECT_BLOCK_BINDING, m_buffer, m_stride * static_cast<GLintptr>(id), sizeof(ObjectBlock));
+}
+
+std::size_t MaterialTable::MaterialHash::operator()(const Material &material) const {
+    // FNV-1a over the members, the block's padding is zeroed by Material's initialiser
+    std::uint64_t hash = 14695981039346656037ull;
+    const auto mix = [&hash](const void *data, std::size_t size) {
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    mix(&material.variant, sizeof(material.variant));
+    mix(&material.block, sizeof(material.block));
+    mix(&material.state.cullBackFaces, sizeof(material.state.cullBackFaces));
+    return static_cast<std::size_t>(hash);
+}
+
+bool MaterialTable::MaterialEqual::operator()(const Material &a, const Material &b) const {
+    return a.variant == b.variant && std::memcmp(&a.block, &b.block, sizeof(ObjectBlock)) == 0 &&
+           a.state.cullBackFaces == b.state.cullBackFaces;
+}
@@ -0,0 +1,77 @@
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/glad/glad.h"
+
+#include "gpu_resources.h"
+
+#include "uniform_blocks.h"
+
+// fixed function state a material switches
+struct RenderState {
+    bool cullBackFaces{false};
+};
+
+// everything a draw of the geometry pass depends on besides the mesh
+struct Material {
+    // feature mask of the program variant that draws it
+    std::uint32_t variant{0};
+    ObjectBlock block{};
+    RenderState state;
+};
+
+using MaterialId = std::uint32_t;
+
+// materials interned into a table, identical ones share an id, so sorting draws by id puts every
+// draw of a look next to each other and switching between them happens once per look, not per draw
+// - ids are handed out in order and index the table, a draw's material is one array access
+// - the ObjectBlocks live in one uniform buffer at the table's ids, the ones interned since the
+//   last upload() go up in a single glBufferSubData, blocks already on the GPU are never rewritten
+// - nothing is ever removed, the table is meant for a scene's few dozen looks, not for values that
+//   change every frame
+class MaterialTable {
+public:
+    // the uniform buffer belongs to resources, which has to outlive the table
+    bool init(GpuResources &resources, std::size_t capacity = 64);
+    void destroy();
+
+    // id of the material, adds it to the table if it isn't in there yet
+    MaterialId intern(const Material &material);
+    const Material &material(MaterialId id) const { return m_materials[id]; }
+    std::size_t size() const { return m_materials.size(); }
+
+    // sends the blocks added since the last call, grows the buffer if they don't fit
+    void upload();
+    // binds the material's block at OBJECT_BLOCK_BINDING, upload() has to have seen it
+    void bind(MaterialId id) const;
+
+    // bytes sent by the last upload(), 0 when no material was added
+    GLsizeiptr uploadedBytes() const { return m_uploadedBytes; }
+
+private:
+    struct MaterialHash {
+        std::size_t operator()(const Material &material) const;
+    };
+    struct MaterialEqual {
+        bool operator()(const Material &a, const Material &b) const;
+    };
+
+    std::vector<Material> m_materials;
+    std::unordered_map<Material, MaterialId, MaterialHash, MaterialEqual> m_ids;
+
+    GpuResources *m_resources{nullptr};
+    GpuHandle m_handle{GpuResources::NO_HANDLE};
+    GLuint m_buffer{0};
+    GLsizeiptr m_stride{0};
+    std::size_t m_capacity{0};
+    // materials below this are on the GPU
+    std::size_t m_uploaded{0};
+    GLsizeiptr m_uploadedBytes{0};
+    std::vector<unsigned char> m_staging;
+};
+
+#endif
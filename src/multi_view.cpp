@@ -0,0 +1,175 @@
+#include "multi_view.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "culling.h"
+#include "shader.h"
+
+namespace {
+    const char *viewVertexSource = "#version 330 core\n"
+                                   "layout (location = 0) in vec3 aPos;\n"
+                                   "uniform mat4 viewProjection;\n"
+                                   "out vec3 worldPos;\n"
+                                   "void main()\n"
+                                   "{\n"
+                                   "    worldPos = aPos;\n"
+                                   "    gl_Position = viewProjection * vec4(aPos, 1.0);\n"
+                                   "}\0";
+
+    // flat shaded with the face normal, enough to tell the views apart
+    const char *viewFragmentSource = "#version 330 core\n"
+                                     "out vec4 FragColor;\n"
+                                     "in vec3 worldPos;\n"
+                                     "uniform vec3 albedo;\n"
+                                     "void main()\n"
+                                     "{\n"
+                                     "    vec3 n = normalize(cross(dFdx(worldPos), dFdy(worldPos)));\n"
+                                     "    FragColor = vec4(albedo * (0.3 + 0.7 * abs(n.z)), 1.0);\n"
+                                     "}\0";
+}
+
+bool MultiView::init(GLFWwindow *mainWindow, int count, int width, int height) {
+    m_mainWindow = mainWindow;
+    m_program = compileProgram(viewVertexSource, viewFragmentSource, "MULTI_VIEW");
+    if (m_program == 0) {
+        return false;
+    }
+    m_viewProjectionLocation = glGetUniformLocation(m_program, "viewProjection");
+    m_albedoLocation = glGetUniformLocation(m_program, "albedo");
+
+    for (int i = 0; i < count; ++i) {
+        View view;
+        view.window = glfwCreateWindow(width, height, "view", nullptr, mainWindow);
+        if (view.window == nullptr) {
+            std::cout << "ERROR::MULTI_VIEW::WINDOW_NOT_CREATED\nview " << i << std::endl;
+            break;
+        }
+        mat4x4_identity(view.view);
+        mat4x4_identity(view.projection);
+        // only the main window paces the frame on vblank
+        glfwMakeContextCurrent(view.window);
+        glfwSwapInterval(0);
+        m_views.push_back(std::move(view));
+    }
+    glfwMakeContextCurrent(mainWindow);
+    return !m_views.empty();
+}
+
+void MultiView::destroy() {
+    // the VAOs go with the windows' contexts, the program lives in the shared namespace
+    for (View &view : m_views) {
+        glfwDestroyWindow(view.window);
+    }
+    m_views.clear();
+    if (m_mainWindow != nullptr) {
+        glfwMakeContextCurrent(m_mainWindow);
+    }
+    glDeleteProgram(m_program);
+    m_program = 0;
+}
+
+void MultiView::setCamera(int view, const mat4x4 viewMatrix, const mat4x4 projection) {
+    std::memcpy(m_views[static_cast<std::size_t>(view)].view, viewMatrix, sizeof(mat4x4));
+    std::memcpy(m_views[static_cast<std::size_t>(view)].projection, projection, sizeof(mat4x4));
+}
+
+void MultiView::render(const Scene &scene) {
+    for (auto view = m_views.begin(); view != m_views.end();) {
+        if (glfwWindowShouldClose(view->window)) {
+            glfwDestroyWindow(view->window);
+            view = m_views.erase(view);
+        } else {
+            ++view;
+        }
+    }
+
+    m_cameras.clear();
+    for (View &view : m_views) {
+        const std::size_t camera = cameraFor(scene, view);
+        const CameraCull &cull = m_cameras[camera];
+
+        int width, height;
+        glfwGetFramebufferSize(view.window, &width, &height);
+        if (width == 0 || height == 0) {
+            continue;
+        }
+        glfwMakeContextCurrent(view.window);
+        glViewport(0, 0, width, height);
+        glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glUseProgram(m_program);
+        glUniformMatrix4fv(m_viewProjectionLocation, 1, GL_FALSE, &cull.viewProjection[0][0]);
+        for (std::size_t i : cull.visible) {
+            const Mesh &mesh = scene.meshes[i];
+            glUniform3fv(m_albedoLocation, 1, mesh.albedo);
+            glBindVertexArray(vaoFor(view, mesh));
+            glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, nullptr);
+        }
+        glBindVertexArray(0);
+        glfwSwapBuffers(view.window);
+    }
+    glfwMakeContextCurrent(m_mainWindow);
+}
+
+void MultiView::forgetMesh(const Mesh &mesh) {
+    const std::uint64_t key = vaoKey(mesh);
+    bool switched = false;
+    for (View &view : m_views) {
+        const auto found = view.vaos.find(key);
+        if (found == view.vaos.end()) {
+            continue;
+        }
+        // VAOs only exist in the context that made them
+        glfwMakeContextCurrent(view.window);
+        glDeleteVertexArrays(1, &found->second);
+        view.vaos.erase(found);
+        switched = true;
+    }
+    if (switched) {
+        glfwMakeContextCurrent(m_mainWindow);
+    }
+}
+
+std::uint64_t MultiView::vaoKey(const Mesh &mesh) {
+    return static_cast<std::uint64_t>(mesh.vertexBuffer) << 32 | mesh.indexBuffer;
+}
+
+GLuint MultiView::vaoFor(View &view, const Mesh &mesh) {
+    const std::uint64_t key = vaoKey(mesh);
+    const auto found = view.vaos.find(key);
+    if (found != view.vaos.end()) {
+        return found->second;
+    }
+    // same layout as every mesh: positions at location 0
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *) nullptr);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    view.vaos.emplace(key, vao);
+    return vao;
+}
+
+std::size_t MultiView::cameraFor(const Scene &scene, const View &view) {
+    mat4x4 viewProjection;
+    mat4x4_mul(viewProjection, view.projection, view.view);
+    for (std::size_t i = 0; i < m_cameras.size(); ++i) {
+        if (std::memcmp(m_cameras[i].viewProjection, viewProjection, sizeof(mat4x4)) == 0) {
+            return i;
+        }
+    }
+
+    CameraCull &cull = m_cameras.emplace_back();
+    std::memcpy(cull.viewProjection, viewProjection, sizeof(mat4x4));
+    for (std::size_t i = 0; i < scene.meshes.size(); ++i) {
+        const Mesh &mesh = scene.meshes[i];
+        if (boxInFrustum(cull.viewProjection, mesh.boundsMin, mesh.boundsMax)) {
+            cull.visible.push_back(i);
+        }
+    }
+    return m_cameras.size() - 1;
+}
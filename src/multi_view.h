@@ -0,0 +1,69 @@
+#ifndef MULTI_VIEW_H
+#define MULTI_VIEW_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/glad/glad.h" // always link glad before glfw
+#include "GLFW/glfw3.h"
+
+#include "scene.h"
+
+// extra windows that show the scene from their own cameras, e.g. a monitoring wall
+// - glfw gives every window its own context, so the view windows' contexts share with the main
+//   window's: buffers, textures and the one program exist once, only the VAOs, which can't be
+//   shared, are made per window the first time a mesh is drawn there
+// - views are culled per camera, not per window, views showing the same camera share the result
+// - the view windows swap without vsync right after they're drawn, only the main window waits for
+//   vblank, so N windows don't serialise on N vblanks
+// the scene is drawn forward with flat shading, the deferred and post chains stay main window only
+class MultiView {
+public:
+    // opens count windows sharing mainWindow's objects, mainWindow's context is current afterwards
+    bool init(GLFWwindow *mainWindow, int count, int width, int height);
+    void destroy();
+
+    int viewCount() const { return static_cast<int>(m_views.size()); }
+    void setCamera(int view, const mat4x4 viewMatrix, const mat4x4 projection);
+
+    // culls and draws the scene into every view window and swaps them, views whose window was
+    // closed are dropped first; call with the main window's context current, it is again afterwards
+    void render(const Scene &scene);
+
+    // drops the windows' VAOs of the mesh, before its buffers are deleted; GL hands deleted names
+    // out again and a VAO cached for the old buffers would read the new ones with the old layout
+    // call with the main window's context current, it is again afterwards
+    void forgetMesh(const Mesh &mesh);
+
+    // distinct cameras culled by the last render()
+    std::size_t culledCameras() const { return m_cameras.size(); }
+
+private:
+    struct View {
+        GLFWwindow *window{nullptr};
+        mat4x4 view;
+        mat4x4 projection;
+        // this window's VAO for each vertex + index buffer pair
+        std::unordered_map<std::uint64_t, GLuint> vaos;
+    };
+
+    // one distinct camera of a frame and the meshes inside its frustum
+    struct CameraCull {
+        mat4x4 viewProjection;
+        std::vector<std::size_t> visible;
+    };
+
+    static std::uint64_t vaoKey(const Mesh &mesh);
+    GLuint vaoFor(View &view, const Mesh &mesh);
+    std::size_t cameraFor(const Scene &scene, const View &view);
+
+    GLFWwindow *m_mainWindow{nullptr};
+    std::vector<View> m_views;
+    std::vector<CameraCull> m_cameras;
+    GLuint m_program{0};
+    GLint m_viewProjectionLocation{-1};
+    GLint m_albedoLocation{-1};
+};
+
+#endif
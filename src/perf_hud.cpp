@@ -0,0 +1,150 @@
+#include "perf_hud.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "sprite_batch.h"
+
+namespace {
+    const float TEXT_SIZE{13.0f};
+    const float LINE_HEIGHT{15.0f};
+    const float PADDING{6.0f};
+    const float PANEL_WIDTH{360.0f};
+    const float GRAPH_HEIGHT{60.0f};
+    const float HISTOGRAM_HEIGHT{36.0f};
+}
+
+void PerfHud::gpuZone(const char *name, double ms) {
+    for (std::size_t i = 0; i < m_gpuZoneCount; ++i) {
+        if (std::strcmp(m_gpuZoneNames[i], name) == 0) {
+            m_gpuZoneSums[i] += ms;
+            return;
+        }
+    }
+    if (m_gpuZoneCount < MAX_GPU_ZONES) {
+        m_gpuZoneNames[m_gpuZoneCount] = name;
+        m_gpuZoneSums[m_gpuZoneCount] = ms;
+        ++m_gpuZoneCount;
+    }
+}
+
+void PerfHud::endFrame(const Profiler &profiler, double frameMs, double cpuMs, double gpuMs) {
+    m_history[m_head] = Sample{static_cast<float>(frameMs), static_cast<float>(gpuMs)};
+    m_head = (m_head + 1) % HISTORY;
+
+    ++m_windowFrames;
+    m_frameSum += frameMs;
+    m_cpuSum += cpuMs;
+    m_gpuSum += gpuMs;
+    for (std::size_t i = 0; i < profiler.zoneCount(); ++i) {
+        m_zoneSums[i] += profiler.zoneMs(i);
+    }
+    const PerfSnapshot &counters = profiler.frame();
+    m_counterSums.drawCalls += counters.drawCalls;
+    m_counterSums.stateChanges += counters.stateChanges;
+    m_counterSums.uploadedBytes += counters.uploadedBytes;
+    m_counterSums.allocations += counters.allocations;
+    m_counterSums.allocatedBytes += counters.allocatedBytes;
+    m_counterSums.frees += counters.frees;
+
+    if (m_windowFrames == REFRESH_FRAMES) {
+        refresh(profiler);
+    }
+}
+
+void PerfHud::refresh(const Profiler &profiler) {
+    const double frames = m_windowFrames;
+    const double frameMs = m_frameSum / frames;
+    char line[128];
+    std::snprintf(line, sizeof(line), "%6.2f ms %6.1f fps  cpu %5.2f  gpu %5.2f", frameMs,
+                  frameMs > 0.0 ? 1000.0 / frameMs : 0.0, m_cpuSum / frames, m_gpuSum / frames);
+    m_summary = line;
+
+    m_lines.clear();
+    for (std::size_t i = 0; i < profiler.zoneCount(); ++i) {
+        std::snprintf(line, sizeof(line), "cpu  %-24s %6.2f ms", profiler.zoneName(i), m_zoneSums[i] / frames);
+        m_lines.emplace_back(line);
+    }
+    for (std::size_t i = 0; i < m_gpuZoneCount; ++i) {
+        std::snprintf(line, sizeof(line), "gpu  %-24s %6.2f ms", m_gpuZoneNames[i], m_gpuZoneSums[i] / frames);
+        m_lines.emplace_back(line);
+    }
+    std::snprintf(line, sizeof(line), "draws %6.0f  state changes %7.0f",
+                  static_cast<double>(m_counterSums.drawCalls) / frames, static_cast<double>(m_counterSums.stateChanges) / frames);
+    m_lines.emplace_back(line);
+    std::snprintf(line, sizeof(line), "uploads %9.1f KiB", static_cast<double>(m_counterSums.uploadedBytes) / frames / 1024.0);
+    m_lines.emplace_back(line);
+    std::snprintf(line, sizeof(line), "allocs %6.0f  %8.1f KiB  frees %6.0f",
+                  static_cast<double>(m_counterSums.allocations) / frames,
+                  static_cast<double>(m_counterSums.allocatedBytes) / frames / 1024.0,
+                  static_cast<double>(m_counterSums.frees) / frames);
+    m_lines.emplace_back(line);
+
+    // zones that weren't reported in this window disappear with the next refresh
+    m_windowFrames = 0;
+    m_frameSum = m_cpuSum = m_gpuSum = 0.0;
+    m_zoneSums.fill(0.0);
+    m_gpuZoneCount = 0;
+    m_counterSums = PerfSnapshot{};
+}
+
+void PerfHud::draw(TextRenderer &text, float x, float y, double budgetMs) {
+    if (!m_visible) {
+        return;
+    }
+
+    const float innerWidth = PANEL_WIDTH - PADDING * 2.0f;
+    const float height = PADDING * 4.0f + LINE_HEIGHT * static_cast<float>(2 + m_lines.size()) + GRAPH_HEIGHT + HISTOGRAM_HEIGHT;
+    text.drawRect(x, y, PANEL_WIDTH, height, SpriteBatch::packRGBA(0, 0, 0, 170));
+    const std::uint32_t white = SpriteBatch::packRGBA(230, 230, 230);
+
+    float top = y + PADDING;
+    text.drawText(m_summary, x + PADDING, top, TEXT_SIZE, white);
+    top += LINE_HEIGHT + PADDING;
+
+    // rolling frame times, oldest on the left, scaled so the budget sits in the middle
+    const float left = x + PADDING;
+    const float bottom = top + GRAPH_HEIGHT;
+    const float barWidth = innerWidth / HISTORY;
+    const double graphMs = budgetMs * 2.0;
+    for (std::size_t i = 0; i < HISTORY; ++i) {
+        const Sample &sample = m_history[(m_head + i) % HISTORY];
+        const float barX = left + static_cast<float>(i) * barWidth;
+        const float frameHeight = GRAPH_HEIGHT * static_cast<float>(std::min(sample.frameMs / graphMs, 1.0));
+        const std::uint32_t color = sample.frameMs <= budgetMs ? SpriteBatch::packRGBA(90, 200, 90)
+                                  : sample.frameMs <= budgetMs * 1.5 ? SpriteBatch::packRGBA(220, 200, 60)
+                                  : SpriteBatch::packRGBA(220, 70, 60);
+        text.drawRect(barX, bottom - frameHeight, barWidth, frameHeight, color);
+        const float gpuHeight = GRAPH_HEIGHT * static_cast<float>(std::min(sample.gpuMs / graphMs, 1.0));
+        text.drawRect(barX, bottom - gpuHeight - 1.0f, barWidth, 2.0f, SpriteBatch::packRGBA(80, 170, 255));
+    }
+    text.drawRect(left, bottom - GRAPH_HEIGHT * 0.5f, innerWidth, 1.0f, SpriteBatch::packRGBA(255, 255, 255, 90));
+    top = bottom + PADDING;
+
+    // distribution of the same frames
+    std::array<unsigned, BUCKETS> buckets{};
+    for (const Sample &sample : m_history) {
+        if (sample.frameMs > 0.0f) {
+            ++buckets[std::min(static_cast<std::size_t>(sample.frameMs / BUCKET_MS), BUCKETS - 1)];
+        }
+    }
+    const unsigned most = std::max(1u, *std::max_element(buckets.begin(), buckets.end()));
+    const float bucketWidth = innerWidth / BUCKETS;
+    for (std::size_t i = 0; i < BUCKETS; ++i) {
+        const float bucketHeight = HISTOGRAM_HEIGHT * static_cast<float>(buckets[i]) / static_cast<float>(most);
+        const bool overBudget = static_cast<double>(i) * BUCKET_MS >= budgetMs;
+        text.drawRect(left + static_cast<float>(i) * bucketWidth + 1.0f, top + HISTOGRAM_HEIGHT - bucketHeight, bucketWidth - 2.0f,
+                      bucketHeight, overBudget ? SpriteBatch::packRGBA(220, 70, 60) : SpriteBatch::packRGBA(90, 200, 90));
+    }
+    top += HISTOGRAM_HEIGHT;
+    text.drawText("0 ms", left, top, TEXT_SIZE, white);
+    const char *const slowest = ">32 ms";
+    text.drawText(slowest, left + innerWidth - text.measure(slowest, TEXT_SIZE), top, TEXT_SIZE, white);
+    top += LINE_HEIGHT + PADDING;
+
+    for (const std::string &line : m_lines) {
+        text.drawText(line, left, top, TEXT_SIZE, white);
+        top += LINE_HEIGHT;
+    }
+}
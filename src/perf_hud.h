@@ -0,0 +1,68 @@
+#ifndef PERF_HUD_H
+#define PERF_HUD_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "profiler.h"
+#include "text.h"
+
+// performance overlay: rolling frame time graph, frame time histogram, CPU zones, GPU passes and
+// the profiler's counters
+// - history is recorded every frame, also while hidden, so the graph is full when it's switched on
+// - the numbers are averaged and reformatted every REFRESH_FRAMES frames only, that keeps them
+//   readable and keeps the text renderer's layout cache from filling up with one-off strings
+// - everything goes into the caller's TextRenderer batch, the overlay costs no draw of its own
+class PerfHud {
+public:
+    static constexpr std::size_t HISTORY{240};
+    static constexpr unsigned REFRESH_FRAMES{15};
+    static constexpr std::size_t MAX_GPU_ZONES{8};
+    // histogram buckets of this many ms, the last one collects everything slower
+    static constexpr double BUCKET_MS{2.0};
+    static constexpr std::size_t BUCKETS{17};
+
+    bool visible() const { return m_visible; }
+    void setVisible(bool visible) { m_visible = visible; }
+
+    // a GPU pass timing of this frame, read back from the renderers' timer queries
+    void gpuZone(const char *name, double ms);
+    // once per frame after profiler.endFrame(): frameMs is the time between frames, cpuMs the
+    // time the CPU was busy with the frame and gpuMs the GPU time of the whole frame
+    void endFrame(const Profiler &profiler, double frameMs, double cpuMs, double gpuMs);
+    // adds the overlay to the current text batch with its top left at x, y
+    void draw(TextRenderer &text, float x, float y, double budgetMs);
+
+private:
+    struct Sample {
+        float frameMs{0.0f};
+        float gpuMs{0.0f};
+    };
+
+    void refresh(const Profiler &profiler);
+
+    bool m_visible{false};
+
+    std::array<Sample, HISTORY> m_history{};
+    std::size_t m_head{0};
+
+    // sums over the current refresh window
+    unsigned m_windowFrames{0};
+    double m_frameSum{0.0};
+    double m_cpuSum{0.0};
+    double m_gpuSum{0.0};
+    std::array<double, Profiler::MAX_ZONES> m_zoneSums{};
+    std::array<const char *, MAX_GPU_ZONES> m_gpuZoneNames{};
+    std::array<double, MAX_GPU_ZONES> m_gpuZoneSums{};
+    std::size_t m_gpuZoneCount{0};
+    PerfSnapshot m_counterSums;
+
+    // text of the last refresh
+    std::string m_summary;
+    std::vector<std::string> m_lines;
+};
+
+#endif
@@ -0,0 +1,425 @@
+#include "postprocess.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    // soft threshold of the bright parts, 4 bilinear taps cover 4x4 source texels
+    const char *prefilterFragmentSource = "#version 330 core\n"
+                                          "out vec4 FragColor;\n"
+                                          "uniform sampler2D source;\n"
+                                          "uniform vec2 targetSize;\n"
+                                          "uniform float threshold;\n"
+                                          "void main()\n"
+                                          "{\n"
+                                          "    vec2 uv = gl_FragCoord.xy / targetSize;\n"
+                                          "    vec2 texel = 1.0 / vec2(textureSize(source, 0));\n"
+                                          "    vec3 color = texture(source, uv + vec2(-1.0, -1.0) * texel).rgb;\n"
+                                          "    color += texture(source, uv + vec2(1.0, -1.0) * texel).rgb;\n"
+                                          "    color += texture(source, uv + vec2(-1.0, 1.0) * texel).rgb;\n"
+                                          "    color += texture(source, uv + vec2(1.0, 1.0) * texel).rgb;\n"
+                                          "    color *= 0.25;\n"
+                                          "    float brightness = max(color.r, max(color.g, color.b));\n"
+                                          "    float contribution = max(brightness - threshold, 0.0) / max(brightness, 1e-4);\n"
+                                          "    FragColor = vec4(color * contribution, 1.0);\n"
+                                          "}\0";
+
+    // 9 tap gaussian in 5 fetches by sampling between texels
+    const char *blurFragmentSource = "#version 330 core\n"
+                                     "out vec4 FragColor;\n"
+                                     "uniform sampler2D source;\n"
+                                     "uniform vec2 direction;\n"
+                                     "void main()\n"
+                                     "{\n"
+                                     "    vec2 texel = 1.0 / vec2(textureSize(source, 0));\n"
+                                     "    vec2 uv = gl_FragCoord.xy * texel;\n"
+                                     "    vec2 offset1 = direction * texel * 1.3846153846;\n"
+                                     "    vec2 offset2 = direction * texel * 3.2307692308;\n"
+                                     "    vec3 color = texture(source, uv).rgb * 0.2270270270;\n"
+                                     "    color += (texture(source, uv + offset1).rgb + texture(source, uv - offset1).rgb) * 0.3162162162;\n"
+                                     "    color += (texture(source, uv + offset2).rgb + texture(source, uv - offset2).rgb) * 0.0702702703;\n"
+                                     "    FragColor = vec4(color, 1.0);\n"
+                                     "}\0";
+
+    // every per pixel step in one shader, build() decides which of the blocks are compiled in
+    const char *fusedFragmentSource = "#version 330 core\n"
+                                      "out vec4 FragColor;\n"
+                                      "uniform sampler2D sceneColor;\n"
+                                      "uniform sampler2D bloomTexture;\n"
+                                      "uniform vec2 targetSize;\n"
+                                      "uniform float bloomIntensity;\n"
+                                      "uniform float exposure;\n"
+                                      "uniform vec3 lift;\n"
+                                      "uniform vec3 gamma;\n"
+                                      "uniform vec3 gain;\n"
+                                      "uniform float saturation;\n"
+                                      "uniform float contrast;\n"
+                                      "uniform float vignetteStrength;\n"
+                                      "uniform float vignetteRadius;\n"
+                                      "vec3 aces(vec3 x)\n"
+                                      "{\n"
+                                      "    return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);\n"
+                                      "}\n"
+                                      "void main()\n"
+                                      "{\n"
+                                      "    vec2 uv = gl_FragCoord.xy / targetSize;\n"
+                                      "    vec3 color = texture(sceneColor, uv).rgb;\n"
+                                      "#ifdef BLOOM\n"
+                                      "    color += texture(bloomTexture, uv).rgb * bloomIntensity;\n"
+                                      "#endif\n"
+                                      "#ifdef TONE_MAPPING\n"
+                                      "    color = aces(color * exposure);\n"
+                                      "#endif\n"
+                                      "#ifdef COLOR_GRADING\n"
+                                      "    color = clamp(color, 0.0, 1.0);\n"
+                                      "    color = gain * (color + lift * (1.0 - color));\n"
+                                      "    color = pow(max(color, vec3(0.0)), 1.0 / gamma);\n"
+                                      "    float luma = dot(color, vec3(0.2126, 0.7152, 0.0722));\n"
+                                      "    color = mix(vec3(luma), color, saturation);\n"
+                                      "    color = (color - 0.5) * contrast + 0.5;\n"
+                                      "#endif\n"
+                                      "#ifdef VIGNETTE\n"
+                                      "    float dist = length(uv - 0.5) * 1.41421356;\n"
+                                      "    color *= 1.0 - vignetteStrength * smoothstep(vignetteRadius, 1.0, dist);\n"
+                                      "#endif\n"
+                                      "    FragColor = vec4(color, 1.0);\n"
+                                      "}\0";
+
+    const char *fxaaFragmentSource = "#version 330 core\n"
+                                     "out vec4 FragColor;\n"
+                                     "uniform sampler2D source;\n"
+                                     "uniform vec2 targetSize;\n"
+                                     "const float REDUCE_MIN = 1.0 / 128.0;\n"
+                                     "const float REDUCE_MUL = 1.0 / 8.0;\n"
+                                     "const float SPAN_MAX = 8.0;\n"
+                                     "void main()\n"
+                                     "{\n"
+                                     "    vec2 uv = gl_FragCoord.xy / targetSize;\n"
+                                     "    vec2 texel = 1.0 / vec2(textureSize(source, 0));\n"
+                                     "    const vec3 toLuma = vec3(0.299, 0.587, 0.114);\n"
+                                     "    float lumaNW = dot(texture(source, uv + vec2(-1.0, -1.0) * texel).rgb, toLuma);\n"
+                                     "    float lumaNE = dot(texture(source, uv + vec2(1.0, -1.0) * texel).rgb, toLuma);\n"
+                                     "    float lumaSW = dot(texture(source, uv + vec2(-1.0, 1.0) * texel).rgb, toLuma);\n"
+                                     "    float lumaSE = dot(texture(source, uv + vec2(1.0, 1.0) * texel).rgb, toLuma);\n"
+                                     "    vec3 rgbM = texture(source, uv).rgb;\n"
+                                     "    float lumaM = dot(rgbM, toLuma);\n"
+                                     "    float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));\n"
+                                     "    float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));\n"
+                                     "    vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));\n"
+                                     "    float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * REDUCE_MUL, REDUCE_MIN);\n"
+                                     "    float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);\n"
+                                     "    dir = clamp(dir * rcpDirMin, vec2(-SPAN_MAX), vec2(SPAN_MAX)) * texel;\n"
+                                     "    vec3 rgbA = 0.5 * (texture(source, uv + dir * (1.0 / 3.0 - 0.5)).rgb +\n"
+                                     "                       texture(source, uv + dir * (2.0 / 3.0 - 0.5)).rgb);\n"
+                                     "    vec3 rgbB = rgbA * 0.5 + 0.25 * (texture(source, uv - dir * 0.5).rgb +\n"
+                                     "                                     texture(source, uv + dir * 0.5).rgb);\n"
+                                     "    float lumaB = dot(rgbB, toLuma);\n"
+                                     "    FragColor = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, 1.0);\n"
+                                     "}\0";
+
+    // bits of the fused pass' variant mask, same order as the feature list given to ShaderVariants
+    const std::uint32_t FUSED_BLOOM{1u << 0};
+    const std::uint32_t FUSED_TONE_MAPPING{1u << 1};
+    const std::uint32_t FUSED_COLOR_GRADING{1u << 2};
+    const std::uint32_t FUSED_VIGNETTE{1u << 3};
+
+    // uniforms set every frame
+    const ShaderName TARGET_SIZE{internShaderName("targetSize")};
+    const ShaderName THRESHOLD{internShaderName("threshold")};
+    const ShaderName DIRECTION{internShaderName("direction")};
+    const ShaderName SCENE_COLOR{internShaderName("sceneColor")};
+    const ShaderName BLOOM_TEXTURE{internShaderName("bloomTexture")};
+    const ShaderName BLOOM_INTENSITY{internShaderName("bloomIntensity")};
+    const ShaderName EXPOSURE{internShaderName("exposure")};
+    const ShaderName LIFT{internShaderName("lift")};
+    const ShaderName GAMMA{internShaderName("gamma")};
+    const ShaderName GAIN{internShaderName("gain")};
+    const ShaderName SATURATION{internShaderName("saturation")};
+    const ShaderName CONTRAST{internShaderName("contrast")};
+    const ShaderName VIGNETTE_STRENGTH{internShaderName("vignetteStrength")};
+    const ShaderName VIGNETTE_RADIUS{internShaderName("vignetteRadius")};
+
+    enum Pass {
+        BLOOM_PASS,
+        FUSED_PASS,
+        FXAA_PASS
+    };
+}
+
+PostChain::PostChain()
+        : m_fusedVariants(fullscreenVertexSource, fusedFragmentSource,
+                          {"BLOOM", "TONE_MAPPING", "COLOR_GRADING", "VIGNETTE"}, "POST_FUSED") {
+}
+
+bool PostChain::init(int width, int height, GpuResources &resources) {
+    m_resources = &resources;
+    m_prefilterProgram = compileProgram(fullscreenVertexSource, prefilterFragmentSource, "BLOOM_PREFILTER");
+    m_blurProgram = compileProgram(fullscreenVertexSource, blurFragmentSource, "BLOOM_BLUR");
+    m_fxaaProgram = compileProgram(fullscreenVertexSource, fxaaFragmentSource, "FXAA");
+    if (m_prefilterProgram == 0 || m_blurProgram == 0 || m_fxaaProgram == 0) {
+        return false;
+    }
+    m_prefilterReflection.reflect(m_prefilterProgram);
+    m_blurReflection.reflect(m_blurProgram);
+    m_fxaaReflection.reflect(m_fxaaProgram);
+
+    glGenVertexArrays(1, &m_emptyVao);
+    glGenQueries(6, &m_timerQueries[0][0]);
+
+    m_width = width;
+    m_height = height;
+    createTargets();
+    build(m_settings);
+    return true;
+}
+
+void PostChain::destroy() {
+    destroyTargets();
+    glDeleteProgram(m_prefilterProgram);
+    glDeleteProgram(m_blurProgram);
+    glDeleteProgram(m_fxaaProgram);
+    m_fusedVariants.destroy();
+    glDeleteVertexArrays(1, &m_emptyVao);
+    glDeleteQueries(6, &m_timerQueries[0][0]);
+}
+
+PostChain::Target PostChain::createTarget(GLenum internalFormat, int width, int height, bool withDepth) {
+    Target target;
+    target.width = width;
+    target.height = height;
+
+    target.textureHandle = m_resources->createTexture("post target");
+    target.texture = m_resources->texture(target.textureHandle);
+    glBindTexture(GL_TEXTURE_2D, target.texture);
+    const GLenum type = internalFormat == GL_RGBA8 ? GL_UNSIGNED_BYTE : GL_HALF_FLOAT;
+    glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internalFormat), width, height, 0, GL_RGBA, type, nullptr);
+    m_resources->setBytes(target.textureHandle, storageBytes(internalFormat, width, height));
+    // linear filtering does the bloom downsample / upsample for free
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &target.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
+    if (withDepth) {
+        target.depthHandle = m_resources->createRenderbuffer("post target depth");
+        target.depth = m_resources->renderbuffer(target.depthHandle);
+        glBindRenderbuffer(GL_RENDERBUFFER, target.depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        m_resources->setBytes(target.depthHandle, storageBytes(GL_DEPTH_COMPONENT24, width, height));
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target.depth);
+    }
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR::POSTPROCESS::FRAMEBUFFER_INCOMPLETE" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return target;
+}
+
+void PostChain::destroyTarget(Target &target) {
+    glDeleteFramebuffers(1, &target.fbo);
+    if (m_resources != nullptr) {
+        m_resources->release(target.textureHandle);
+        m_resources->release(target.depthHandle);
+    }
+    target = Target{};
+}
+
+void PostChain::createTargets() {
+    m_scene = createTarget(GL_RGBA16F, m_width, m_height, true);
+    m_ldr = createTarget(GL_RGBA8, m_width, m_height, false);
+    const int divisor = m_settings.bloomResolution == BloomResolution::Half ? 2 : 4;
+    for (Target &bloom : m_bloom) {
+        bloom = createTarget(GL_RGBA16F, std::max(1, m_width / divisor), std::max(1, m_height / divisor), false);
+    }
+}
+
+void PostChain::destroyTargets() {
+    destroyTarget(m_scene);
+    destroyTarget(m_ldr);
+    destroyTarget(m_bloom[0]);
+    destroyTarget(m_bloom[1]);
+}
+
+void PostChain::resize(int width, int height) {
+    if (width == m_width && height == m_height) {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+    destroyTargets();
+    createTargets();
+}
+
+void PostChain::build(const PostSettings &settings) {
+    const bool bloomResolutionChanged = settings.bloomResolution != m_settings.bloomResolution;
+    m_settings = settings;
+    if (bloomResolutionChanged && m_scene.fbo != 0) {
+        destroyTargets();
+        createTargets();
+    }
+
+    m_fusedMask = 0;
+    if (m_settings.bloom) {
+        m_fusedMask |= FUSED_BLOOM;
+    }
+    if (m_settings.toneMapping) {
+        m_fusedMask |= FUSED_TONE_MAPPING;
+    }
+    if (m_settings.colorGrading) {
+        m_fusedMask |= FUSED_COLOR_GRADING;
+    }
+    if (m_settings.vignette) {
+        m_fusedMask |= FUSED_VIGNETTE;
+    }
+    m_fusedProgram = m_fusedVariants.get(m_fusedMask);
+    m_fusedReflection = &m_fusedVariants.reflection(m_fusedMask);
+}
+
+void PostChain::readTimers() {
+    const unsigned slot = m_frame % 2;
+    const bool enabled[3]{m_settings.bloom, m_fusedMask != 0 || !m_settings.fxaa, m_settings.fxaa};
+    for (int pass = 0; pass < 3; ++pass) {
+        if (!enabled[pass]) {
+            m_passMs[pass] = 0.0;
+        }
+        if (!m_timerUsed[slot][pass]) {
+            continue;
+        }
+        GLint available = 0;
+        glGetQueryObjectiv(m_timerQueries[slot][pass], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            continue;
+        }
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(m_timerQueries[slot][pass], GL_QUERY_RESULT, &elapsed);
+        m_timerUsed[slot][pass] = false;
+        if (enabled[pass]) {
+            m_passMs[pass] = static_cast<double>(elapsed) / 1e6;
+        }
+    }
+}
+
+void PostChain::apply(GLuint outputFramebuffer, int outputWidth, int outputHeight) {
+    readTimers();
+    const unsigned slot = m_frame % 2;
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glBindVertexArray(m_emptyVao);
+
+    // ------------------ BLOOM ------------------
+    if (m_settings.bloom) {
+        glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[slot][BLOOM_PASS]);
+        m_timerUsed[slot][BLOOM_PASS] = true;
+        Target &first = m_bloom[0];
+        Target &second = m_bloom[1];
+
+        glBindFramebuffer(GL_FRAMEBUFFER, first.fbo);
+        glViewport(0, 0, first.width, first.height);
+        glUseProgram(m_prefilterProgram);
+        glBindTexture(GL_TEXTURE_2D, m_scene.texture);
+        glUniform2f(m_prefilterReflection.uniform(TARGET_SIZE), static_cast<float>(first.width), static_cast<float>(first.height));
+        glUniform1f(m_prefilterReflection.uniform(THRESHOLD), m_settings.bloomThreshold);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        glUseProgram(m_blurProgram);
+        const GLint directionLocation = m_blurReflection.uniform(DIRECTION);
+        glBindFramebuffer(GL_FRAMEBUFFER, second.fbo);
+        glBindTexture(GL_TEXTURE_2D, first.texture);
+        glUniform2f(directionLocation, 1.0f, 0.0f);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindFramebuffer(GL_FRAMEBUFFER, first.fbo);
+        glBindTexture(GL_TEXTURE_2D, second.texture);
+        glUniform2f(directionLocation, 0.0f, 1.0f);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+
+    // ------------------ FUSED PER PIXEL PASS ------------------
+    // with only FXAA enabled there's nothing to fuse, FXAA then reads the scene directly
+    const bool fusedPass = m_fusedMask != 0 || !m_settings.fxaa;
+    if (fusedPass && m_fusedProgram != 0) {
+        glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[slot][FUSED_PASS]);
+        m_timerUsed[slot][FUSED_PASS] = true;
+        if (m_settings.fxaa) {
+            glBindFramebuffer(GL_FRAMEBUFFER, m_ldr.fbo);
+            glViewport(0, 0, m_ldr.width, m_ldr.height);
+        } else {
+            glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+            glViewport(0, 0, outputWidth, outputHeight);
+        }
+        const float targetWidth = static_cast<float>(m_settings.fxaa ? m_ldr.width : outputWidth);
+        const float targetHeight = static_cast<float>(m_settings.fxaa ? m_ldr.height : outputHeight);
+
+        const ShaderReflection &fused = *m_fusedReflection;
+        glUseProgram(m_fusedProgram);
+        glUniform1i(fused.uniform(SCENE_COLOR), 0);
+        glUniform1i(fused.uniform(BLOOM_TEXTURE), 1);
+        glUniform2f(fused.uniform(TARGET_SIZE), targetWidth, targetHeight);
+        glUniform1f(fused.uniform(BLOOM_INTENSITY), m_settings.bloomIntensity);
+        glUniform1f(fused.uniform(EXPOSURE), m_settings.exposure);
+        glUniform3fv(fused.uniform(LIFT), 1, m_settings.lift);
+        glUniform3fv(fused.uniform(GAMMA), 1, m_settings.gamma);
+        glUniform3fv(fused.uniform(GAIN), 1, m_settings.gain);
+        glUniform1f(fused.uniform(SATURATION), m_settings.saturation);
+        glUniform1f(fused.uniform(CONTRAST), m_settings.contrast);
+        glUniform1f(fused.uniform(VIGNETTE_STRENGTH), m_settings.vignetteStrength);
+        glUniform1f(fused.uniform(VIGNETTE_RADIUS), m_settings.vignetteRadius);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, m_bloom[0].texture);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, m_scene.texture);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+
+    // ------------------ FXAA ------------------
+    if (m_settings.fxaa) {
+        glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[slot][FXAA_PASS]);
+        m_timerUsed[slot][FXAA_PASS] = true;
+        glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+        glViewport(0, 0, outputWidth, outputHeight);
+        glUseProgram(m_fxaaProgram);
+        glUniform2f(m_fxaaReflection.uniform(TARGET_SIZE), static_cast<float>(outputWidth), static_cast<float>(outputHeight));
+        glBindTexture(GL_TEXTURE_2D, fusedPass ? m_ldr.texture : m_scene.texture);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+
+    glBindVertexArray(0);
+    ++m_frame;
+}
+
+double PostChain::benchmark(int width, int height, int frames) {
+    const int oldWidth = m_width;
+    const int oldHeight = m_height;
+    resize(width, height);
+    Target output = createTarget(GL_RGBA8, width, height, false);
+
+    // a bright scene so the bloom threshold actually lets something through
+    glBindFramebuffer(GL_FRAMEBUFFER, m_scene.fbo);
+    glViewport(0, 0, width, height);
+    glClearColor(1.5f, 0.8f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // the passes time themselves with GL_TIME_ELAPSED, which can't nest, so use timestamps here
+    GLuint queries[2];
+    glGenQueries(2, queries);
+    glQueryCounter(queries[0], GL_TIMESTAMP);
+    for (int i = 0; i < frames; ++i) {
+        apply(output.fbo, width, height);
+    }
+    glQueryCounter(queries[1], GL_TIMESTAMP);
+
+    GLuint64 start = 0, end = 0;
+    glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &end);
+    glDeleteQueries(2, queries);
+
+    destroyTarget(output);
+    resize(oldWidth, oldHeight);
+    return static_cast<double>(end - start) / 1e6 / static_cast<double>(frames > 0 ? frames : 1);
+}
@@ -0,0 +1,122 @@
+#ifndef POSTPROCESS_H
+#define POSTPROCESS_H
+
+#include <cstdint>
+
+#include "../include/glad/glad.h"
+#include "gpu_resources.h"
+#include "shader.h"
+
+enum class BloomResolution {
+    Half,
+    Quarter
+};
+
+// every step of the chain can be switched on and off on its own
+struct PostSettings {
+    bool bloom{false};
+    BloomResolution bloomResolution{BloomResolution::Half};
+    float bloomThreshold{1.0f};
+    float bloomIntensity{0.6f};
+
+    bool toneMapping{false};
+    float exposure{1.0f};
+
+    bool colorGrading{false};
+    float lift[3]{0.0f, 0.0f, 0.0f};
+    float gamma[3]{1.0f, 1.0f, 1.0f};
+    float gain[3]{1.0f, 1.0f, 1.0f};
+    float saturation{1.1f};
+    float contrast{1.05f};
+
+    bool vignette{false};
+    float vignetteStrength{0.35f};
+    float vignetteRadius{0.6f};
+
+    bool fxaa{false};
+
+    bool anyEnabled() const { return bloom || toneMapping || colorGrading || vignette || fxaa; }
+};
+
+// post processing stack, runs on the HDR target the scene was rendered into:
+// 1. bloom: bright pass + separable blur at half or quarter resolution
+// 2. one fused pass: bloom composite, tone mapping, colour grading and vignette are all
+//    per pixel, so build() picks the shader variant with exactly the enabled ones compiled in
+// 3. FXAA, separate because it needs the neighbours of the finished LDR image
+class PostChain {
+public:
+    PostChain();
+
+    // the targets belong to resources, which has to outlive the chain
+    bool init(int width, int height, GpuResources &resources);
+    void destroy();
+    // recreates the targets, does nothing if the size didn't change
+    void resize(int width, int height);
+
+    // rebuilds the pass list for new settings, cheap enough to call whenever a toggle changes
+    void build(const PostSettings &settings);
+    const PostSettings &settings() const { return m_settings; }
+
+    // false when every step is off, the scene can then be drawn straight into the output
+    bool active() const { return m_settings.anyEnabled(); }
+    // the scene has to be rendered into this while the chain is active
+    GLuint sceneFramebuffer() const { return m_scene.fbo; }
+
+    // runs the chain on the scene target and writes the result into outputFramebuffer
+    void apply(GLuint outputFramebuffer, int outputWidth, int outputHeight);
+
+    // GPU time of the steps, from timer queries of an earlier frame
+    double bloomMs() const { return m_passMs[0]; }
+    double fusedMs() const { return m_passMs[1]; }
+    double fxaaMs() const { return m_passMs[2]; }
+
+    // renders the chain with the current settings `frames` times at width x height into an
+    // offscreen target and returns the average GPU time per frame in ms
+    double benchmark(int width, int height, int frames);
+
+private:
+    struct Target {
+        GLuint fbo{0};
+        GLuint texture{0};
+        GLuint depth{0};
+        GpuHandle textureHandle{GpuResources::NO_HANDLE};
+        GpuHandle depthHandle{GpuResources::NO_HANDLE};
+        int width{0};
+        int height{0};
+    };
+
+    Target createTarget(GLenum internalFormat, int width, int height, bool withDepth);
+    void destroyTarget(Target &target);
+    void createTargets();
+    void destroyTargets();
+    void readTimers();
+
+    GpuResources *m_resources{nullptr};
+    PostSettings m_settings;
+    int m_width{0};
+    int m_height{0};
+
+    Target m_scene;    // RGBA16F + depth, what the renderers draw into
+    Target m_bloom[2]; // RGBA16F ping pong at bloom resolution
+    Target m_ldr;      // RGBA8, output of the fused pass when FXAA runs after it
+
+    GLuint m_prefilterProgram{0};
+    GLuint m_blurProgram{0};
+    GLuint m_fxaaProgram{0};
+    ShaderReflection m_prefilterReflection;
+    ShaderReflection m_blurReflection;
+    ShaderReflection m_fxaaReflection;
+    ShaderVariants m_fusedVariants;
+    std::uint32_t m_fusedMask{0};
+    GLuint m_fusedProgram{0};
+    const ShaderReflection *m_fusedReflection{nullptr};
+    GLuint m_emptyVao{0};
+
+    // two frames of [bloom, fused, fxaa] queries
+    GLuint m_timerQueries[2][3]{};
+    bool m_timerUsed[2][3]{};
+    unsigned m_frame{0};
+    double m_passMs[3]{};
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include "profiler.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "gl_extensions.h"
+
+constinit Profiler profiler;
+
+std::size_t Profiler::addZone(const char *name) {
+    std::lock_guard<std::mutex> lock(m_zoneMutex);
+    const std::size_t count = m_zoneCount.load(std::memory_order_relaxed);
+    if (count == MAX_ZONES) {
+        std::cout << "ERROR::PROFILER::TOO_MANY_ZONES\n" << name << std::endl;
+        return MAX_ZONES - 1;
+    }
+    m_zoneNames[count] = name;
+    // the name has to be visible before the zone is
+    m_zoneCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+void Profiler::endFrame() {
+    m_frame.drawCalls = m_drawCalls.exchange(0, std::memory_order_relaxed);
+    m_frame.stateChanges = m_stateChanges.exchange(0, std::memory_order_relaxed);
+    m_frame.uploadedBytes = m_uploadedBytes.exchange(0, std::memory_order_relaxed);
+    m_frame.allocations = m_allocations.exchange(0, std::memory_order_relaxed);
+    m_frame.allocatedBytes = m_allocatedBytes.exchange(0, std::memory_order_relaxed);
+    m_frame.frees = m_frees.exchange(0, std::memory_order_relaxed);
+    const double msPerTick = 1000.0 / static_cast<double>(glfwGetTimerFrequency());
+    for (std::size_t i = 0; i < MAX_ZONES; ++i) {
+        m_frameZoneMs[i] = static_cast<double>(m_zoneTicks[i].exchange(0, std::memory_order_relaxed)) * msPerTick;
+    }
+}
+
+std::uint64_t pixelBytes(GLenum format, GLenum type) {
+    std::uint64_t components;
+    switch (format) {
+        case GL_RED:
+        case GL_RED_INTEGER:
+        case GL_DEPTH_COMPONENT:
+            components = 1;
+            break;
+        case GL_RG:
+        case GL_RG_INTEGER:
+            components = 2;
+            break;
+        case GL_RGB:
+        case GL_BGR:
+            components = 3;
+            break;
+        default:
+            components = 4;
+            break;
+    }
+    switch (type) {
+        case GL_UNSIGNED_BYTE:
+        case GL_BYTE:
+            return components;
+        case GL_UNSIGNED_SHORT:
+        case GL_SHORT:
+        case GL_HALF_FLOAT:
+            return components * 2;
+        case GL_UNSIGNED_INT:
+        case GL_INT:
+        case GL_FLOAT:
+            return components * 4;
+        default:
+            // packed types like GL_UNSIGNED_INT_24_8 hold a whole pixel
+            return 4;
+    }
+}
+
+// allocation stats: every operator new and delete of the program goes through these, the array
+// and nothrow forms forward here by default
+void *operator new(std::size_t size) {
+    profiler.countAllocation(size);
+    if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept {
+    if (pointer) {
+        profiler.countFree();
+    }
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    operator delete(pointer);
+}
+
+// glad calls through plain function pointers, so a counting wrapper can be swapped in per entry
+// point: COUNTED_GL defines the wrapper and a slot for the driver's function, INSTALL_GL swaps it in
+#define COUNTED_GL(name, count, params, args) \
+    decltype(glad_gl##name) real##name{nullptr}; \
+    void APIENTRY counted##name params { \
+        count; \
+        real##name args; \
+    }
+
+#define INSTALL_GL(name) \
+    if (glad_gl##name && glad_gl##name != counted##name) { \
+        real##name = glad_gl##name; \
+        glad_gl##name = counted##name; \
+    }
+
+namespace {
+    COUNTED_GL(DrawArrays, profiler.countDrawCall(),
+               (GLenum mode, GLint first, GLsizei count), (mode, first, count))
+    COUNTED_GL(DrawArraysInstanced, profiler.countDrawCall(),
+               (GLenum mode, GLint first, GLsizei count, GLsizei instances), (mode, first, count, instances))
+    COUNTED_GL(DrawElements, profiler.countDrawCall(),
+               (GLenum mode, GLsizei count, GLenum type, const void *indices), (mode, count, type, indices))
+    COUNTED_GL(DrawElementsInstanced, profiler.countDrawCall(),
+               (GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instances),
+               (mode, count, type, indices, instances))
+    COUNTED_GL(DrawElementsBaseVertex, profiler.countDrawCall(),
+               (GLenum mode, GLsizei count, GLenum type, const void *indices, GLint baseVertex),
+               (mode, count, type, indices, baseVertex))
+
+    COUNTED_GL(UseProgram, profiler.countStateChange(), (GLuint program), (program))
+    COUNTED_GL(BindVertexArray, profiler.countStateChange(), (GLuint array), (array))
+    COUNTED_GL(BindBuffer, profiler.countStateChange(), (GLenum target, GLuint buffer), (target, buffer))
+    COUNTED_GL(BindFramebuffer, profiler.countStateChange(), (GLenum target, GLuint framebuffer), (target, framebuffer))
+    COUNTED_GL(BindTexture, profiler.countStateChange(), (GLenum target, GLuint texture), (target, texture))
+    COUNTED_GL(ActiveTexture, profiler.countStateChange(), (GLenum texture), (texture))
+    COUNTED_GL(Enable, profiler.countStateChange(), (GLenum capability), (capability))
+    COUNTED_GL(Disable, profiler.countStateChange(), (GLenum capability), (capability))
+    COUNTED_GL(BlendFunc, profiler.countStateChange(), (GLenum source, GLenum destination), (source, destination))
+    COUNTED_GL(Viewport, profiler.countStateChange(),
+               (GLint x, GLint y, GLsizei width, GLsizei height), (x, y, width, height))
+    COUNTED_GL(ViewportArrayv, profiler.countStateChange(),
+               (GLuint first, GLsizei count, const GLfloat *v), (first, count, v))
+
+    COUNTED_GL(BufferData, if (data) profiler.countUpload(static_cast<std::uint64_t>(size)),
+               (GLenum target, GLsizeiptr size, const void *data, GLenum usage), (target, size, data, usage))
+    COUNTED_GL(BufferSubData, profiler.countUpload(static_cast<std::uint64_t>(size)),
+               (GLenum target, GLintptr offset, GLsizeiptr size, const void *data), (target, offset, size, data))
+    COUNTED_GL(TexImage2D,
+               if (pixels) profiler.countUpload(static_cast<std::uint64_t>(width) * static_cast<std::uint64_t>(height) * pixelBytes(format, type)),
+               (GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border,
+                GLenum format, GLenum type, const void *pixels),
+               (target, level, internalFormat, width, height, border, format, type, pixels))
+    COUNTED_GL(TexSubImage2D,
+               profiler.countUpload(static_cast<std::uint64_t>(width) * static_cast<std::uint64_t>(height) * pixelBytes(format, type)),
+               (GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type,
+                const void *pixels),
+               (target, level, x, y, width, height, format, type, pixels))
+    COUNTED_GL(TexImage3D,
+               if (pixels) profiler.countUpload(static_cast<std::uint64_t>(width) * static_cast<std::uint64_t>(height) *
+                                                static_cast<std::uint64_t>(depth) * pixelBytes(format, type)),
+               (GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth,
+                GLint border, GLenum format, GLenum type, const void *pixels),
+               (target, level, internalFormat, width, height, depth, border, format, type, pixels))
+    COUNTED_GL(TexSubImage3D,
+               profiler.countUpload(static_cast<std::uint64_t>(width) * static_cast<std::uint64_t>(height) *
+                                    static_cast<std::uint64_t>(depth) * pixelBytes(format, type)),
+               (GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height, GLsizei depth,
+                GLenum format, GLenum type, const void *pixels),
+               (target, level, x, y, z, width, height, depth, format, type, pixels))
+
+    // mapped ranges are written by the caller, count the whole range as uploaded
+    decltype(glad_glMapBufferRange) realMapBufferRange{nullptr};
+    void *APIENTRY countedMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+        if (access & GL_MAP_WRITE_BIT) {
+            profiler.countUpload(static_cast<std::uint64_t>(length));
+        }
+        return realMapBufferRange(target, offset, length, access);
+    }
+}
+
+void installGLCounters() {
+    INSTALL_GL(DrawArrays)
+    INSTALL_GL(DrawArraysInstanced)
+    INSTALL_GL(DrawElements)
+    INSTALL_GL(DrawElementsInstanced)
+    INSTALL_GL(DrawElementsBaseVertex)
+
+    INSTALL_GL(UseProgram)
+    INSTALL_GL(BindVertexArray)
+    INSTALL_GL(BindBuffer)
+    INSTALL_GL(BindFramebuffer)
+    INSTALL_GL(BindTexture)
+    INSTALL_GL(ActiveTexture)
+    INSTALL_GL(Enable)
+    INSTALL_GL(Disable)
+    INSTALL_GL(BlendFunc)
+    INSTALL_GL(Viewport)
+    INSTALL_GL(ViewportArrayv)
+
+    INSTALL_GL(BufferData)
+    INSTALL_GL(BufferSubData)
+    INSTALL_GL(TexImage2D)
+    INSTALL_GL(TexSubImage2D)
+    INSTALL_GL(TexImage3D)
+    INSTALL_GL(TexSubImage3D)
+    INSTALL_GL(MapBufferRange)
+}
+
+#undef COUNTED_GL
+#undef INSTALL_GL
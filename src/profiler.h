@@ -0,0 +1,99 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "../include/glad/glad.h"
+#include "GLFW/glfw3.h"
+
+// totals of one frame, copied out of the live counters by Profiler::endFrame()
+struct PerfSnapshot {
+    std::uint64_t drawCalls{0};
+    std::uint64_t stateChanges{0};
+    std::uint64_t uploadedBytes{0};
+    std::uint64_t allocations{0};
+    std::uint64_t allocatedBytes{0};
+    std::uint64_t frees{0};
+};
+
+// frame counters and CPU zone timings
+// - everything is a relaxed atomic, so the render thread, job workers and the allocation
+//   hooks can all add to it without locks, the HUD reads it once per frame
+// - draw calls, state changes and uploads are counted by wrappers around glad's entry points,
+//   see installGLCounters(), so no renderer has to report them itself
+class Profiler {
+public:
+    static constexpr std::size_t MAX_ZONES{16};
+
+    // registers a named CPU zone and returns its id, name has to outlive the profiler
+    // takes a lock, so call it once at setup or from a function local static, not per frame
+    std::size_t addZone(const char *name);
+    // ticks of glfwGetTimerValue
+    void addZoneTime(std::size_t zone, std::uint64_t ticks) {
+        m_zoneTicks[zone].fetch_add(ticks, std::memory_order_relaxed);
+    }
+
+    void countDrawCall() { m_drawCalls.fetch_add(1, std::memory_order_relaxed); }
+    void countStateChange() { m_stateChanges.fetch_add(1, std::memory_order_relaxed); }
+    void countUpload(std::uint64_t bytes) { m_uploadedBytes.fetch_add(bytes, std::memory_order_relaxed); }
+    void countAllocation(std::uint64_t bytes) {
+        m_allocations.fetch_add(1, std::memory_order_relaxed);
+        m_allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    void countFree() { m_frees.fetch_add(1, std::memory_order_relaxed); }
+
+    // moves the live counters into frame() and starts counting the next frame
+    void endFrame();
+
+    const PerfSnapshot &frame() const { return m_frame; }
+    std::size_t zoneCount() const { return m_zoneCount.load(std::memory_order_acquire); }
+    const char *zoneName(std::size_t zone) const { return m_zoneNames[zone]; }
+    // CPU time of the zone in the last frame, summed over all threads
+    double zoneMs(std::size_t zone) const { return m_frameZoneMs[zone]; }
+
+private:
+    std::atomic<std::uint64_t> m_drawCalls{0};
+    std::atomic<std::uint64_t> m_stateChanges{0};
+    std::atomic<std::uint64_t> m_uploadedBytes{0};
+    std::atomic<std::uint64_t> m_allocations{0};
+    std::atomic<std::uint64_t> m_allocatedBytes{0};
+    std::atomic<std::uint64_t> m_frees{0};
+
+    std::mutex m_zoneMutex;
+    std::atomic<std::size_t> m_zoneCount{0};
+    std::array<const char *, MAX_ZONES> m_zoneNames{};
+    std::array<std::atomic<std::uint64_t>, MAX_ZONES> m_zoneTicks{};
+
+    PerfSnapshot m_frame;
+    std::array<double, MAX_ZONES> m_frameZoneMs{};
+};
+
+// the one profiler of the process, the GL and allocation hooks can't be handed an instance
+extern Profiler profiler;
+
+// adds the time until it goes out of scope to a CPU zone
+// reads glfw's timer, which is just rdtsc when glfw was initialized with GLFW_TSC_TIMER
+class CpuZone {
+public:
+    explicit CpuZone(std::size_t zone) : m_zone(zone), m_start(glfwGetTimerValue()) {}
+    ~CpuZone() { profiler.addZoneTime(m_zone, glfwGetTimerValue() - m_start); }
+    CpuZone(const CpuZone &) = delete;
+    CpuZone &operator=(const CpuZone &) = delete;
+
+private:
+    std::size_t m_zone;
+    std::uint64_t m_start;
+};
+
+// bytes of one pixel of a client side texture upload
+std::uint64_t pixelBytes(GLenum format, GLenum type);
+
+// swaps glad's draw, bind, state and upload function pointers for counting wrappers,
+// call once right after gladLoadGLLoader
+void installGLCounters();
+
+#endif
@@ -0,0 +1,172 @@
+#include "render_farm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <thread>
+
+#include "../include/glad/glad.h" // always link glad before glfw
+#include "GLFW/glfw3.h"
+
+#include "deferred.h"
+#include "frame_readback.h"
+#include "gpu_resources.h"
+#include "uniform_blocks.h"
+#include "uniform_stream.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "../glfw/deps/stb_image_write.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // body of one worker thread, renders jobs until the queue is empty
+    void renderWorker(unsigned worker, GLFWwindow *window, const std::vector<RenderJob> &jobs, std::atomic<std::size_t> &next,
+                      std::vector<RenderJobTiming> &timings, JobSystem &jobSystem, const RenderFarmSceneBuilder &buildScene) {
+        glfwMakeContextCurrent(window);
+
+        Scene scene;
+        GLuint forwardProgram{0};
+        if (!buildScene(scene, forwardProgram)) {
+            std::cout << "ERROR::RENDER_FARM::SCENE_NOT_BUILT\nworker " << worker << std::endl;
+            glfwMakeContextCurrent(nullptr);
+            return;
+        }
+        // the worker's context doesn't share objects, so it gets its own registry
+        GpuResources resources;
+        UniformStream uniforms;
+        uniforms.init(resources);
+        DeferredRenderer deferred;
+        const bool deferredReady = deferred.init(jobs.front().width, jobs.front().height, jobSystem, uniforms, resources);
+        FrameReadback readback;
+        if (!readback.init(jobs.front().width, jobs.front().height, resources)) {
+            deferred.destroy();
+            uniforms.destroy();
+            resources.destroy();
+            glfwMakeContextCurrent(nullptr);
+            return;
+        }
+        std::vector<unsigned char> pixels;
+
+        // jobs captured but not read back yet, oldest first; the next jobs render while they finish
+        std::deque<std::size_t> inFlight;
+        auto finishOldest = [&]() {
+            const RenderJob &job = jobs[inFlight.front()];
+            RenderJobTiming &timing = timings[inFlight.front()];
+            inFlight.pop_front();
+
+            auto start = Clock::now();
+            readback.read(pixels, true);
+            // GL's rows start at the bottom, PNG's at the top
+            const std::size_t rowBytes = static_cast<std::size_t>(job.width) * 4;
+            for (int y = 0; y < job.height / 2; ++y) {
+                std::swap_ranges(pixels.begin() + static_cast<std::ptrdiff_t>(rowBytes * static_cast<std::size_t>(y)),
+                                 pixels.begin() + static_cast<std::ptrdiff_t>(rowBytes * static_cast<std::size_t>(y + 1)),
+                                 pixels.begin() + static_cast<std::ptrdiff_t>(rowBytes * static_cast<std::size_t>(job.height - 1 - y)));
+            }
+            timing.readbackMs = msSince(start);
+
+            start = Clock::now();
+            timing.written = stbi_write_png(job.outputPath.c_str(), job.width, job.height, 4, pixels.data(),
+                                            static_cast<int>(rowBytes)) != 0;
+            if (!timing.written) {
+                std::cout << "ERROR::RENDER_FARM::IMAGE_NOT_WRITTEN\n" << job.outputPath << std::endl;
+            }
+            timing.writeMs = msSince(start);
+        };
+
+        for (std::size_t i = next.fetch_add(1, std::memory_order_relaxed); i < jobs.size();
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            const RenderJob &job = jobs[i];
+            timings[i].worker = worker;
+
+            // a full ring would drop a frame, another size drops all of them
+            if (job.width != readback.width() || job.height != readback.height()) {
+                while (!inFlight.empty()) {
+                    finishOldest();
+                }
+                readback.resize(job.width, job.height);
+            } else if (readback.pending() == FrameReadback::FRAMES_IN_FLIGHT) {
+                finishOldest();
+            }
+
+            const auto start = Clock::now();
+            glBindFramebuffer(GL_FRAMEBUFFER, readback.framebuffer());
+            glViewport(0, 0, job.width, job.height);
+            glClearColor(0.2f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            std::memcpy(scene.view, job.view, sizeof(mat4x4));
+            std::memcpy(scene.projection, job.projection, sizeof(mat4x4));
+            if (job.renderPath == RenderPath::Deferred && deferredReady) {
+                uniforms.write(FRAME_BLOCK_BINDING, FrameBlock{{static_cast<float>(job.width), static_cast<float>(job.height)}, 0.0f, 0.0f});
+                deferred.render(scene, job.width, job.height, readback.framebuffer());
+            } else {
+                glUseProgram(forwardProgram);
+                for (const Mesh &mesh : scene.meshes) {
+                    glBindVertexArray(mesh.vao);
+                    glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, nullptr);
+                }
+                glBindVertexArray(0);
+            }
+            readback.capture();
+            uniforms.endFrame();
+            resources.endFrame();
+            inFlight.push_back(i);
+            timings[i].renderMs = msSince(start);
+        }
+        while (!inFlight.empty()) {
+            finishOldest();
+        }
+
+        readback.destroy();
+        deferred.destroy();
+        uniforms.destroy();
+        resources.destroy();
+        glfwMakeContextCurrent(nullptr);
+    }
+}
+
+std::vector<RenderJobTiming> runRenderFarm(const std::vector<RenderJob> &jobs, unsigned workerCount,
+                                           JobSystem &jobSystem, const RenderFarmSceneBuilder &buildScene) {
+    if (jobs.empty()) {
+        return {};
+    }
+    workerCount = std::clamp(workerCount, 1u, static_cast<unsigned>(jobs.size()));
+
+    // the workers render into framebuffer objects, the windows only carry the contexts
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    std::vector<GLFWwindow *> windows;
+    for (unsigned i = 0; i < workerCount; ++i) {
+        GLFWwindow *window = glfwCreateWindow(64, 64, "render farm", nullptr, nullptr);
+        if (window == nullptr) {
+            std::cout << "ERROR::RENDER_FARM::CONTEXT_NOT_CREATED\nworker " << i << std::endl;
+            break;
+        }
+        windows.push_back(window);
+    }
+    if (windows.empty()) {
+        return {};
+    }
+
+    std::vector<RenderJobTiming> timings(jobs.size());
+    std::atomic<std::size_t> next{0};
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < windows.size(); ++i) {
+        threads.emplace_back(renderWorker, i, windows[i], std::cref(jobs), std::ref(next), std::ref(timings),
+                             std::ref(jobSystem), std::cref(buildScene));
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    for (GLFWwindow *window : windows) {
+        glfwDestroyWindow(window);
+    }
+    return timings;
+}
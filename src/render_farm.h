@@ -0,0 +1,55 @@
+#ifndef RENDER_FARM_H
+#define RENDER_FARM_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "jobs.h"
+#include "scene.h"
+
+// one image for the render farm: the scene seen through a camera, written as a PNG
+struct RenderJob {
+    std::string outputPath;
+    int width{800};
+    int height{600};
+    RenderPath renderPath{RenderPath::Deferred};
+    mat4x4 view;
+    mat4x4 projection;
+};
+
+// where the time of one job went, wall clock on the worker that rendered it
+struct RenderJobTiming {
+    unsigned worker{0};
+    // issuing the draws and the readback
+    double renderMs{0.0};
+    // waiting for the frame to finish and copying it out
+    double readbackMs{0.0};
+    double writeMs{0.0};
+    bool written{false};
+};
+
+// builds a worker's own copy of the scene and the program for RenderPath::Forward in the worker's
+// context, which is current when it's called; the VAOs of the meshes have to be made there too,
+// contexts of different workers share nothing
+// everything it creates goes away with the worker's context, false if it couldn't build them
+using RenderFarmSceneBuilder = std::function<bool(Scene &scene, GLuint &forwardProgram)>;
+
+// batch rendering on CPU-only machines: renders the jobs on several OSMesa or surfaceless EGL
+// contexts in parallel
+// - one hidden window per worker, made on the calling thread because glfw windows can only be
+//   made there, each worker thread makes its window's context current and takes jobs off one
+//   shared queue until it's empty, so the workers only meet at an atomic index
+// - every worker has its own deferred renderer and scene, the CPU side work of the deferred
+//   renderer goes to the shared job system
+// - images come back through a FrameReadback, a worker renders the next jobs while the earlier
+//   ones are still being read back
+// - glfw has to be initialized on the null platform with the OSMesa or EGL context hints set and
+//   glad loaded; glad's function pointers are the same for every context of the same driver
+// - llvmpipe also splits each context's rasterization over all cores, LP_NUM_THREADS=1 set before
+//   the first context was made keeps the workers from fighting over them
+// returns the timing of every job in job order, empty if not a single worker could be started
+std::vector<RenderJobTiming> runRenderFarm(const std::vector<RenderJob> &jobs, unsigned workerCount,
+                                           JobSystem &jobSystem, const RenderFarmSceneBuilder &buildScene);
+
+#endif
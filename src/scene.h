@@ -0,0 +1,70 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <vector>
+
+#include "../include/glad/glad.h"
+#include "../glfw/deps/linmath.h"
+
+#include "gpu_resources.h"
+
+// which pipeline a scene gets drawn with, picked per scene
+enum class RenderPath {
+    Forward,
+    Deferred
+};
+
+// indexed geometry that already lives on the GPU, positions at attribute location 0
+struct Mesh {
+    GLuint vao{0};
+    // the buffers the VAO reads, objects like these are shared between contexts but VAOs aren't,
+    // other contexts build their own VAO from them, see MultiView
+    GLuint vertexBuffer{0};
+    GLuint indexBuffer{0};
+    GLsizei indexCount{0};
+    float albedo[3]{1.0f, 0.5f, 0.2f};
+    float roughness{0.5f};
+    float metallic{0.0f};
+    // world space bounding box, used for culling
+    float boundsMin[3]{-1.0f, -1.0f, -1.0f};
+    float boundsMax[3]{1.0f, 1.0f, 1.0f};
+    // static meshes never move, cached shadow cascades only contain these
+    bool isStatic{true};
+    // attribute 1 holds per vertex normals, the deferred path shades with them instead of face normals
+    bool vertexNormals{false};
+    // closed and wound counter-clockwise, the deferred path skips its back faces
+    bool cullBackFaces{false};
+    // handles of vao, vertexBuffer and indexBuffer when a GpuResources owns them, the names are
+    // stale once these read 0
+    GpuHandle handles[3]{};
+};
+
+// world space point light, only lights the surfaces inside its radius
+struct PointLight {
+    float position[3]{0.0f, 0.0f, 0.0f};
+    float radius{1.0f};
+    float color[3]{1.0f, 1.0f, 1.0f};
+    float intensity{1.0f};
+};
+
+// infinitely far away light, e.g. the sun
+struct DirectionalLight {
+    // direction the light travels in, world space
+    float direction[3]{-0.3f, -0.5f, -1.0f};
+    float color[3]{1.0f, 1.0f, 1.0f};
+    float intensity{1.0f};
+};
+
+struct Scene {
+    RenderPath renderPath{RenderPath::Forward};
+    std::vector<Mesh> meshes;
+    std::vector<PointLight> lights;
+    DirectionalLight sun;
+    // bump whenever a static mesh is added, removed or changed, invalidates cached shadows
+    unsigned staticVersion{0};
+    // camera, both default to identity so the scene is drawn straight in NDC
+    mat4x4 view;
+    mat4x4 projection;
+};
+
+#endif
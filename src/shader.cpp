@@ -0,0 +1,259 @@
+#include "shader.h"
+
+#include <iostream>
+
+#include "gl_extensions.h"
+
+const char *const fullscreenVertexSource = "#version 330 core\n"
+                                           "void main()\n"
+                                           "{\n"
+                                           "    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+                                           "    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);\n"
+                                           "}\0";
+
+GLuint compileShader(GLenum type, const char *source, const char *name) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    // check if the shader compiled successfully
+    int success;
+    char infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        const char *stage = type == GL_VERTEX_SHADER ? "VERTEX" : type == GL_GEOMETRY_SHADER ? "GEOMETRY" : "FRAGMENT";
+        std::cout << "ERROR::SHADER::" << name << "::" << stage << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+GLuint compileProgram(const char *vertexSource, const char *fragmentSource, const char *name) {
+    return compileProgram(vertexSource, nullptr, fragmentSource, name);
+}
+
+GLuint compileProgram(const char *vertexSource, const char *geometrySource, const char *fragmentSource, const char *name) {
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource, name);
+    GLuint geometryShader = geometrySource != nullptr ? compileShader(GL_GEOMETRY_SHADER, geometrySource, name) : 0;
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource, name);
+    if (vertexShader == 0 || fragmentShader == 0 || (geometrySource != nullptr && geometryShader == 0)) {
+        glDeleteShader(vertexShader);
+        glDeleteShader(geometryShader);
+        glDeleteShader(fragmentShader);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    if (geometryShader != 0) {
+        glAttachShader(program, geometryShader);
+    }
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    // the program keeps the compiled binary, the shader objects are not needed anymore
+    glDeleteShader(vertexShader);
+    glDeleteShader(geometryShader);
+    glDeleteShader(fragmentShader);
+
+    // check if the program linked successfully
+    int success;
+    char infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cout << "ERROR::SHADER::" << name << "::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+std::string addDefines(const char *source, const std::vector<std::string> &defines) {
+    std::string result(source);
+    if (defines.empty()) {
+        return result;
+    }
+
+    // #version has to stay the first line, so the defines go right after it
+    std::string block;
+    for (const std::string &define : defines) {
+        block += "#define " + define + "\n";
+    }
+    std::size_t lineEnd = result.find('\n');
+    std::size_t insertAt = result.compare(0, 8, "#version") == 0 && lineEnd != std::string::npos ? lineEnd + 1 : 0;
+    result.insert(insertAt, block);
+    return result;
+}
+
+ShaderVariants::ShaderVariants(const char *vertexSource, const char *fragmentSource, std::vector<std::string> features, const char *name,
+                               void (*prepare)(GLuint program))
+        : m_vertexSource(vertexSource), m_fragmentSource(fragmentSource), m_features(std::move(features)), m_name(name),
+          m_prepare(prepare) {
+}
+
+GLuint ShaderVariants::get(std::uint32_t mask) {
+    return variant(mask).program;
+}
+
+const ShaderReflection &ShaderVariants::reflection(std::uint32_t mask) {
+    return variant(mask).reflection;
+}
+
+ShaderVariants::Variant &ShaderVariants::variant(std::uint32_t mask) {
+    auto found = m_programs.find(mask);
+    if (found != m_programs.end()) {
+        return found->second;
+    }
+
+    std::vector<std::string> defines;
+    for (std::size_t i = 0; i < m_features.size(); ++i) {
+        if (mask & (1u << i)) {
+            defines.push_back(m_features[i]);
+        }
+    }
+    std::string vertexSource = addDefines(m_vertexSource, defines);
+    std::string fragmentSource = addDefines(m_fragmentSource, defines);
+    std::string name = m_name + "::VARIANT_" + std::to_string(mask);
+
+    // failures are cached too, so a broken variant doesn't get recompiled every frame
+    Variant &variant = m_programs[mask];
+    variant.program = compileProgram(vertexSource.c_str(), fragmentSource.c_str(), name.c_str());
+    if (variant.program != 0) {
+        if (m_prepare != nullptr) {
+            m_prepare(variant.program);
+        }
+        variant.reflection.reflect(variant.program);
+    }
+    return variant;
+}
+
+void ShaderVariants::destroy() {
+    for (auto &[mask, variant] : m_programs) {
+        glDeleteProgram(variant.program);
+    }
+    m_programs.clear();
+}
+
+namespace {
+    // GL_COMPLETION_STATUS_KHR, the same value for the ARB extension
+    const GLenum COMPLETION_STATUS{0x91B1};
+
+    bool parallelCompileSupported() {
+        static const bool supported =
+                hasGLExtension("GL_KHR_parallel_shader_compile") || hasGLExtension("GL_ARB_parallel_shader_compile");
+        return supported;
+    }
+}
+
+bool HotProgram::load(FileWatcher &watcher, const std::string &vertexPath, const std::string &fragmentPath, const char *name) {
+    m_name = name;
+    // both are watched even if one is missing, so fixing them on disk still starts a build
+    const bool vertexLoaded = watcher.watch(vertexPath, [this](std::string &&source) {
+        m_vertexSource = std::move(source);
+        m_changed = true;
+    });
+    const bool fragmentLoaded = watcher.watch(fragmentPath, [this](std::string &&source) {
+        m_fragmentSource = std::move(source);
+        m_changed = true;
+    });
+    if (!vertexLoaded || !fragmentLoaded) {
+        // the one that was read waits for the other, the next change to either builds both
+        m_changed = false;
+        return false;
+    }
+
+    // the first version is needed before anything can be drawn, no point in waiting a frame
+    startBuild();
+    finishBuild();
+    return m_program != 0;
+}
+
+void HotProgram::update() {
+    if (m_pending != 0) {
+        ++m_pendingFrames;
+        if (!buildFinished()) {
+            return;
+        }
+        finishBuild();
+    }
+    // one build at a time, a change during a build starts the next one once it's done
+    if (m_changed) {
+        startBuild();
+    }
+}
+
+void HotProgram::destroy() {
+    glDeleteProgram(m_program);
+    glDeleteProgram(m_pending);
+    glDeleteShader(m_pendingShaders[0]);
+    glDeleteShader(m_pendingShaders[1]);
+    m_program = m_pending = 0;
+    m_pendingShaders[0] = m_pendingShaders[1] = 0;
+}
+
+void HotProgram::startBuild() {
+    m_changed = false;
+    m_pendingFrames = 0;
+    const char *sources[2]{m_vertexSource.c_str(), m_fragmentSource.c_str()};
+    const GLenum types[2]{GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+    m_pending = glCreateProgram();
+    for (int i = 0; i < 2; ++i) {
+        m_pendingShaders[i] = glCreateShader(types[i]);
+        glShaderSource(m_pendingShaders[i], 1, &sources[i], nullptr);
+        glCompileShader(m_pendingShaders[i]);
+        glAttachShader(m_pending, m_pendingShaders[i]);
+    }
+    // no status checks in between, any of them would wait for the compile
+    glLinkProgram(m_pending);
+}
+
+bool HotProgram::buildFinished() const {
+    if (parallelCompileSupported()) {
+        GLint done = GL_FALSE;
+        glGetProgramiv(m_pending, COMPLETION_STATUS, &done);
+        return done == GL_TRUE;
+    }
+    return m_pendingFrames > 0;
+}
+
+void HotProgram::finishBuild() {
+    int success;
+    char infoLog[512];
+    bool built = true;
+    for (int i = 0; i < 2; ++i) {
+        glGetShaderiv(m_pendingShaders[i], GL_COMPILE_STATUS, &success);
+        if (!success) {
+            glGetShaderInfoLog(m_pendingShaders[i], 512, nullptr, infoLog);
+            const char *stage = i == 0 ? "VERTEX" : "FRAGMENT";
+            std::cout << "ERROR::SHADER::" << m_name << "::" << stage << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+            built = false;
+        }
+        glDeleteShader(m_pendingShaders[i]);
+        m_pendingShaders[i] = 0;
+    }
+    if (built) {
+        glGetProgramiv(m_pending, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(m_pending, 512, nullptr, infoLog);
+            std::cout << "ERROR::SHADER::" << m_name << "::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+            built = false;
+        }
+    }
+
+    if (built) {
+        if (m_program != 0) {
+            std::cout << "Reloaded " << m_name << " shaders" << std::endl;
+        }
+        glDeleteProgram(m_program);
+        m_program = m_pending;
+        m_reflection.reflect(m_program);
+    } else {
+        glDeleteProgram(m_pending);
+    }
+    m_pending = 0;
+}
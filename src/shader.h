@@ -0,0 +1,100 @@
+#ifndef SHADER_H
+#define SHADER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/glad/glad.h"
+#include "file_watcher.h"
+#include "shader_reflection.h"
+
+// vertex shader for one triangle covering the whole target, draw 3 vertices with any VAO bound
+extern const char *const fullscreenVertexSource;
+
+// compile a single shader stage, prints the info log and returns 0 on failure
+GLuint compileShader(GLenum type, const char *source, const char *name);
+
+// compile and link a vertex + fragment shader pair into a program, returns 0 on failure
+// the shader objects are deleted once linked, only the program is kept
+GLuint compileProgram(const char *vertexSource, const char *fragmentSource, const char *name);
+// same with a geometry shader in between, geometrySource may be null
+GLuint compileProgram(const char *vertexSource, const char *geometrySource, const char *fragmentSource, const char *name);
+
+// copy of source with a "#define <name>" line per entry inserted right after the #version line
+std::string addDefines(const char *source, const std::vector<std::string> &defines);
+
+// shader permutations: one source pair with optional features switched on and off by #defines
+// every combination is compiled the first time it's asked for and kept until destroy(), together
+// with its reflection
+class ShaderVariants {
+public:
+    // features[i] is the #define that bit i of a variant mask turns on, prepare is called on every
+    // variant once it linked, e.g. bindUniformBlocks
+    ShaderVariants(const char *vertexSource, const char *fragmentSource, std::vector<std::string> features, const char *name,
+                   void (*prepare)(GLuint program) = nullptr);
+
+    // program with the features of the mask, 0 if it failed to build
+    GLuint get(std::uint32_t mask);
+    // uniform locations of the variant, builds it like get(); empty if it failed to build
+    // the reference stays valid until destroy()
+    const ShaderReflection &reflection(std::uint32_t mask);
+    void destroy();
+
+private:
+    struct Variant {
+        GLuint program{0};
+        ShaderReflection reflection;
+    };
+
+    Variant &variant(std::uint32_t mask);
+
+    const char *m_vertexSource;
+    const char *m_fragmentSource;
+    std::vector<std::string> m_features;
+    std::string m_name;
+    void (*m_prepare)(GLuint program);
+    std::unordered_map<std::uint32_t, Variant> m_programs;
+};
+
+// program built from a vertex and a fragment shader file, rebuilt whenever one of them changes
+// - a change only starts compiling and linking the new version, program() keeps returning the old
+//   one until the new one linked, a broken edit prints its log and the old version stays
+// - with GL_KHR/ARB_parallel_shader_compile update() polls the driver's compile threads and never
+//   waits, without it the result is picked up one frame after the compile was started, which gives
+//   drivers that compile lazily a frame to get it done
+// the watcher calls back into the object, so it can't be moved once loaded
+class HotProgram {
+public:
+    // builds the first version right away, false if it didn't build; the files stay watched
+    // either way, so a missing or broken one is picked up once it's fixed
+    bool load(FileWatcher &watcher, const std::string &vertexPath, const std::string &fragmentPath, const char *name);
+    // starts a rebuild after a change and swaps in finished ones, once per frame on the GL thread
+    void update();
+    void destroy();
+
+    // the newest version that built, 0 if none did yet
+    GLuint program() const { return m_program; }
+    // of program(), swapped together with it
+    const ShaderReflection &reflection() const { return m_reflection; }
+
+private:
+    void startBuild();
+    bool buildFinished() const;
+    // keeps the pending program if it built, deletes it otherwise
+    void finishBuild();
+
+    std::string m_name;
+    std::string m_vertexSource;
+    std::string m_fragmentSource;
+    bool m_changed{false};
+
+    GLuint m_program{0};
+    ShaderReflection m_reflection;
+    GLuint m_pending{0};
+    GLuint m_pendingShaders[2]{};
+    unsigned m_pendingFrames{0};
+};
+
+#endif
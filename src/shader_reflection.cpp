@@ -0,0 +1,120 @@
+#include "shader_reflection.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace {
+    const ShaderName EMPTY_SLOT{0xffffffffu};
+}
+
+ShaderName internShaderName(std::string_view name) {
+    // render farm workers link programs on their own threads
+    static std::mutex mutex;
+    static std::unordered_map<std::string, ShaderName> names;
+    std::lock_guard lock(mutex);
+    const auto [found, inserted] = names.try_emplace(std::string(name), static_cast<ShaderName>(names.size()));
+    return found->second;
+}
+
+void ShaderReflection::reflect(GLuint program) {
+    GLint count = 0;
+    GLint maxLength = 0;
+    std::vector<std::pair<ShaderName, GLint>> entries;
+    std::vector<GLchar> name;
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    name.resize(static_cast<std::size_t>(std::max(maxLength, 1)));
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, static_cast<GLuint>(i), maxLength, &length, &size, &type, name.data());
+        const GLint location = glGetUniformLocation(program, name.data());
+        if (location < 0) {
+            continue;
+        }
+        std::string_view full(name.data(), static_cast<std::size_t>(length));
+        entries.emplace_back(internShaderName(full), location);
+        // arrays are reported as "name[0]"
+        if (full.size() > 3 && full.substr(full.size() - 3) == "[0]") {
+            entries.emplace_back(internShaderName(full.substr(0, full.size() - 3)), location);
+        }
+    }
+    m_uniforms.build(entries);
+
+    entries.clear();
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+    name.resize(static_cast<std::size_t>(std::max(maxLength, 1)));
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveAttrib(program, static_cast<GLuint>(i), maxLength, &length, &size, &type, name.data());
+        const GLint location = glGetAttribLocation(program, name.data());
+        // built-ins like gl_VertexID are active too but have no location
+        if (location >= 0) {
+            entries.emplace_back(internShaderName(std::string_view(name.data(), static_cast<std::size_t>(length))), location);
+        }
+    }
+    m_attributes.build(entries);
+
+    entries.clear();
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+    name.resize(static_cast<std::size_t>(std::max(maxLength, 1)));
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint binding = 0;
+        glGetActiveUniformBlockName(program, static_cast<GLuint>(i), maxLength, &length, name.data());
+        glGetActiveUniformBlockiv(program, static_cast<GLuint>(i), GL_UNIFORM_BLOCK_BINDING, &binding);
+        entries.emplace_back(internShaderName(std::string_view(name.data(), static_cast<std::size_t>(length))), binding);
+    }
+    m_blocks.build(entries);
+}
+
+void ShaderReflection::PerfectHash::build(const std::vector<std::pair<ShaderName, GLint>> &entries) {
+    count = entries.size();
+    keys.clear();
+    values.clear();
+    multiplier = 0;
+    shift = 31;
+    if (entries.empty()) {
+        return;
+    }
+
+    // at most half full to start with, a multiplier without collisions is then quick to find;
+    // the candidates come from a fixed sequence, so the same program always gets the same table
+    unsigned bits = 1;
+    while ((std::size_t{1} << bits) < entries.size() * 2) {
+        ++bits;
+    }
+    std::uint32_t candidate = 0x9e3779b9u;
+    for (;; ++bits) {
+        const std::size_t size = std::size_t{1} << bits;
+        for (int attempt = 0; attempt < 256; ++attempt) {
+            candidate = candidate * 1664525u + 1013904223u;
+            const std::uint32_t tried = candidate | 1u;
+            keys.assign(size, EMPTY_SLOT);
+            values.assign(size, -1);
+            bool collided = false;
+            for (const auto &[key, value] : entries) {
+                const std::size_t slot = static_cast<std::uint32_t>(key * tried) >> (32 - bits);
+                if (keys[slot] != EMPTY_SLOT && keys[slot] != key) {
+                    collided = true;
+                    break;
+                }
+                keys[slot] = key;
+                values[slot] = value;
+            }
+            if (!collided) {
+                multiplier = tried;
+                shift = 32 - bits;
+                return;
+            }
+        }
+    }
+}
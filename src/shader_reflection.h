@@ -0,0 +1,58 @@
+#ifndef SHADER_REFLECTION_H
+#define SHADER_REFLECTION_H
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../include/glad/glad.h"
+
+// uniform, attribute and uniform block names as small integers, the same name always gets the
+// same id; meant for namespace scope constants, interning takes a lock and hashes the string
+using ShaderName = std::uint32_t;
+ShaderName internShaderName(std::string_view name);
+
+// what a linked program has active, read once with glGetActiveUniform / Attrib / UniformBlock
+// - every name is interned and goes into a perfect hash table per kind, a lookup is a multiply,
+//   a shift and one compare instead of glGetUniformLocation's string search in the driver
+// - arrays are found by their plain name as well as by "name[0]"
+// - uniforms inside blocks have no location and are left out, their block is listed instead
+class ShaderReflection {
+public:
+    // replaces what was reflected before, program has to be linked
+    void reflect(GLuint program);
+
+    // -1 for names the program doesn't have active
+    GLint uniform(ShaderName name) const { return m_uniforms.find(name); }
+    GLint attribute(ShaderName name) const { return m_attributes.find(name); }
+    // the binding point the block is attached to
+    GLint blockBinding(ShaderName name) const { return m_blocks.find(name); }
+
+    std::size_t uniformCount() const { return m_uniforms.count; }
+    std::size_t attributeCount() const { return m_attributes.count; }
+    std::size_t blockCount() const { return m_blocks.count; }
+
+private:
+    // open table without collisions: the slot of a key is (key * multiplier) >> shift, the
+    // multiplier is searched for when the table is built
+    struct PerfectHash {
+        std::vector<ShaderName> keys;
+        std::vector<GLint> values;
+        std::uint32_t multiplier{0};
+        unsigned shift{31};
+        std::size_t count{0};
+
+        void build(const std::vector<std::pair<ShaderName, GLint>> &entries);
+        GLint find(ShaderName name) const {
+            const std::size_t slot = static_cast<std::uint32_t>(name * multiplier) >> shift;
+            return slot < keys.size() && keys[slot] == name ? values[slot] : -1;
+        }
+    };
+
+    PerfectHash m_uniforms;
+    PerfectHash m_attributes;
+    PerfectHash m_blocks;
+};
+
+#endif
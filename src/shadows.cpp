@@ -0,0 +1,318 @@
+#include "shadows.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "profiler.h"
+#include "shader.h"
+
+namespace {
+    const char *shadowVertexSource = "#version 330 core\n"
+                                     "layout (location = 0) in vec3 aPos;\n"
+                                     "uniform mat4 lightViewProjection;\n"
+                                     "void main()\n"
+                                     "{\n"
+                                     "    gl_Position = lightViewProjection * vec4(aPos, 1.0);\n"
+                                     "}\0";
+
+    // depth only, nothing to write
+    const char *shadowFragmentSource = "#version 330 core\n"
+                                       "void main()\n"
+                                       "{\n"
+                                       "}\0";
+
+    void transformPoint(vec3 out, const mat4x4 m, const float x, const float y, const float z) {
+        vec4 in{x, y, z, 1.0f};
+        vec4 result;
+        mat4x4_mul_vec4(result, m, in);
+        out[0] = result[0] / result[3];
+        out[1] = result[1] / result[3];
+        out[2] = result[2] / result[3];
+    }
+
+    // light space box of a mesh's world space bounds
+    void lightSpaceBounds(const Mesh &mesh, const mat4x4 lightView, vec3 outMin, vec3 outMax) {
+        for (int i = 0; i < 3; ++i) {
+            outMin[i] = INFINITY;
+            outMax[i] = -INFINITY;
+        }
+        for (int corner = 0; corner < 8; ++corner) {
+            vec3 p;
+            transformPoint(p, lightView,
+                           (corner & 1) ? mesh.boundsMax[0] : mesh.boundsMin[0],
+                           (corner & 2) ? mesh.boundsMax[1] : mesh.boundsMin[1],
+                           (corner & 4) ? mesh.boundsMax[2] : mesh.boundsMin[2]);
+            vec3_min(outMin, outMin, p);
+            vec3_max(outMax, outMax, p);
+        }
+    }
+
+    const ShaderName VIEW_TO_SHADOW{internShaderName("viewToShadow")};
+    const ShaderName CASCADE_SPLITS{internShaderName("cascadeSplits")};
+    const ShaderName CAMERA_DEPTH_RANGE{internShaderName("cameraDepthRange")};
+    const ShaderName CASCADE_COUNT{internShaderName("cascadeCount")};
+    const ShaderName SHADOW_MAP{internShaderName("shadowMap")};
+}
+
+bool ShadowCascades::init(const ShadowConfig &config, JobSystem &jobs, GpuResources &resources) {
+    m_config = config;
+    m_config.cascadeCount = std::clamp(m_config.cascadeCount, 1, MAX_CASCADES);
+    m_jobs = &jobs;
+    m_resources = &resources;
+
+    m_program = compileProgram(shadowVertexSource, shadowFragmentSource, "SHADOW");
+    if (m_program == 0) {
+        return false;
+    }
+    m_matrixLocation = glGetUniformLocation(m_program, "lightViewProjection");
+
+    // one layer per cascade, sampled with hardware depth comparison
+    m_depthArrayHandle = resources.createTexture("shadow cascades");
+    m_depthArray = resources.texture(m_depthArrayHandle);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_depthArray);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, m_config.resolution, m_config.resolution,
+                 m_config.cascadeCount, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    resources.setBytes(m_depthArrayHandle,
+                       storageBytes(GL_DEPTH_COMPONENT24, m_config.resolution, m_config.resolution, m_config.cascadeCount));
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    glGenFramebuffers(1, &m_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthArray, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR::SHADOWS::FRAMEBUFFER_INCOMPLETE\n" << status << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void ShadowCascades::destroy() {
+    if (m_resources != nullptr) {
+        m_resources->release(m_depthArrayHandle);
+    }
+    glDeleteFramebuffers(1, &m_fbo);
+    glDeleteProgram(m_program);
+    m_depthArray = m_fbo = m_program = 0;
+}
+
+void ShadowCascades::cullCascade(const Scene &scene, Cascade &cascade, bool staticOnly) const {
+    cascade.casters.clear();
+    for (std::size_t i = 0; i < scene.meshes.size(); ++i) {
+        const Mesh &mesh = scene.meshes[i];
+        if (staticOnly && !mesh.isStatic) {
+            continue;
+        }
+        vec3 min, max;
+        lightSpaceBounds(mesh, m_lightView, min, max);
+        // anything between the light and the cascade still casts into it, so there's no near test
+        if (max[0] < cascade.center[0] - cascade.radius || min[0] > cascade.center[0] + cascade.radius ||
+            max[1] < cascade.center[1] - cascade.radius || min[1] > cascade.center[1] + cascade.radius ||
+            max[2] < cascade.zFar) {
+            continue;
+        }
+        cascade.casters.push_back(i);
+    }
+}
+
+void ShadowCascades::update(const Scene &scene) {
+    const int count = m_config.cascadeCount;
+
+    // light space only depends on the light direction, that's what keeps the texel grid fixed
+    vec3 direction{scene.sun.direction[0], scene.sun.direction[1], scene.sun.direction[2]};
+    vec3_norm(direction, direction);
+    vec3 eye{0.0f, 0.0f, 0.0f};
+    vec3 up{0.0f, 1.0f, 0.0f};
+    if (std::fabs(direction[1]) > 0.99f) {
+        up[0] = 1.0f;
+        up[1] = 0.0f;
+    }
+    mat4x4_look_at(m_lightView, eye, direction, up);
+
+    // camera frustum corners in world space
+    mat4x4 viewProjection, invViewProjection, invProjection;
+    mat4x4_mul(viewProjection, scene.projection, scene.view);
+    mat4x4_invert(invViewProjection, viewProjection);
+    mat4x4_invert(invProjection, scene.projection);
+    vec3 nearCorners[4], farCorners[4];
+    for (int i = 0; i < 4; ++i) {
+        const float x = (i & 1) ? 1.0f : -1.0f;
+        const float y = (i & 2) ? 1.0f : -1.0f;
+        transformPoint(nearCorners[i], invViewProjection, x, y, -1.0f);
+        transformPoint(farCorners[i], invViewProjection, x, y, 1.0f);
+    }
+    vec3 nearView, farView;
+    transformPoint(nearView, invProjection, 0.0f, 0.0f, -1.0f);
+    transformPoint(farView, invProjection, 0.0f, 0.0f, 1.0f);
+    const float nearDepth = -nearView[2];
+    const float farDepth = -farView[2];
+    m_cameraDepthRange[0] = nearDepth;
+    m_cameraDepthRange[1] = farDepth;
+
+    // how close to the light the casters go, cached cascades only ever see the static ones
+    float staticTop = -INFINITY, allTop = -INFINITY;
+    for (const Mesh &mesh : scene.meshes) {
+        vec3 min, max;
+        lightSpaceBounds(mesh, m_lightView, min, max);
+        allTop = std::max(allTop, max[2]);
+        if (mesh.isStatic) {
+            staticTop = std::max(staticTop, max[2]);
+        }
+    }
+
+    std::vector<std::size_t> toRender;
+    float splitStart = 0.0f;
+    for (int c = 0; c < count; ++c) {
+        Cascade &cascade = m_cascades[c];
+        const bool cached = c >= m_config.dynamicCascades;
+
+        // practical split scheme, falls back to uniform when the log split isn't defined (ortho cameras)
+        const float fraction = static_cast<float>(c + 1) / static_cast<float>(count);
+        float uniformSplit = nearDepth + (farDepth - nearDepth) * fraction;
+        float split = uniformSplit;
+        if (nearDepth > 0.0f && farDepth > 0.0f) {
+            float logSplit = nearDepth * std::pow(farDepth / nearDepth, fraction);
+            split = m_config.splitLambda * logSplit + (1.0f - m_config.splitLambda) * uniformSplit;
+        }
+        const float splitEnd = c == count - 1 ? 1.0f : (split - nearDepth) / (farDepth - nearDepth);
+        cascade.splitEnd = splitEnd;
+
+        // bounding sphere of the slice, the radius is rounded so it stays the same frame to frame
+        vec3 corners[8];
+        vec3 center{0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < 4; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                corners[i][k] = nearCorners[i][k] + (farCorners[i][k] - nearCorners[i][k]) * splitStart;
+                corners[i + 4][k] = nearCorners[i][k] + (farCorners[i][k] - nearCorners[i][k]) * splitEnd;
+            }
+        }
+        for (vec3 &corner : corners) {
+            vec3_add(center, center, corner);
+        }
+        vec3_scale(center, center, 1.0f / 8.0f);
+        float radius = 0.0f;
+        for (vec3 &corner : corners) {
+            vec3 d;
+            vec3_sub(d, corner, center);
+            radius = std::max(radius, vec3_len(d));
+        }
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+        splitStart = splitEnd;
+
+        vec3 lightCenter;
+        transformPoint(lightCenter, m_lightView, center[0], center[1], center[2]);
+
+        if (cached && cascade.valid && cascade.staticVersion == scene.staticVersion &&
+            std::equal(direction, direction + 3, cascade.lightDirection)) {
+            // still inside what was rendered last time?
+            const float dx = lightCenter[0] - cascade.center[0];
+            const float dy = lightCenter[1] - cascade.center[1];
+            if (std::sqrt(dx * dx + dy * dy) + radius <= cascade.radius &&
+                lightCenter[2] - radius >= cascade.zFar && lightCenter[2] + radius <= cascade.zNear) {
+                cascade.needsRender = false;
+                continue;
+            }
+        }
+
+        if (cached) {
+            radius *= 1.0f + m_config.cacheMargin;
+        }
+        // snap the centre to whole texels so the map only ever moves by exact texel steps
+        const float texel = 2.0f * radius / static_cast<float>(m_config.resolution);
+        cascade.center[0] = std::floor(lightCenter[0] / texel) * texel;
+        cascade.center[1] = std::floor(lightCenter[1] / texel) * texel;
+        cascade.center[2] = lightCenter[2];
+        cascade.radius = radius;
+        cascade.zNear = std::max(cached ? staticTop : allTop, lightCenter[2] + radius);
+        cascade.zFar = lightCenter[2] - radius;
+
+        mat4x4 projection;
+        mat4x4_ortho(projection, cascade.center[0] - radius, cascade.center[0] + radius,
+                     cascade.center[1] - radius, cascade.center[1] + radius, -cascade.zNear, -cascade.zFar);
+        mat4x4_mul(cascade.lightViewProjection, projection, m_lightView);
+
+        cascade.valid = true;
+        cascade.needsRender = true;
+        cascade.staticVersion = scene.staticVersion;
+        std::copy(direction, direction + 3, cascade.lightDirection);
+        toRender.push_back(static_cast<std::size_t>(c));
+    }
+
+    // cull every cascade that has to be redrawn on its own job
+    // the zone adds up the culling time of all workers
+    static const std::size_t zone = profiler.addZone("shadow culling");
+    m_jobs->parallelFor(toRender.size(), [&](std::size_t i) {
+        CpuZone timer(zone);
+        const std::size_t c = toRender[i];
+        cullCascade(scene, m_cascades[c], static_cast<int>(c) >= m_config.dynamicCascades);
+    });
+
+    m_cascadesRendered = static_cast<int>(toRender.size());
+    if (toRender.empty()) {
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glViewport(0, 0, m_config.resolution, m_config.resolution);
+    glEnable(GL_DEPTH_TEST);
+    // slope scaled bias against shadow acne
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+    glUseProgram(m_program);
+    for (std::size_t c : toRender) {
+        const Cascade &cascade = m_cascades[c];
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthArray, 0, static_cast<GLint>(c));
+        glClear(GL_DEPTH_BUFFER_BIT);
+        glUniformMatrix4fv(m_matrixLocation, 1, GL_FALSE, &cascade.lightViewProjection[0][0]);
+        for (std::size_t i : cascade.casters) {
+            const Mesh &mesh = scene.meshes[i];
+            glBindVertexArray(mesh.vao);
+            glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, nullptr);
+        }
+    }
+    glBindVertexArray(0);
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glDisable(GL_DEPTH_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void ShadowCascades::bind(const ShaderReflection &program, GLuint unit, const Scene &scene) const {
+    const int count = m_config.cascadeCount;
+
+    // view space -> [0, 1] shadow map coordinates, the lighting pass works in view space
+    mat4x4 invView, bias;
+    mat4x4_invert(invView, scene.view);
+    mat4x4_identity(bias);
+    mat4x4_scale_aniso(bias, bias, 0.5f, 0.5f, 0.5f);
+    bias[3][0] = bias[3][1] = bias[3][2] = 0.5f;
+
+    mat4x4 viewToShadow[MAX_CASCADES];
+    float splits[MAX_CASCADES]{1.0f, 1.0f, 1.0f, 1.0f};
+    for (int c = 0; c < count; ++c) {
+        mat4x4 lightToShadow;
+        mat4x4_mul(lightToShadow, bias, m_cascades[c].lightViewProjection);
+        mat4x4_mul(viewToShadow[c], lightToShadow, invView);
+        splits[c] = m_cascades[c].splitEnd;
+    }
+
+    glUniformMatrix4fv(program.uniform(VIEW_TO_SHADOW), count, GL_FALSE, &viewToShadow[0][0][0]);
+    glUniform4fv(program.uniform(CASCADE_SPLITS), 1, splits);
+    glUniform2fv(program.uniform(CAMERA_DEPTH_RANGE), 1, m_cameraDepthRange);
+    glUniform1i(program.uniform(CASCADE_COUNT), count);
+    glUniform1i(program.uniform(SHADOW_MAP), static_cast<GLint>(unit));
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_depthArray);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,84 @@
+#ifndef SHADOWS_H
+#define SHADOWS_H
+
+#include <cstddef>
+#include <vector>
+
+#include "../include/glad/glad.h"
+#include "../glfw/deps/linmath.h"
+#include "gpu_resources.h"
+#include "jobs.h"
+#include "scene.h"
+#include "shader_reflection.h"
+
+struct ShadowConfig {
+    int cascadeCount{4};
+    int resolution{1024};
+    // cascades [0, dynamicCascades) re-render every frame, the far ones are cached
+    int dynamicCascades{2};
+    // split distribution, 0 is uniform and 1 is logarithmic
+    float splitLambda{0.75f};
+    // cached cascades cover this much extra radius, so small camera moves reuse them
+    float cacheMargin{0.25f};
+};
+
+// cascaded shadow maps for the scene's directional light
+// - every cascade is fit around a bounding sphere of its frustum slice and snapped to
+//   whole shadow map texels in light space, so the shadows don't shimmer when the camera moves
+// - far cascades only hold static meshes and only re-render when the static geometry,
+//   the light or their (padded) coverage changes
+// - the casters of each cascade are culled in parallel on the job system
+class ShadowCascades {
+public:
+    static constexpr int MAX_CASCADES{4};
+
+    // the cascades' depth array belongs to resources, which has to outlive them
+    bool init(const ShadowConfig &config, JobSystem &jobs, GpuResources &resources);
+    void destroy();
+
+    // re-renders the cascades that need it, leaves the viewport and framebuffer changed
+    void update(const Scene &scene);
+
+    // uniforms the lighting pass needs, call after update() with the pass' program in use
+    void bind(const ShaderReflection &program, GLuint unit, const Scene &scene) const;
+
+    int cascadeCount() const { return m_config.cascadeCount; }
+    // how many cascades were redrawn by the last update, the rest came from the cache
+    int cascadesRendered() const { return m_cascadesRendered; }
+
+private:
+    struct Cascade {
+        mat4x4 lightViewProjection;
+        // snapped sphere centre in light space and the radius the map was rendered with
+        float center[3]{0.0f, 0.0f, 0.0f};
+        float radius{0.0f};
+        // near / far of the ortho projection, as light space z
+        float zNear{0.0f};
+        float zFar{0.0f};
+        // end of the cascade as a fraction of the camera's depth range
+        float splitEnd{1.0f};
+        bool valid{false};
+        bool needsRender{true};
+        unsigned staticVersion{0};
+        float lightDirection[3]{0.0f, 0.0f, 0.0f};
+        std::vector<std::size_t> casters;
+    };
+
+    void cullCascade(const Scene &scene, Cascade &cascade, bool staticOnly) const;
+
+    ShadowConfig m_config;
+    JobSystem *m_jobs{nullptr};
+    Cascade m_cascades[MAX_CASCADES];
+    mat4x4 m_lightView;
+    float m_cameraDepthRange[2]{0.0f, 1.0f};
+    int m_cascadesRendered{0};
+
+    GpuResources *m_resources{nullptr};
+    GpuHandle m_depthArrayHandle{GpuResources::NO_HANDLE};
+    GLuint m_depthArray{0};
+    GLuint m_fbo{0};
+    GLuint m_program{0};
+    GLint m_matrixLocation{-1};
+};
+
+#endif
@@ -0,0 +1,307 @@
+#include "split_view.h"
+
+#include <cfloat>
+#include <cstring>
+#include <iostream>
+
+#include "culling.h"
+#include "gl_extensions.h"
+#include "shader.h"
+
+namespace {
+    // viewList maps gl_InstanceID to the quadrant the instance is drawn into
+    const char *splitVertexSource = "#version 330 core\n"
+                                    "#ifdef VERTEX_VIEWPORT\n"
+                                    "#extension GL_ARB_shader_viewport_layer_array : enable\n"
+                                    "#extension GL_AMD_vertex_shader_viewport_index : enable\n"
+                                    "#endif\n"
+                                    "layout (location = 0) in vec3 aPos;\n"
+                                    "uniform mat4 viewProjections[4];\n"
+                                    "uniform int viewList[4];\n"
+                                    "out Vertex { vec3 worldPos; } vertex;\n"
+                                    "#ifdef GEOMETRY_VIEWPORT\n"
+                                    "flat out int viewIndex;\n"
+                                    "#endif\n"
+                                    "void main()\n"
+                                    "{\n"
+                                    "    int view = viewList[gl_InstanceID];\n"
+                                    "    vertex.worldPos = aPos;\n"
+                                    "    gl_Position = viewProjections[view] * vec4(aPos, 1.0);\n"
+                                    "#ifdef VERTEX_VIEWPORT\n"
+                                    "    gl_ViewportIndex = view;\n"
+                                    "#endif\n"
+                                    "#ifdef GEOMETRY_VIEWPORT\n"
+                                    "    viewIndex = view;\n"
+                                    "#endif\n"
+                                    "}\0";
+
+    // passes the triangle through into the instance's viewport
+    const char *splitGeometrySource = "#version 330 core\n"
+                                      "#extension GL_ARB_viewport_array : require\n"
+                                      "layout (triangles) in;\n"
+                                      "layout (triangle_strip, max_vertices = 3) out;\n"
+                                      "in Vertex { vec3 worldPos; } vertices[];\n"
+                                      "flat in int viewIndex[];\n"
+                                      "out Vertex { vec3 worldPos; } vertex;\n"
+                                      "void main()\n"
+                                      "{\n"
+                                      "    for (int i = 0; i < 3; ++i) {\n"
+                                      "        vertex.worldPos = vertices[i].worldPos;\n"
+                                      "        gl_Position = gl_in[i].gl_Position;\n"
+                                      "        gl_ViewportIndex = viewIndex[0];\n"
+                                      "        EmitVertex();\n"
+                                      "    }\n"
+                                      "    EndPrimitive();\n"
+                                      "}\0";
+
+    // flat shaded with the face normal like the view windows
+    const char *splitFragmentSource = "#version 330 core\n"
+                                      "out vec4 FragColor;\n"
+                                      "in Vertex { vec3 worldPos; } vertex;\n"
+                                      "uniform vec3 albedo;\n"
+                                      "void main()\n"
+                                      "{\n"
+                                      "    vec3 n = normalize(cross(dFdx(vertex.worldPos), dFdy(vertex.worldPos)));\n"
+                                      "    FragColor = vec4(albedo * (0.3 + 0.7 * abs(n.z)), 1.0);\n"
+                                      "}\0";
+}
+
+bool SplitView::init(GpuResources &resources) {
+    m_resources = &resources;
+    // the best way of picking the viewport per primitive the driver has
+    m_selection = ViewportSelection::PerView;
+    GLint maxViewports = 0;
+    if (hasGLExtension("GL_ARB_viewport_array")) {
+        glGetIntegerv(GL_MAX_VIEWPORTS, &maxViewports);
+    }
+    if (glViewportArrayv != nullptr && maxViewports >= VIEW_COUNT) {
+        m_selection = hasGLExtension("GL_ARB_shader_viewport_layer_array") || hasGLExtension("GL_AMD_vertex_shader_viewport_index")
+                      ? ViewportSelection::Instanced : ViewportSelection::GeometryShader;
+    }
+
+    if (m_selection == ViewportSelection::Instanced) {
+        m_program = compileProgram(addDefines(splitVertexSource, {"VERTEX_VIEWPORT"}).c_str(), splitFragmentSource, "SPLIT_VIEW");
+    } else if (m_selection == ViewportSelection::GeometryShader) {
+        m_program = compileProgram(addDefines(splitVertexSource, {"GEOMETRY_VIEWPORT"}).c_str(), splitGeometrySource,
+                                   splitFragmentSource, "SPLIT_VIEW");
+    }
+    if (m_program == 0) {
+        // a driver that lists the extensions but can't build the shaders still gets the quadrants
+        m_selection = ViewportSelection::PerView;
+        m_program = compileProgram(splitVertexSource, splitFragmentSource, "SPLIT_VIEW");
+    }
+    if (m_program == 0) {
+        return false;
+    }
+    m_viewProjectionsLocation = glGetUniformLocation(m_program, "viewProjections");
+    m_viewListLocation = glGetUniformLocation(m_program, "viewList");
+    m_albedoLocation = glGetUniformLocation(m_program, "albedo");
+
+    for (View &view : m_views) {
+        mat4x4_identity(view.view);
+        mat4x4_identity(view.projection);
+        mat4x4_identity(view.viewProjection);
+    }
+    glGenFramebuffers(1, &m_framebuffer);
+    return true;
+}
+
+void SplitView::destroy() {
+    glDeleteFramebuffers(1, &m_framebuffer);
+    if (m_resources != nullptr) {
+        m_resources->release(m_colorHandle);
+        m_resources->release(m_depthHandle);
+    }
+    glDeleteProgram(m_program);
+    m_framebuffer = m_colorTexture = m_depthRenderbuffer = m_program = 0;
+    m_width = m_height = 0;
+}
+
+void SplitView::setEnabled(bool enabled) {
+    if (enabled && !m_enabled) {
+        invalidate();
+    }
+    m_enabled = enabled;
+}
+
+void SplitView::setCamera(int view, const mat4x4 viewMatrix, const mat4x4 projection) {
+    View &target = m_views[view];
+    if (std::memcmp(target.view, viewMatrix, sizeof(mat4x4)) == 0 &&
+        std::memcmp(target.projection, projection, sizeof(mat4x4)) == 0) {
+        return;
+    }
+    std::memcpy(target.view, viewMatrix, sizeof(mat4x4));
+    std::memcpy(target.projection, projection, sizeof(mat4x4));
+    mat4x4_mul(target.viewProjection, target.projection, target.view);
+    target.dirty = true;
+}
+
+void SplitView::invalidate() {
+    for (View &view : m_views) {
+        view.dirty = true;
+    }
+}
+
+void SplitView::render(const Scene &scene, int width, int height, GLuint targetFramebuffer) {
+    resize(width, height);
+    m_redrawnViews = 0;
+    m_drawCalls = 0;
+
+    // coarse cull against the box around every changed camera's frustum, only the meshes inside it
+    // are tested against the single frustums
+    float unionMin[3]{FLT_MAX, FLT_MAX, FLT_MAX};
+    float unionMax[3]{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    unsigned dirtyViews = 0;
+    for (int i = 0; i < VIEW_COUNT; ++i) {
+        if (m_views[i].dirty) {
+            growByFrustum(m_views[i].viewProjection, unionMin, unionMax);
+            dirtyViews |= 1u << i;
+            ++m_redrawnViews;
+        }
+    }
+    if (dirtyViews != 0) {
+        m_visibleMeshes.clear();
+        for (std::size_t i = 0; i < scene.meshes.size(); ++i) {
+            const Mesh &mesh = scene.meshes[i];
+            if (!boxesOverlap(mesh.boundsMin, mesh.boundsMax, unionMin, unionMax)) {
+                continue;
+            }
+            unsigned views = 0;
+            for (int view = 0; view < VIEW_COUNT; ++view) {
+                if ((dirtyViews & (1u << view)) != 0 && boxInFrustum(m_views[view].viewProjection, mesh.boundsMin, mesh.boundsMax)) {
+                    views |= 1u << view;
+                }
+            }
+            if (views != 0) {
+                m_visibleMeshes.push_back({i, views});
+            }
+        }
+
+        // clear only the changed quadrants, the others keep last frame's pixels
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glEnable(GL_SCISSOR_TEST);
+        glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
+        for (int view = 0; view < VIEW_COUNT; ++view) {
+            if ((dirtyViews & (1u << view)) != 0) {
+                GLint rect[4];
+                viewRect(view, rect);
+                glScissor(rect[0], rect[1], rect[2], rect[3]);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            }
+        }
+        glDisable(GL_SCISSOR_TEST);
+
+        glEnable(GL_DEPTH_TEST);
+        glUseProgram(m_program);
+        mat4x4 viewProjections[VIEW_COUNT];
+        for (int view = 0; view < VIEW_COUNT; ++view) {
+            std::memcpy(viewProjections[view], m_views[view].viewProjection, sizeof(mat4x4));
+        }
+        glUniformMatrix4fv(m_viewProjectionsLocation, VIEW_COUNT, GL_FALSE, &viewProjections[0][0][0]);
+
+        if (m_selection == ViewportSelection::PerView) {
+            for (int view = 0; view < VIEW_COUNT; ++view) {
+                if ((dirtyViews & (1u << view)) == 0) {
+                    continue;
+                }
+                GLint rect[4];
+                viewRect(view, rect);
+                glViewport(rect[0], rect[1], rect[2], rect[3]);
+                glUniform1iv(m_viewListLocation, 1, &view);
+                for (const VisibleMesh &visible : m_visibleMeshes) {
+                    if ((visible.views & (1u << view)) != 0) {
+                        const Mesh &mesh = scene.meshes[visible.mesh];
+                        glUniform3fv(m_albedoLocation, 1, mesh.albedo);
+                        glBindVertexArray(mesh.vao);
+                        glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, nullptr);
+                        ++m_drawCalls;
+                    }
+                }
+            }
+        } else {
+            // every quadrant is a viewport of the array, one instance per quadrant that sees the mesh
+            GLfloat viewports[VIEW_COUNT * 4];
+            for (int view = 0; view < VIEW_COUNT; ++view) {
+                GLint rect[4];
+                viewRect(view, rect);
+                for (int i = 0; i < 4; ++i) {
+                    viewports[view * 4 + i] = static_cast<GLfloat>(rect[i]);
+                }
+            }
+            glViewportArrayv(0, VIEW_COUNT, viewports);
+            for (const VisibleMesh &visible : m_visibleMeshes) {
+                GLint viewList[VIEW_COUNT];
+                GLsizei instances = 0;
+                for (int view = 0; view < VIEW_COUNT; ++view) {
+                    if ((visible.views & (1u << view)) != 0) {
+                        viewList[instances++] = view;
+                    }
+                }
+                const Mesh &mesh = scene.meshes[visible.mesh];
+                glUniform1iv(m_viewListLocation, instances, viewList);
+                glUniform3fv(m_albedoLocation, 1, mesh.albedo);
+                glBindVertexArray(mesh.vao);
+                glDrawElementsInstanced(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, nullptr, instances);
+                ++m_drawCalls;
+            }
+        }
+        glBindVertexArray(0);
+        glDisable(GL_DEPTH_TEST);
+        // glViewport sets every viewport of the array again
+        glViewport(0, 0, width, height);
+        for (View &view : m_views) {
+            view.dirty = false;
+        }
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, targetFramebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+}
+
+void SplitView::resize(int width, int height) {
+    if (width == m_width && height == m_height) {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+    invalidate();
+
+    m_resources->release(m_colorHandle);
+    m_resources->release(m_depthHandle);
+    m_colorHandle = m_resources->createTexture("split view color");
+    m_colorTexture = m_resources->texture(m_colorHandle);
+    glBindTexture(GL_TEXTURE_2D, m_colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    m_resources->setBytes(m_colorHandle, storageBytes(GL_RGBA8, width, height));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_depthHandle = m_resources->createRenderbuffer("split view depth");
+    m_depthRenderbuffer = m_resources->renderbuffer(m_depthHandle);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    m_resources->setBytes(m_depthHandle, storageBytes(GL_DEPTH_COMPONENT24, width, height));
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderbuffer);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR::SPLIT_VIEW::FRAMEBUFFER_INCOMPLETE\n" << status << std::endl;
+    }
+}
+
+void SplitView::viewRect(int view, GLint rect[4]) const {
+    // view 0 top left, 1 top right, 2 bottom left, 3 bottom right
+    const int column = view % 2;
+    const int row = 1 - view / 2;
+    const int halfWidth = m_width / 2;
+    const int halfHeight = m_height / 2;
+    rect[0] = column * halfWidth;
+    rect[1] = row * halfHeight;
+    rect[2] = column == 0 ? halfWidth : m_width - halfWidth;
+    rect[3] = row == 0 ? halfHeight : m_height - halfHeight;
+}
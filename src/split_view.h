@@ -0,0 +1,97 @@
+#ifndef SPLIT_VIEW_H
+#define SPLIT_VIEW_H
+
+#include <cstddef>
+#include <vector>
+
+#include "../include/glad/glad.h"
+
+#include "gpu_resources.h"
+#include "scene.h"
+
+// the scene from four cameras in the quadrants of one target, like a modelling tool's viewports
+// - culled once against a box around all the cameras' frustums, then per camera for the meshes
+//   that are left
+// - with GL_ARB_viewport_array every mesh is drawn once into all the quadrants that see it, either
+//   instanced with the vertex shader picking the viewport (GL_ARB_shader_viewport_layer_array or
+//   GL_AMD_vertex_shader_viewport_index), or by a geometry shader picking it; without it every
+//   quadrant is drawn on its own
+// - the quadrants are kept in an FBO and only the ones whose camera changed are redrawn, the
+//   others are copied from the last frame
+// draws with the meshes' VAOs, so the context that made them has to be current
+class SplitView {
+public:
+    static constexpr int VIEW_COUNT{4};
+
+    enum class ViewportSelection {
+        // one pass per quadrant, glViewport in between
+        PerView,
+        GeometryShader,
+        Instanced
+    };
+
+    // the quadrants' target belongs to resources, which has to outlive the view
+    bool init(GpuResources &resources);
+    void destroy();
+
+    bool enabled() const { return m_enabled; }
+    // turning it on redraws every quadrant
+    void setEnabled(bool enabled);
+
+    // marks the quadrant for redrawing when the camera differs from the last one
+    void setCamera(int view, const mat4x4 viewMatrix, const mat4x4 projection);
+    // redraw every quadrant next frame, e.g. after the scene changed
+    void invalidate();
+
+    // redraws the changed quadrants and copies all of them into targetFramebuffer, which is bound
+    // afterwards; width and height are the target's size
+    void render(const Scene &scene, int width, int height, GLuint targetFramebuffer);
+
+    ViewportSelection viewportSelection() const { return m_selection; }
+    // quadrants redrawn and draw calls issued by the last render()
+    int redrawnViews() const { return m_redrawnViews; }
+    std::size_t drawCalls() const { return m_drawCalls; }
+
+private:
+    struct View {
+        mat4x4 view;
+        mat4x4 projection;
+        mat4x4 viewProjection;
+        bool dirty{true};
+    };
+
+    // a mesh that survived culling and the dirty views that see it, bit per view
+    struct VisibleMesh {
+        std::size_t mesh;
+        unsigned views;
+    };
+
+    void resize(int width, int height);
+    // quadrant of view in the target, x y width height
+    void viewRect(int view, GLint rect[4]) const;
+
+    bool m_enabled{false};
+    ViewportSelection m_selection{ViewportSelection::PerView};
+    View m_views[VIEW_COUNT];
+    GLuint m_program{0};
+    GLint m_viewProjectionsLocation{-1};
+    GLint m_viewListLocation{-1};
+    GLint m_albedoLocation{-1};
+
+    GpuResources *m_resources{nullptr};
+    GLuint m_framebuffer{0};
+    GpuHandle m_colorHandle{GpuResources::NO_HANDLE};
+    GpuHandle m_depthHandle{GpuResources::NO_HANDLE};
+    GLuint m_colorTexture{0};
+    GLuint m_depthRenderbuffer{0};
+    int m_width{0};
+    int m_height{0};
+
+    // kept between frames so the list doesn't allocate again
+    std::vector<VisibleMesh> m_visibleMeshes;
+
+    int m_redrawnViews{0};
+    std::size_t m_drawCalls{0};
+};
+
+#endif
@@ -0,0 +1,268 @@
+#include "sprite_batch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "shader.h"
+
+namespace {
+    const char *spriteVertexSource = "#version 330 core\n"
+                                     "layout (location = 0) in vec2 aPos;\n"
+                                     "layout (location = 1) in vec3 aTexCoord;\n"
+                                     "layout (location = 2) in vec4 aColor;\n"
+                                     "layout (location = 3) in vec4 aClip;\n"
+                                     "uniform vec2 screenSize;\n"
+                                     "out vec3 texCoord;\n"
+                                     "out vec4 color;\n"
+                                     "out vec2 pixel;\n"
+                                     "flat out vec4 clip;\n"
+                                     "void main()\n"
+                                     "{\n"
+                                     "    texCoord = aTexCoord;\n"
+                                     "    color = aColor;\n"
+                                     "    pixel = aPos;\n"
+                                     "    clip = aClip;\n"
+                                     "    gl_Position = vec4(aPos.x / screenSize.x * 2.0 - 1.0, 1.0 - aPos.y / screenSize.y * 2.0, 0.0, 1.0);\n"
+                                     "}\0";
+
+    const char *spriteFragmentSource = "#version 330 core\n"
+                                       "out vec4 FragColor;\n"
+                                       "in vec3 texCoord;\n"
+                                       "in vec4 color;\n"
+                                       "in vec2 pixel;\n"
+                                       "flat in vec4 clip;\n"
+                                       "uniform sampler2DArray sprites;\n"
+                                       "void main()\n"
+                                       "{\n"
+                                       "    if (pixel.x < clip.x || pixel.y < clip.y || pixel.x >= clip.z || pixel.y >= clip.w) discard;\n"
+                                       "    FragColor = texture(sprites, texCoord) * color;\n"
+                                       "}\0";
+
+    const std::uint16_t NO_SCISSOR[4]{0, 0, 65535, 65535};
+
+    std::uint16_t toPixel(float value) {
+        return static_cast<std::uint16_t>(std::clamp(value, 0.0f, 65535.0f));
+    }
+}
+
+bool SpriteBatch::init(GpuResources &resources, GLsizeiptr ringBytes) {
+    m_resources = &resources;
+    m_program = compileProgram(spriteVertexSource, spriteFragmentSource, "SPRITE");
+    if (m_program == 0) {
+        return false;
+    }
+    glUseProgram(m_program);
+    glUniform1i(glGetUniformLocation(m_program, "sprites"), 0);
+    m_screenSizeLocation = glGetUniformLocation(m_program, "screenSize");
+    glUseProgram(0);
+
+    // indices are a quarter of the vertex bytes for quads, give them a ring of their own
+    m_vertexRing.init(resources, ringBytes, "sprite vertex ring");
+    m_indexRing.init(resources, ringBytes / 4, "sprite index ring");
+
+    // attributes point at the start of the ring, the base vertex of each draw moves them along
+    glGenVertexArrays(1, &m_vao);
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexRing.buffer());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexRing.buffer());
+    const auto stride = static_cast<GLsizei>(sizeof(SpriteVertex));
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void *) offsetof(SpriteVertex, x));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void *) offsetof(SpriteVertex, u));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void *) offsetof(SpriteVertex, color));
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_SHORT, GL_FALSE, stride, (void *) offsetof(SpriteVertex, clip));
+    for (GLuint i = 0; i < 4; ++i) {
+        glEnableVertexAttribArray(i);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_textureArrayHandle = resources.createTexture("sprite texture array");
+    m_textureArray = resources.texture(m_textureArrayHandle);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureArray);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, LAYER_SIZE, LAYER_SIZE, MAX_LAYERS, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    resources.setBytes(m_textureArrayHandle, storageBytes(GL_RGBA8, LAYER_SIZE, LAYER_SIZE, MAX_LAYERS));
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // layer 0 is a white block, untextured rects sample its centre so they fit in the same batch
+    unsigned char white[4 * 4 * 4];
+    std::memset(white, 255, sizeof(white));
+    return addTexture(white, 4, 4, m_white);
+}
+
+void SpriteBatch::destroy() {
+    glDeleteProgram(m_program);
+    glDeleteVertexArrays(1, &m_vao);
+    if (m_resources != nullptr) {
+        m_resources->release(m_textureArrayHandle);
+    }
+    m_textureArray = 0;
+    m_vertexRing.destroy();
+    m_indexRing.destroy();
+}
+
+bool SpriteBatch::addTexture(const unsigned char *rgba, int width, int height, SpriteTexture &texture) {
+    if (m_layerCount == MAX_LAYERS || width > LAYER_SIZE || height > LAYER_SIZE) {
+        std::cout << "ERROR::SPRITE_BATCH::TEXTURE_DOES_NOT_FIT\n" << width << "x" << height << std::endl;
+        return false;
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureArray);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, m_layerCount, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    texture.layer = static_cast<float>(m_layerCount++);
+    texture.uScale = static_cast<float>(width) / LAYER_SIZE;
+    texture.vScale = static_cast<float>(height) / LAYER_SIZE;
+    return true;
+}
+
+void SpriteBatch::begin(int screenWidth, int screenHeight) {
+    m_screenWidth = screenWidth;
+    m_screenHeight = screenHeight;
+    m_blend = BlendMode::Alpha;
+    m_vertices.clear();
+    m_indices.clear();
+    m_batches.clear();
+    m_scissors.assign(NO_SCISSOR, NO_SCISSOR + 4);
+    m_drawCalls = 0;
+    m_uploadedBytes = 0;
+}
+
+void SpriteBatch::setBlendMode(BlendMode mode) {
+    m_blend = mode;
+}
+
+void SpriteBatch::pushScissor(float x, float y, float width, float height) {
+    const std::size_t top = m_scissors.size() - 4;
+    std::uint16_t rect[4]{
+            std::max(m_scissors[top], toPixel(x)),
+            std::max(m_scissors[top + 1], toPixel(y)),
+            std::min(m_scissors[top + 2], toPixel(x + width)),
+            std::min(m_scissors[top + 3], toPixel(y + height))};
+    m_scissors.insert(m_scissors.end(), rect, rect + 4);
+}
+
+void SpriteBatch::popScissor() {
+    // the bottom entry is the "no scissor" rect and always stays
+    if (m_scissors.size() > 4) {
+        m_scissors.resize(m_scissors.size() - 4);
+    }
+}
+
+SpriteVertex SpriteBatch::makeVertex(float x, float y, float u, float v, float layer, std::uint32_t color) const {
+    SpriteVertex vertex{};
+    vertex.x = x;
+    vertex.y = y;
+    vertex.u = u;
+    vertex.v = v;
+    vertex.layer = layer;
+    std::memcpy(vertex.color, &color, 4);
+    std::memcpy(vertex.clip, &m_scissors[m_scissors.size() - 4], sizeof(vertex.clip));
+    return vertex;
+}
+
+void SpriteBatch::addIndices(GLsizei count) {
+    if (!m_batches.empty() && m_batches.back().blend == m_blend) {
+        m_batches.back().indexCount += count;
+        return;
+    }
+    m_batches.push_back(Batch{m_blend, static_cast<GLsizei>(m_indices.size()) - count, count});
+}
+
+void SpriteBatch::drawRect(float x, float y, float width, float height, std::uint32_t color) {
+    drawSprite(m_white, x, y, width, height, color);
+}
+
+void SpriteBatch::drawSprite(const SpriteTexture &texture, float x, float y, float width, float height, std::uint32_t color) {
+    // the white block is sampled at its centre only, real images use their whole region
+    const bool solid = &texture == &m_white;
+    const float u0 = solid ? texture.uScale * 0.5f : 0.0f;
+    const float v0 = solid ? texture.vScale * 0.5f : 0.0f;
+    const float u1 = solid ? u0 : texture.uScale;
+    const float v1 = solid ? v0 : texture.vScale;
+
+    const auto first = static_cast<std::uint32_t>(m_vertices.size());
+    m_vertices.push_back(makeVertex(x, y, u0, v0, texture.layer, color));
+    m_vertices.push_back(makeVertex(x + width, y, u1, v0, texture.layer, color));
+    m_vertices.push_back(makeVertex(x + width, y + height, u1, v1, texture.layer, color));
+    m_vertices.push_back(makeVertex(x, y + height, u0, v1, texture.layer, color));
+    const std::uint32_t quad[6]{first, first + 1, first + 2, first, first + 2, first + 3};
+    m_indices.insert(m_indices.end(), quad, quad + 6);
+    addIndices(6);
+}
+
+void SpriteBatch::drawTriangles(const SpriteTexture *texture, const float *xy, const float *uv, const std::uint32_t *colors,
+                                int vertexCount, const std::uint32_t *indices, int indexCount) {
+    const SpriteTexture &image = texture ? *texture : m_white;
+    const auto first = static_cast<std::uint32_t>(m_vertices.size());
+    for (int i = 0; i < vertexCount; ++i) {
+        float u = texture ? uv[i * 2] * image.uScale : image.uScale * 0.5f;
+        float v = texture ? uv[i * 2 + 1] * image.vScale : image.vScale * 0.5f;
+        m_vertices.push_back(makeVertex(xy[i * 2], xy[i * 2 + 1], u, v, image.layer, colors[i]));
+    }
+    for (int i = 0; i < indexCount; ++i) {
+        m_indices.push_back(first + indices[i]);
+    }
+    addIndices(indexCount);
+}
+
+void SpriteBatch::end() {
+    if (m_indices.empty()) {
+        return;
+    }
+
+    const auto vertexBytes = static_cast<GLsizeiptr>(m_vertices.size() * sizeof(SpriteVertex));
+    const auto indexBytes = static_cast<GLsizeiptr>(m_indices.size() * sizeof(std::uint32_t));
+    GLintptr vertexOffset = 0, indexOffset = 0;
+    void *vertices = m_vertexRing.map(vertexBytes, sizeof(SpriteVertex), vertexOffset);
+    if (!vertices) {
+        std::cout << "ERROR::SPRITE_BATCH::RING_TOO_SMALL\n" << vertexBytes << " bytes of vertices" << std::endl;
+        return;
+    }
+    std::memcpy(vertices, m_vertices.data(), static_cast<std::size_t>(vertexBytes));
+    m_vertexRing.unmap();
+    void *indices = m_indexRing.map(indexBytes, sizeof(std::uint32_t), indexOffset);
+    if (!indices) {
+        std::cout << "ERROR::SPRITE_BATCH::RING_TOO_SMALL\n" << indexBytes << " bytes of indices" << std::endl;
+        return;
+    }
+    std::memcpy(indices, m_indices.data(), static_cast<std::size_t>(indexBytes));
+    m_indexRing.unmap();
+    m_uploadedBytes += static_cast<std::size_t>(vertexBytes + indexBytes);
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glUseProgram(m_program);
+    glUniform2f(m_screenSizeLocation, static_cast<float>(m_screenWidth), static_cast<float>(m_screenHeight));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureArray);
+    glBindVertexArray(m_vao);
+
+    const auto baseVertex = static_cast<GLint>(vertexOffset / static_cast<GLintptr>(sizeof(SpriteVertex)));
+    for (const Batch &batch : m_batches) {
+        if (batch.blend == BlendMode::Alpha) {
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        } else {
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+        }
+        const auto offset = static_cast<std::size_t>(indexOffset) + static_cast<std::size_t>(batch.firstIndex) * sizeof(std::uint32_t);
+        glDrawElementsBaseVertex(GL_TRIANGLES, batch.indexCount, GL_UNSIGNED_INT, reinterpret_cast<void *>(offset), baseVertex);
+        ++m_drawCalls;
+    }
+
+    glBindVertexArray(0);
+    glDisable(GL_BLEND);
+    m_vertexRing.endFrame();
+    m_indexRing.endFrame();
+
+    m_vertices.clear();
+    m_indices.clear();
+    m_batches.clear();
+}
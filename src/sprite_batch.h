@@ -0,0 +1,107 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../include/glad/glad.h"
+#include "gpu_resources.h"
+#include "stream_buffer.h"
+
+// where an image lives in the batch's texture array
+struct SpriteTexture {
+    float layer{0.0f};
+    // part of the layer the image covers, uvs of a sprite go from 0 to these
+    float uScale{1.0f};
+    float vScale{1.0f};
+};
+
+struct SpriteVertex {
+    float x, y;          // pixels, origin top left
+    float u, v, layer;   // texture array coordinates
+    std::uint8_t color[4];
+    std::uint16_t clip[4]; // scissor rect x0, y0, x1, y1 in pixels, tested in the fragment shader
+};
+static_assert(sizeof(SpriteVertex) == 32, "SpriteVertex is uploaded as is");
+
+enum class BlendMode {
+    Alpha,
+    Additive
+};
+
+// core profile 2D renderer for sprites and UI
+// - every image is a layer of one texture array, so switching images never breaks a batch
+// - scissor rects travel with the vertices instead of being glScissor state
+// - consecutive commands with the same blend mode merge into one draw call
+// - vertices and indices are streamed through fenced ring buffers
+// a whole debug UI usually ends up as a single draw
+class SpriteBatch {
+public:
+    static constexpr int LAYER_SIZE{256};
+    static constexpr int MAX_LAYERS{64};
+
+    bool init(GpuResources &resources, GLsizeiptr ringBytes = 4 * 1024 * 1024);
+    void destroy();
+
+    // uploads an RGBA8 image of at most LAYER_SIZE x LAYER_SIZE into its own layer
+    bool addTexture(const unsigned char *rgba, int width, int height, SpriteTexture &texture);
+
+    void begin(int screenWidth, int screenHeight);
+    void setBlendMode(BlendMode mode);
+    // scissors nest, each one is intersected with the one below it
+    void pushScissor(float x, float y, float width, float height);
+    void popScissor();
+
+    void drawRect(float x, float y, float width, float height, std::uint32_t color);
+    void drawSprite(const SpriteTexture &texture, float x, float y, float width, float height, std::uint32_t color = 0xffffffff);
+    // raw triangles, e.g. the converted output of a UI library
+    // xy in pixels and uv in [0, 1] of the texture (white when texture is null), colours as packRGBA
+    void drawTriangles(const SpriteTexture *texture, const float *xy, const float *uv, const std::uint32_t *colors,
+                       int vertexCount, const std::uint32_t *indices, int indexCount);
+
+    // uploads everything and issues the draws
+    void end();
+
+    int drawCalls() const { return m_drawCalls; }
+    std::size_t uploadedBytes() const { return m_uploadedBytes; }
+
+    static std::uint32_t packRGBA(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a = 255) {
+        return static_cast<std::uint32_t>(r) | static_cast<std::uint32_t>(g) << 8 |
+               static_cast<std::uint32_t>(b) << 16 | static_cast<std::uint32_t>(a) << 24;
+    }
+
+private:
+    struct Batch {
+        BlendMode blend;
+        GLsizei firstIndex;
+        GLsizei indexCount;
+    };
+
+    SpriteVertex makeVertex(float x, float y, float u, float v, float layer, std::uint32_t color) const;
+    // starts a new batch if the state changed, otherwise extends the last one
+    void addIndices(GLsizei count);
+
+    GLuint m_program{0};
+    GLint m_screenSizeLocation{-1};
+    GLuint m_vao{0};
+    GpuResources *m_resources{nullptr};
+    GpuHandle m_textureArrayHandle{GpuResources::NO_HANDLE};
+    GLuint m_textureArray{0};
+    int m_layerCount{0};
+    SpriteTexture m_white;
+    StreamBuffer m_vertexRing;
+    StreamBuffer m_indexRing;
+
+    int m_screenWidth{0};
+    int m_screenHeight{0};
+    BlendMode m_blend{BlendMode::Alpha};
+    std::vector<SpriteVertex> m_vertices;
+    std::vector<std::uint32_t> m_indices;
+    std::vector<Batch> m_batches;
+    std::vector<std::uint16_t> m_scissors; // stack of x0, y0, x1, y1
+
+    int m_drawCalls{0};
+    std::size_t m_uploadedBytes{0};
+};
+
+#endif
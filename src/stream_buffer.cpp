@@ -0,0 +1,108 @@
+#include "stream_buffer.h"
+
+#include <algorithm>
+
+bool StreamBuffer::init(GpuResources &resources, GLsizeiptr capacity, const char *label) {
+    m_resources = &resources;
+    m_capacity = capacity;
+    m_handle = resources.createBuffer(label);
+    resources.bufferData(m_handle, GL_COPY_WRITE_BUFFER, m_capacity, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    m_buffer = resources.buffer(m_handle);
+    return m_buffer != 0;
+}
+
+void StreamBuffer::destroy() {
+    for (Region &region : m_inFlight) {
+        glDeleteSync(region.fence);
+    }
+    m_inFlight.clear();
+    if (m_resources != nullptr) {
+        m_resources->release(m_handle);
+    }
+    m_buffer = 0;
+}
+
+void *StreamBuffer::map(GLsizeiptr size, GLsizeiptr alignment, GLintptr &offset) {
+    if (size <= 0 || size > m_capacity) {
+        return nullptr;
+    }
+
+    GLintptr begin = (m_head + alignment - 1) / alignment * alignment;
+    if (begin + size > m_capacity) {
+        // wrapping: the draws reading this frame's tail haven't been issued yet, so it's only
+        // fenced in endFrame() along with the rest of the frame
+        if (m_tailEnd > m_tailBegin) {
+            // wrapped twice in one frame, the ring is too small and the tail grows to cover both
+            m_tailBegin = std::min(m_tailBegin, m_frameBegin);
+            m_tailEnd = std::max(m_tailEnd, m_head);
+        } else {
+            m_tailBegin = m_frameBegin;
+            m_tailEnd = m_head;
+        }
+        m_frameBegin = 0;
+        begin = 0;
+    }
+    waitFor(begin, begin + size);
+    m_head = begin + size;
+    m_frameBytes += size;
+    offset = begin;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    return glMapBufferRange(GL_COPY_WRITE_BUFFER, begin, size,
+                            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+}
+
+void StreamBuffer::unmap() {
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+}
+
+void StreamBuffer::endFrame() {
+    fence(m_tailBegin, m_tailEnd);
+    m_tailBegin = 0;
+    m_tailEnd = 0;
+    fence(m_frameBegin, m_head);
+    m_frameBegin = m_head;
+
+    // retire what the GPU is already done with, otherwise the queue only shrinks when the ring
+    // laps onto an old range and waitFor scans every finished frame since
+    while (!m_inFlight.empty()) {
+        GLenum result = glClientWaitSync(m_inFlight.front().fence, 0, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        glDeleteSync(m_inFlight.front().fence);
+        m_inFlight.pop_front();
+    }
+    m_frameBytes = 0;
+}
+
+void StreamBuffer::fence(GLintptr begin, GLintptr end) {
+    if (end <= begin) {
+        return;
+    }
+    m_inFlight.push_back(Region{glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), begin, end});
+}
+
+void StreamBuffer::waitFor(GLintptr begin, GLintptr end) {
+    // fences signal in order, so waiting on the newest overlapping one retires all older ones too
+    std::size_t last = m_inFlight.size();
+    for (std::size_t i = 0; i < m_inFlight.size(); ++i) {
+        const Region &region = m_inFlight[i];
+        if (region.begin < end && begin < region.end) {
+            last = i;
+        }
+    }
+    if (last == m_inFlight.size()) {
+        return;
+    }
+
+    GLenum result = glClientWaitSync(m_inFlight[last].fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (result == GL_TIMEOUT_EXPIRED) {
+        result = glClientWaitSync(m_inFlight[last].fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    }
+    for (std::size_t i = 0; i <= last; ++i) {
+        glDeleteSync(m_inFlight.front().fence);
+        m_inFlight.pop_front();
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <deque>
+
+#include "../include/glad/glad.h"
+
+#include "gpu_resources.h"
+
+// ring buffer for data that's written by the CPU every frame and read by the GPU once
+// ranges are mapped unsynchronized, so writing never waits on the driver; instead every
+// frame's range is fenced and we only block if the ring wraps onto a range still in flight
+// (GL 3.3 has no persistent mapping, this is the closest we get to it)
+class StreamBuffer {
+public:
+    // the buffer belongs to resources, which has to outlive the ring; label names it there
+    bool init(GpuResources &resources, GLsizeiptr capacity, const char *label);
+    void destroy();
+
+    // maps size bytes at an offset that's a multiple of alignment, returns nullptr if size is
+    // larger than the whole ring
+    // mapping goes through GL_COPY_WRITE_BUFFER, so the VAO's element buffer binding is never touched
+    void *map(GLsizeiptr size, GLsizeiptr alignment, GLintptr &offset);
+    void unmap();
+
+    // fences everything written since the last call, once per frame after the draws using it
+    void endFrame();
+
+    GLuint buffer() const { return m_buffer; }
+    GLsizeiptr capacity() const { return m_capacity; }
+    // bytes handed out since the last endFrame()
+    GLsizeiptr frameBytes() const { return m_frameBytes; }
+
+private:
+    struct Region {
+        GLsync fence;
+        GLintptr begin;
+        GLintptr end;
+    };
+
+    void fence(GLintptr begin, GLintptr end);
+    // blocks until nothing in flight overlaps [begin, end)
+    void waitFor(GLintptr begin, GLintptr end);
+
+    GpuResources *m_resources{nullptr};
+    GpuHandle m_handle{GpuResources::NO_HANDLE};
+    GLuint m_buffer{0};
+    GLsizeiptr m_capacity{0};
+    GLintptr m_head{0};
+    GLintptr m_frameBegin{0};
+    // the part of this frame written before the ring wrapped, fenced in endFrame()
+    GLintptr m_tailBegin{0};
+    GLintptr m_tailEnd{0};
+    GLsizeiptr m_frameBytes{0};
+    std::deque<Region> m_inFlight;
+};
+
+#endif
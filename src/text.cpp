@@ -0,0 +1,406 @@
+#include "text.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TEXT_USE_SSE 1
+#endif
+
+#include "shader.h"
+
+namespace {
+    // unit quad from gl_VertexID, drawn as a 4 vertex strip per instance
+    const char *textVertexSource = "#version 330 core\n"
+                                   "layout (location = 0) in vec4 aRect;\n"
+                                   "layout (location = 1) in vec4 aUv;\n"
+                                   "layout (location = 2) in vec4 aColor;\n"
+                                   "uniform vec2 screenSize;\n"
+                                   "out vec2 uv;\n"
+                                   "out vec4 color;\n"
+                                   "void main()\n"
+                                   "{\n"
+                                   "    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"
+                                   "    vec2 pos = aRect.xy + corner * aRect.zw;\n"
+                                   "    uv = mix(aUv.xy, aUv.zw, corner);\n"
+                                   "    color = aColor;\n"
+                                   "    gl_Position = vec4(pos.x / screenSize.x * 2.0 - 1.0, 1.0 - pos.y / screenSize.y * 2.0, 0.0, 1.0);\n"
+                                   "}\0";
+
+    // the edge is at 0.5, fwidth keeps it about one screen pixel wide at any scale
+    const char *textFragmentSource = "#version 330 core\n"
+                                     "out vec4 FragColor;\n"
+                                     "in vec2 uv;\n"
+                                     "in vec4 color;\n"
+                                     "uniform sampler2D atlas;\n"
+                                     "void main()\n"
+                                     "{\n"
+                                     "    float dist = texture(atlas, uv).r;\n"
+                                     "    float width = max(fwidth(dist) * 0.7, 1e-4);\n"
+                                     "    float alpha = color.a * smoothstep(0.5 - width, 0.5 + width, dist);\n"
+                                     "    if (alpha <= 0.0) discard;\n"
+                                     "    FragColor = vec4(color.rgb, alpha);\n"
+                                     "}\0";
+
+    // glyphs are rasterized this much bigger than they're stored, then turned into distances
+    const int SUPERSAMPLE{4};
+
+    // next codepoint of a UTF-8 string, invalid bytes come out as '?'
+    std::uint32_t nextCodepoint(std::string_view text, std::size_t &i) {
+        const auto c = static_cast<unsigned char>(text[i++]);
+        int extra = c >= 0xf0 ? 3 : c >= 0xe0 ? 2 : c >= 0xc0 ? 1 : 0;
+        if (c >= 0x80 && extra == 0) {
+            return '?';
+        }
+        std::uint32_t codepoint = extra == 0 ? c : c & (0x3f >> extra);
+        for (; extra > 0; --extra) {
+            if (i >= text.size() || (static_cast<unsigned char>(text[i]) & 0xc0) != 0x80) {
+                return '?';
+            }
+            codepoint = codepoint << 6 | (static_cast<unsigned char>(text[i++]) & 0x3f);
+        }
+        return codepoint;
+    }
+}
+
+bool TextRenderer::init(JobSystem &jobs, GpuResources &resources, GLsizeiptr ringBytes) {
+    m_jobs = &jobs;
+    m_resources = &resources;
+    m_font = glyphFontCreateDefault();
+    if (!m_font) {
+        std::cout << "ERROR::TEXT::FONT_LOADING_FAILED" << std::endl;
+        return false;
+    }
+    float descent, lineGap;
+    glyphFontVerticalMetrics(m_font, GLYPH_HEIGHT, &m_ascent, &descent, &lineGap);
+
+    m_program = compileProgram(textVertexSource, textFragmentSource, "TEXT");
+    if (m_program == 0) {
+        return false;
+    }
+    glUseProgram(m_program);
+    glUniform1i(glGetUniformLocation(m_program, "atlas"), 0);
+    m_screenSizeLocation = glGetUniformLocation(m_program, "screenSize");
+    glUseProgram(0);
+
+    m_instanceRing.init(resources, ringBytes, "glyph instance ring");
+
+    // instance attributes are pointed at the ring offset of every draw in end()
+    glGenVertexArrays(1, &m_vao);
+    glBindVertexArray(m_vao);
+    for (GLuint i = 0; i < 3; ++i) {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+    glBindVertexArray(0);
+
+    m_atlasHandle = resources.createTexture("glyph atlas");
+    m_atlas = resources.texture(m_atlasHandle);
+    glBindTexture(GL_TEXTURE_2D, m_atlas);
+    std::vector<unsigned char> empty(static_cast<std::size_t>(ATLAS_SIZE) * ATLAS_SIZE, 0);
+    for (int y = 0; y < SOLID_CELL; ++y) {
+        std::fill_n(empty.begin() + y * ATLAS_SIZE, SOLID_CELL, static_cast<unsigned char>(255));
+    }
+    m_shelfX = SOLID_CELL;
+    m_shelfHeight = SOLID_CELL;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_SIZE, ATLAS_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, empty.data());
+    resources.setBytes(m_atlasHandle, storageBytes(GL_R8, ATLAS_SIZE, ATLAS_SIZE));
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // printable ASCII is needed right away, rasterize it on the workers and wait for it
+    for (std::uint32_t c = 32; c < 127; ++c) {
+        glyph(c);
+    }
+    m_jobs->wait(m_rasterJobs);
+    uploadReadyGlyphs();
+    return true;
+}
+
+void TextRenderer::destroy() {
+    // jobs still running hold on to the font and this object
+    if (m_jobs) {
+        m_jobs->wait(m_rasterJobs);
+    }
+    glyphFontDestroy(m_font);
+    m_font = nullptr;
+    glDeleteProgram(m_program);
+    glDeleteVertexArrays(1, &m_vao);
+    if (m_resources != nullptr) {
+        m_resources->release(m_atlasHandle);
+    }
+    m_atlas = 0;
+    m_instanceRing.destroy();
+}
+
+const TextRenderer::Glyph &TextRenderer::glyph(std::uint32_t codepoint) {
+    auto found = m_glyphs.find(codepoint);
+    if (found != m_glyphs.end()) {
+        return found->second;
+    }
+
+    if (codepoint != '?' && !glyphFontHasGlyph(m_font, static_cast<int>(codepoint))) {
+        const Glyph fallback = glyph('?');
+        return m_glyphs.emplace(codepoint, fallback).first->second;
+    }
+
+    GlyphMetrics metrics;
+    glyphMetrics(m_font, static_cast<int>(codepoint), GLYPH_HEIGHT, &metrics);
+    Glyph entry;
+    entry.advance = metrics.advance;
+    if (metrics.width == 0 || metrics.height == 0) {
+        // nothing to draw, e.g. space
+        return m_glyphs.emplace(codepoint, entry).first->second;
+    }
+
+    const int cellWidth = metrics.width + SPREAD * 2;
+    const int cellHeight = metrics.height + SPREAD * 2;
+    if (m_shelfX + cellWidth > ATLAS_SIZE) {
+        m_shelfX = 0;
+        m_shelfY += m_shelfHeight;
+        m_shelfHeight = 0;
+    }
+    if (m_shelfY + cellHeight > ATLAS_SIZE) {
+        std::cout << "ERROR::TEXT::ATLAS_FULL\n" << codepoint << std::endl;
+        return m_glyphs.emplace(codepoint, entry).first->second;
+    }
+    const int cellX = m_shelfX;
+    const int cellY = m_shelfY;
+    m_shelfX += cellWidth;
+    m_shelfHeight = std::max(m_shelfHeight, cellHeight);
+
+    // the uvs are known now, the pixels show up once the worker is done with them
+    const float texel = 1.0f / ATLAS_SIZE;
+    entry.uv[0] = static_cast<float>(cellX) * texel;
+    entry.uv[1] = static_cast<float>(cellY) * texel;
+    entry.uv[2] = static_cast<float>(cellX + cellWidth) * texel;
+    entry.uv[3] = static_cast<float>(cellY + cellHeight) * texel;
+    entry.offsetX = static_cast<float>(metrics.offsetX - SPREAD);
+    entry.offsetY = static_cast<float>(metrics.offsetY - SPREAD);
+    entry.width = static_cast<float>(cellWidth);
+    entry.height = static_cast<float>(cellHeight);
+
+    m_jobs->submit([this, codepoint, cellX, cellY, cellWidth, cellHeight] {
+        rasterize(codepoint, cellX, cellY, cellWidth, cellHeight);
+    }, &m_rasterJobs);
+    return m_glyphs.emplace(codepoint, entry).first->second;
+}
+
+void TextRenderer::rasterize(std::uint32_t codepoint, int cellX, int cellY, int cellWidth, int cellHeight) {
+    // runs on a worker: coverage at SUPERSAMPLE times the size, then for every atlas texel the
+    // distance to the closest hi-res pixel on the other side of the edge
+    GlyphMetrics low, high;
+    glyphMetrics(m_font, static_cast<int>(codepoint), GLYPH_HEIGHT, &low);
+    glyphMetrics(m_font, static_cast<int>(codepoint), GLYPH_HEIGHT * SUPERSAMPLE, &high);
+
+    const int hiWidth = cellWidth * SUPERSAMPLE;
+    const int hiHeight = cellHeight * SUPERSAMPLE;
+    std::vector<unsigned char> coverage(static_cast<std::size_t>(hiWidth) * hiHeight, 0);
+    std::vector<unsigned char> glyphPixels(static_cast<std::size_t>(std::max(1, high.width * high.height)), 0);
+    glyphRasterize(m_font, static_cast<int>(codepoint), GLYPH_HEIGHT * SUPERSAMPLE, glyphPixels.data(), high.width);
+
+    // line the hi-res bitmap up with the cell, the boxes round differently at the two sizes
+    const int originX = (SPREAD - low.offsetX) * SUPERSAMPLE + high.offsetX;
+    const int originY = (SPREAD - low.offsetY) * SUPERSAMPLE + high.offsetY;
+    for (int y = 0; y < high.height; ++y) {
+        for (int x = 0; x < high.width; ++x) {
+            const int cx = originX + x;
+            const int cy = originY + y;
+            if (cx >= 0 && cy >= 0 && cx < hiWidth && cy < hiHeight) {
+                coverage[static_cast<std::size_t>(cy * hiWidth + cx)] = glyphPixels[static_cast<std::size_t>(y * high.width + x)];
+            }
+        }
+    }
+
+    ReadyGlyph ready{cellX, cellY, cellWidth, cellHeight, std::vector<unsigned char>(static_cast<std::size_t>(cellWidth) * cellHeight)};
+    const int radius = SPREAD * SUPERSAMPLE;
+    for (int y = 0; y < cellHeight; ++y) {
+        for (int x = 0; x < cellWidth; ++x) {
+            const int px = x * SUPERSAMPLE + SUPERSAMPLE / 2;
+            const int py = y * SUPERSAMPLE + SUPERSAMPLE / 2;
+            const bool inside = coverage[static_cast<std::size_t>(py * hiWidth + px)] >= 128;
+            int closest = radius * radius;
+            for (int dy = -radius; dy <= radius; ++dy) {
+                const int sy = py + dy;
+                if (sy < 0 || sy >= hiHeight || dy * dy >= closest) {
+                    continue;
+                }
+                for (int dx = -radius; dx <= radius; ++dx) {
+                    const int sx = px + dx;
+                    const int d = dx * dx + dy * dy;
+                    if (sx < 0 || sx >= hiWidth || d >= closest) {
+                        continue;
+                    }
+                    if ((coverage[static_cast<std::size_t>(sy * hiWidth + sx)] >= 128) != inside) {
+                        closest = d;
+                    }
+                }
+            }
+            const float distance = std::sqrt(static_cast<float>(closest)) / static_cast<float>(SUPERSAMPLE);
+            const float signedDistance = inside ? distance : -distance;
+            const float value = std::clamp(0.5f + signedDistance / (2.0f * SPREAD), 0.0f, 1.0f);
+            ready.pixels[static_cast<std::size_t>(y * cellWidth + x)] = static_cast<unsigned char>(value * 255.0f + 0.5f);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_readyMutex);
+    m_ready.push_back(std::move(ready));
+}
+
+void TextRenderer::uploadReadyGlyphs() {
+    std::vector<ReadyGlyph> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_readyMutex);
+        ready.swap(m_ready);
+    }
+    if (ready.empty()) {
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, m_atlas);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (const ReadyGlyph &glyph : ready) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, glyph.x, glyph.y, glyph.width, glyph.height, GL_RED, GL_UNSIGNED_BYTE, glyph.pixels.data());
+        m_uploadedBytes += glyph.pixels.size();
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+const TextRenderer::Layout &TextRenderer::layout(std::string_view text, float size) {
+    auto found = m_layouts.find(LayoutKeyView{text, size});
+    if (found != m_layouts.end()) {
+        found->second.lastUsed = m_frame;
+        return found->second;
+    }
+
+    ++m_layoutMisses;
+    Layout entry;
+    entry.lastUsed = m_frame;
+    // the glyphs are measured at GLYPH_HEIGHT
+    const float scale = size / GLYPH_HEIGHT;
+    float pen = 0.0f;
+    for (std::size_t i = 0; i < text.size();) {
+        const Glyph &g = glyph(nextCodepoint(text, i));
+        if (g.width > 0.0f) {
+            GlyphInstance instance{};
+            instance.rect[0] = (pen + g.offsetX) * scale;
+            instance.rect[1] = (m_ascent + g.offsetY) * scale;
+            instance.rect[2] = g.width * scale;
+            instance.rect[3] = g.height * scale;
+            std::copy(g.uv, g.uv + 4, instance.uv);
+            entry.glyphs.push_back(instance);
+        }
+        pen += g.advance;
+    }
+    entry.width = pen * scale;
+    return m_layouts.emplace(LayoutKey{std::string(text), size}, std::move(entry)).first->second;
+}
+
+void TextRenderer::begin(int screenWidth, int screenHeight) {
+    m_screenWidth = screenWidth;
+    m_screenHeight = screenHeight;
+    m_instances.clear();
+    m_drawCalls = 0;
+    m_uploadedBytes = 0;
+    ++m_frame;
+
+    uploadReadyGlyphs();
+
+    // drop layouts of strings that stopped being drawn, e.g. counters that changed value
+    if (m_frame % LAYOUT_LIFETIME == 0) {
+        std::erase_if(m_layouts, [this](const auto &entry) { return m_frame - entry.second.lastUsed > LAYOUT_LIFETIME; });
+    }
+}
+
+float TextRenderer::measure(std::string_view text, float size) {
+    return layout(text, size).width;
+}
+
+void TextRenderer::drawText(std::string_view text, float x, float y, float size, std::uint32_t color) {
+    const Layout &cached = layout(text, size);
+    const std::size_t first = m_instances.size();
+    m_instances.resize(first + cached.glyphs.size());
+    const GlyphInstance *source = cached.glyphs.data();
+    GlyphInstance *destination = m_instances.data() + first;
+
+#ifdef TEXT_USE_SSE
+    // rect = rect + (x, y, 0, 0), the uvs are copied as they are
+    const __m128 offset4 = _mm_set_ps(0.0f, 0.0f, y, x);
+    for (std::size_t i = 0; i < cached.glyphs.size(); ++i) {
+        __m128 rect = _mm_load_ps(source[i].rect);
+        _mm_store_ps(destination[i].rect, _mm_add_ps(rect, offset4));
+        _mm_store_ps(destination[i].uv, _mm_load_ps(source[i].uv));
+        std::memcpy(destination[i].color, &color, 4);
+    }
+#else
+    for (std::size_t i = 0; i < cached.glyphs.size(); ++i) {
+        destination[i].rect[0] = source[i].rect[0] + x;
+        destination[i].rect[1] = source[i].rect[1] + y;
+        destination[i].rect[2] = source[i].rect[2];
+        destination[i].rect[3] = source[i].rect[3];
+        std::copy(source[i].uv, source[i].uv + 4, destination[i].uv);
+        std::memcpy(destination[i].color, &color, 4);
+    }
+#endif
+}
+
+void TextRenderer::drawRect(float x, float y, float width, float height, std::uint32_t color) {
+    // both uv corners on the middle of the solid cell, so filtering never reaches a glyph
+    const float solid = static_cast<float>(SOLID_CELL) * 0.5f / ATLAS_SIZE;
+    GlyphInstance &instance = m_instances.emplace_back();
+    instance.rect[0] = x;
+    instance.rect[1] = y;
+    instance.rect[2] = width;
+    instance.rect[3] = height;
+    std::fill_n(instance.uv, 4, solid);
+    std::memcpy(instance.color, &color, 4);
+}
+
+void TextRenderer::end() {
+    if (m_instances.empty()) {
+        return;
+    }
+
+    const auto bytes = static_cast<GLsizeiptr>(m_instances.size() * sizeof(GlyphInstance));
+    GLintptr offset = 0;
+    void *mapped = m_instanceRing.map(bytes, sizeof(GlyphInstance), offset);
+    if (!mapped) {
+        std::cout << "ERROR::TEXT::RING_TOO_SMALL\n" << bytes << " bytes of glyphs" << std::endl;
+        return;
+    }
+    std::memcpy(mapped, m_instances.data(), static_cast<std::size_t>(bytes));
+    m_instanceRing.unmap();
+    m_uploadedBytes += static_cast<std::size_t>(bytes);
+
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceRing.buffer());
+    const auto stride = static_cast<GLsizei>(sizeof(GlyphInstance));
+    const auto base = static_cast<std::size_t>(offset);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(base + offsetof(GlyphInstance, rect)));
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(base + offsetof(GlyphInstance, uv)));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, reinterpret_cast<void *>(base + offsetof(GlyphInstance, color)));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(m_program);
+    glUniform2f(m_screenSizeLocation, static_cast<float>(m_screenWidth), static_cast<float>(m_screenHeight));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_atlas);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(m_instances.size()));
+    ++m_drawCalls;
+
+    glBindVertexArray(0);
+    glDisable(GL_BLEND);
+    m_instanceRing.endFrame();
+}
@@ -0,0 +1,145 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/glad/glad.h"
+#include "glyph_rasterizer.h"
+#include "gpu_resources.h"
+#include "jobs.h"
+#include "stream_buffer.h"
+
+// one quad of the instanced text draw, 16 byte aligned so it can be built with SSE
+struct alignas(16) GlyphInstance {
+    float rect[4]; // x, y, width, height in pixels, origin top left
+    float uv[4];   // u0, v0, u1, v1 in the atlas
+    std::uint8_t color[4];
+    float padding[3];
+};
+static_assert(sizeof(GlyphInstance) == 48, "GlyphInstance is uploaded as is");
+
+// signed distance field text for HUD and debug overlays
+// - glyphs are rasterized into an SDF atlas on the job system the first time they're used and
+//   uploaded once ready, so one size of atlas entry scales to any text size
+// - the layout of a string is cached per text size and reused while the same string keeps being
+//   drawn at that size, per frame only the instances get placed, with SIMD where available
+// - all text of a frame is one instanced draw out of a streaming buffer
+class TextRenderer {
+public:
+    static constexpr int ATLAS_SIZE{1024};
+    // glyphs are stored in the atlas at this pixel height
+    static constexpr float GLYPH_HEIGHT{32.0f};
+    // distance in atlas pixels the field covers on both sides of an edge
+    static constexpr int SPREAD{4};
+    // fully inside texels in the atlas corner that rectangles are drawn with
+    static constexpr int SOLID_CELL{4};
+    // layouts that weren't drawn for this many frames are dropped
+    static constexpr unsigned LAYOUT_LIFETIME{240};
+
+    bool init(JobSystem &jobs, GpuResources &resources, GLsizeiptr ringBytes = 4 * 1024 * 1024);
+    void destroy();
+
+    void begin(int screenWidth, int screenHeight);
+    // x, y is the top left of the line, size the pixel height of the text
+    void drawText(std::string_view text, float x, float y, float size, std::uint32_t color);
+    float measure(std::string_view text, float size);
+    // solid rectangle in the same draw as the text, for backgrounds and graphs behind or between it
+    void drawRect(float x, float y, float width, float height, std::uint32_t color);
+    void end();
+
+    int drawCalls() const { return m_drawCalls; }
+    std::size_t glyphsDrawn() const { return m_instances.size(); }
+    std::size_t uploadedBytes() const { return m_uploadedBytes; }
+    std::size_t layoutCacheSize() const { return m_layouts.size(); }
+    std::size_t layoutCacheMisses() const { return m_layoutMisses; }
+
+private:
+    struct Glyph {
+        float uv[4]{};
+        // quad relative to the pen position at GLYPH_HEIGHT, including the spread
+        float offsetX{0.0f};
+        float offsetY{0.0f};
+        float width{0.0f};
+        float height{0.0f};
+        float advance{0.0f};
+    };
+
+    struct Layout {
+        std::vector<GlyphInstance> glyphs; // at the layout's size, relative to the top left of the line
+        float width{0.0f};
+        unsigned lastUsed{0};
+    };
+
+    // the rasterized distance field of one glyph, waiting to be uploaded
+    struct ReadyGlyph {
+        int x, y, width, height;
+        std::vector<unsigned char> pixels;
+    };
+
+    // the text and the size it's laid out at, looked up without copying the text into a string
+    struct LayoutKey {
+        std::string text;
+        float size;
+    };
+    struct LayoutKeyView {
+        std::string_view text;
+        float size;
+    };
+    struct LayoutKeyHash {
+        using is_transparent = void;
+        std::size_t operator()(const LayoutKeyView &key) const {
+            return std::hash<std::string_view>{}(key.text) ^ (std::hash<float>{}(key.size) * 31u);
+        }
+        std::size_t operator()(const LayoutKey &key) const { return (*this)(LayoutKeyView{key.text, key.size}); }
+    };
+    struct LayoutKeyEqual {
+        using is_transparent = void;
+        template<typename A, typename B>
+        bool operator()(const A &a, const B &b) const {
+            return a.size == b.size && std::string_view(a.text) == std::string_view(b.text);
+        }
+    };
+
+    const Glyph &glyph(std::uint32_t codepoint);
+    const Layout &layout(std::string_view text, float size);
+    void rasterize(std::uint32_t codepoint, int cellX, int cellY, int cellWidth, int cellHeight);
+    void uploadReadyGlyphs();
+
+    JobSystem *m_jobs{nullptr};
+    GlyphFont *m_font{nullptr};
+    float m_ascent{0.0f};
+
+    GLuint m_program{0};
+    GLint m_screenSizeLocation{-1};
+    GLuint m_vao{0};
+    GpuResources *m_resources{nullptr};
+    GpuHandle m_atlasHandle{GpuResources::NO_HANDLE};
+    GLuint m_atlas{0};
+    StreamBuffer m_instanceRing;
+
+    // shelf packing of the atlas
+    int m_shelfX{0};
+    int m_shelfY{0};
+    int m_shelfHeight{0};
+
+    std::unordered_map<std::uint32_t, Glyph> m_glyphs;
+    std::unordered_map<LayoutKey, Layout, LayoutKeyHash, LayoutKeyEqual> m_layouts;
+    JobCounter m_rasterJobs;
+    std::mutex m_readyMutex;
+    std::vector<ReadyGlyph> m_ready;
+
+    int m_screenWidth{0};
+    int m_screenHeight{0};
+    unsigned m_frame{0};
+    std::vector<GlyphInstance> m_instances;
+    int m_drawCalls{0};
+    std::size_t m_uploadedBytes{0};
+    std::size_t m_layoutMisses{0};
+};
+
+#endif
@@ -0,0 +1,14 @@
+#include "uniform_blocks.h"
+
+void bindUniformBlocks(GLuint program) {
+    const struct {
+        const char *name;
+        GLuint binding;
+    } blocks[]{{"FrameBlock", FRAME_BLOCK_BINDING}, {"ViewBlock", VIEW_BLOCK_BINDING}, {"ObjectBlock", OBJECT_BLOCK_BINDING}};
+    for (const auto &block : blocks) {
+        const GLuint index = glGetUniformBlockIndex(program, block.name);
+        if (index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(program, index, block.binding);
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef UNIFORM_BLOCKS_H
+#define UNIFORM_BLOCKS_H
+
+#include <cstddef>
+
+#include "../include/glad/glad.h"
+#include "../glfw/deps/linmath.h"
+
+// the uniform blocks shared by the renderers, as C++ structs with the std140 layout of their GLSL
+// declarations below, so a block is written with a single memcpy
+// std140: scalars align to 4 bytes, vec2 to 8, vec3 and vec4 to 16, a mat4 is four vec4 columns
+// and a block's size is rounded up to 16; padding is spelled out and the static_asserts pin every
+// member to its std140 offset, so editing one side without the other doesn't compile
+
+// binding points, the same in every program, set by bindUniformBlocks()
+enum UniformBinding : GLuint {
+    FRAME_BLOCK_BINDING = 0,
+    VIEW_BLOCK_BINDING = 1,
+    OBJECT_BLOCK_BINDING = 2
+};
+
+// once per frame
+struct FrameBlock {
+    float screenSize[2]; // size of the target being rendered, in pixels
+    float time;          // seconds since start
+    float deltaTime;
+};
+static_assert(offsetof(FrameBlock, screenSize) == 0);
+static_assert(offsetof(FrameBlock, time) == 8);
+static_assert(offsetof(FrameBlock, deltaTime) == 12);
+static_assert(sizeof(FrameBlock) == 16);
+
+#define FRAME_BLOCK_GLSL "layout (std140) uniform FrameBlock {\n" \
+                         "    vec2 screenSize;\n" \
+                         "    float time;\n" \
+                         "    float deltaTime;\n" \
+                         "};\n"
+
+// once per camera
+struct ViewBlock {
+    mat4x4 view;
+    mat4x4 projection;
+    mat4x4 viewProjection;
+};
+static_assert(offsetof(ViewBlock, view) == 0);
+static_assert(offsetof(ViewBlock, projection) == 64);
+static_assert(offsetof(ViewBlock, viewProjection) == 128);
+static_assert(sizeof(ViewBlock) == 192);
+
+#define VIEW_BLOCK_GLSL "layout (std140) uniform ViewBlock {\n" \
+                        "    mat4 view;\n" \
+                        "    mat4 projection;\n" \
+                        "    mat4 viewProjection;\n" \
+                        "};\n"
+
+// once per draw, the Mesh's material
+struct ObjectBlock {
+    float albedo[3];
+    float roughness; // fills the vec3's fourth component
+    float metallic;
+    float padding[3];
+};
+static_assert(offsetof(ObjectBlock, albedo) == 0);
+static_assert(offsetof(ObjectBlock, roughness) == 12);
+static_assert(offsetof(ObjectBlock, metallic) == 16);
+static_assert(sizeof(ObjectBlock) == 32);
+
+#define OBJECT_BLOCK_GLSL "layout (std140) uniform ObjectBlock {\n" \
+                          "    vec3 albedo;\n" \
+                          "    float roughness;\n" \
+                          "    float metallic;\n" \
+                          "};\n"
+
+// points the blocks program declares at their binding points, GL 3.3 has no layout (binding = n)
+// for blocks; once after linking
+void bindUniformBlocks(GLuint program);
+
+#endif
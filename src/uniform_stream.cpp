@@ -0,0 +1,37 @@
+#include "uniform_stream.h"
+
+#include <iostream>
+
+bool UniformStream::init(GpuResources &resources, GLsizeiptr capacity) {
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    m_alignment = alignment > 0 ? alignment : 256;
+    return m_ring.init(resources, capacity, "uniform stream");
+}
+
+void UniformStream::destroy() {
+    if (m_mapped != nullptr) {
+        end();
+    }
+    m_ring.destroy();
+}
+
+bool UniformStream::begin(GLsizeiptr size) {
+    m_mapped = static_cast<unsigned char *>(m_ring.map(size, m_alignment, m_mappedOffset));
+    if (m_mapped == nullptr) {
+        std::cout << "ERROR::UNIFORM_STREAM::DOES_NOT_FIT\n" << size << " bytes" << std::endl;
+        return false;
+    }
+    m_mappedSize = size;
+    m_used = 0;
+    return true;
+}
+
+void UniformStream::end() {
+    if (m_mapped == nullptr) {
+        return;
+    }
+    m_ring.unmap();
+    m_mapped = nullptr;
+    m_mappedSize = 0;
+}
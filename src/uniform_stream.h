@@ -0,0 +1,74 @@
+#ifndef UNIFORM_STREAM_H
+#define UNIFORM_STREAM_H
+
+#include <cstring>
+
+#include "../include/glad/glad.h"
+#include "gpu_resources.h"
+#include "stream_buffer.h"
+
+// uniform blocks written every frame, sub-allocated from one StreamBuffer and bound with
+// glBindBufferRange instead of glUniform* calls and location lookups per draw
+// - begin() maps room for the blocks of a pass at once, push() copies one block in with a single
+//   memcpy and returns its offset, end() unmaps; a buffer can't be drawn from while it's mapped, so
+//   a pass writes all its blocks first and then binds them draw by draw
+// - offsets are multiples of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, the ring is fenced per frame like
+//   every StreamBuffer
+class UniformStream {
+public:
+    bool init(GpuResources &resources, GLsizeiptr capacity = 1024 * 1024);
+    void destroy();
+
+    // bytes a block of blockSize takes in the stream, use it to size begin()
+    GLsizeiptr stride(GLsizeiptr blockSize) const { return (blockSize + m_alignment - 1) / m_alignment * m_alignment; }
+
+    // maps size bytes, false if they don't fit into the ring
+    bool begin(GLsizeiptr size);
+    // copies block into the mapped range, returns its offset in buffer(), -1 once the range is full
+    template<typename Block>
+    GLintptr push(const Block &block) {
+        const GLsizeiptr size = stride(sizeof(Block));
+        if (m_mapped == nullptr || m_used + size > m_mappedSize) {
+            return -1;
+        }
+        std::memcpy(m_mapped + m_used, &block, sizeof(Block));
+        const GLintptr offset = m_mappedOffset + m_used;
+        m_used += size;
+        return offset;
+    }
+    void end();
+
+    // binds the Block pushed at offset to a binding point, see UniformBinding
+    template<typename Block>
+    void bind(GLuint binding, GLintptr offset) const {
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, m_ring.buffer(), offset, sizeof(Block));
+    }
+
+    // begin(), push(), end() and bind() of one block on its own, e.g. the FrameBlock
+    template<typename Block>
+    bool write(GLuint binding, const Block &block) {
+        if (!begin(stride(sizeof(Block)))) {
+            return false;
+        }
+        const GLintptr offset = push(block);
+        end();
+        bind<Block>(binding, offset);
+        return true;
+    }
+
+    // fences the frame's blocks, once per frame after the draws that read them
+    void endFrame() { m_ring.endFrame(); }
+
+    GLuint buffer() const { return m_ring.buffer(); }
+    GLsizeiptr frameBytes() const { return m_ring.frameBytes(); }
+
+private:
+    StreamBuffer m_ring;
+    GLsizeiptr m_alignment{256};
+    unsigned char *m_mapped{nullptr};
+    GLintptr m_mappedOffset{0};
+    GLsizeiptr m_mappedSize{0};
+    GLsizeiptr m_used{0};
+};
+
+#endif